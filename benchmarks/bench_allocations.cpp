@@ -0,0 +1,164 @@
+// Heap allocations per request on the server side: a real Session on a
+// loopback connection answers keep-alive requests from a client thread
+// that only uses raw sockets, while global operator new counts the calls
+// made on the server thread. Run from the build directory (the config
+// routes and static files are read from ../).
+//
+//   bench_allocations [requests_per_case]
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <boost/asio.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+#include "access_log.hpp"
+#include "router.hpp"
+#include "session.hpp"
+
+namespace {
+
+thread_local bool t_counting = false;
+std::atomic<std::uint64_t> g_allocations{0};
+std::atomic<std::uint64_t> g_bytes{0};
+
+void* counted_alloc(std::size_t size) {
+    if (t_counting) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        g_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+struct Case {
+    const char* name;
+    std::string request;
+};
+
+std::vector<Case> cases() {
+    const std::string browser_headers =
+        "Host: localhost:8080\r\n"
+        "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0\r\n"
+        "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+        "Accept-Language: en-US,en;q=0.9\r\n"
+        "Accept-Encoding: gzip, deflate, br\r\n"
+        "Cookie: session=8f2a1c9e7b6d4a3f; theme=dark\r\n"
+        "Connection: keep-alive\r\n";
+    std::string body(512, 'x');
+    return {
+        {"GET /health (minimal)", "GET /health HTTP/1.1\r\nHost: localhost\r\n\r\n"},
+        {"GET / (config route, browser)", "GET / HTTP/1.1\r\n" + browser_headers + "\r\n"},
+        {"GET /static/style.css (browser)", "GET /static/style.css HTTP/1.1\r\n" + browser_headers + "\r\n"},
+        {"GET /api/data/42 (handler)", "GET /api/data/42 HTTP/1.1\r\n" + browser_headers + "\r\n"},
+        {"POST /echo (512 B body)", "POST /echo HTTP/1.1\r\nHost: localhost\r\nContent-Type: text/plain\r\n"
+                                    "Content-Length: 512\r\n\r\n" + body},
+    };
+}
+
+// Read one Content-Length framed response
+bool read_response(int fd, std::string& buffer) {
+    char chunk[16384];
+    while (true) {
+        size_t head_end = buffer.find("\r\n\r\n");
+        if (head_end != std::string::npos) {
+            size_t length = 0;
+            size_t pos = buffer.find("Content-Length: ");
+            if (pos != std::string::npos && pos < head_end) length = std::strtoull(buffer.c_str() + pos + 16, nullptr, 10);
+            if (buffer.size() >= head_end + 4 + length) {
+                buffer.erase(0, head_end + 4 + length);
+                return true;
+            }
+        }
+        ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        buffer.append(chunk, static_cast<size_t>(n));
+    }
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) { return counted_alloc(size); }
+void* operator new[](std::size_t size) { return counted_alloc(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+int main(int argc, char** argv) {
+    // Stay under MAX_KEEPALIVE_REQUESTS so one connection serves a case
+    size_t requests = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 900;
+    const size_t warmup = 50;
+
+    init_router_config();
+    AccessLogConfig log;
+    log.path = "/tmp/tez_bench_allocations.log";
+    start_access_log(log);
+
+    boost::asio::io_context io;
+    boost::asio::ip::tcp::acceptor acceptor(io, {boost::asio::ip::address_v4::loopback(), 0});
+    unsigned short port = acceptor.local_endpoint().port();
+    std::function<void()> do_accept;
+    do_accept = [&]() {
+        acceptor.async_accept([&](boost::system::error_code ec, boost::asio::ip::tcp::socket socket) {
+            if (!ec) std::make_shared<Session>(std::move(socket))->start();
+            if (ec != boost::asio::error::operation_aborted) do_accept();
+        });
+    };
+    do_accept();
+    auto work = boost::asio::make_work_guard(io);
+    std::thread server([&]() {
+        t_counting = true;
+        io.run();
+    });
+
+    std::printf("%-36s %12s %12s\n", "case", "allocs/req", "bytes/req");
+    for (const Case& c : cases()) {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            std::perror("connect");
+            return 1;
+        }
+        std::string buffer;
+        buffer.reserve(65536);
+        std::uint64_t allocations = 0;
+        std::uint64_t bytes = 0;
+        for (size_t i = 0; i < warmup + requests; ++i) {
+            if (i == warmup) {
+                allocations = g_allocations.load();
+                bytes = g_bytes.load();
+            }
+            if (::send(fd, c.request.data(), c.request.size(), 0) != static_cast<ssize_t>(c.request.size()) ||
+                !read_response(fd, buffer)) {
+                std::fprintf(stderr, "%s: request failed\n", c.name);
+                return 1;
+            }
+        }
+        allocations = g_allocations.load() - allocations;
+        bytes = g_bytes.load() - bytes;
+        ::close(fd);
+        std::printf("%-36s %12.2f %12.1f\n", c.name, static_cast<double>(allocations) / static_cast<double>(requests),
+                    static_cast<double>(bytes) / static_cast<double>(requests));
+    }
+
+    work.reset();
+    boost::system::error_code ignored;
+    acceptor.close(ignored);
+    io.stop();
+    server.join();
+    stop_access_log();
+    std::remove(log.path.c_str());
+    return 0;
+}
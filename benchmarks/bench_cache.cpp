@@ -0,0 +1,143 @@
+// Cache contention: the old single-mutex LRUCache vs ShardedCache (exact LRU
+// and CLOCK) with 1 to 64 threads hammering a shared cache. The workload is
+// 95% gets / 5% puts over a skewed key set that mostly fits in the cache,
+// which is what the response and file caches see under load.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "bench_util.hpp"
+#include "sharded_cache.hpp"
+
+namespace {
+
+using Value = std::shared_ptr<const std::string>;
+
+// The cache middleware.cpp used before: one std::list of keys for the
+// access order and one mutex around the whole thing
+class MutexLruCache {
+public:
+    explicit MutexLruCache(size_t max_size) : max_size_(max_size) {}
+
+    Value get(const std::string& key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = data_.find(key);
+        if (it == data_.end()) return {};
+        order_.erase(it->second.second);
+        order_.push_front(key);
+        it->second.second = order_.begin();
+        return it->second.first;
+    }
+
+    void put(const std::string& key, Value value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = data_.find(key);
+        if (it != data_.end()) {
+            order_.erase(it->second.second);
+            order_.push_front(key);
+            it->second = {std::move(value), order_.begin()};
+            return;
+        }
+        if (data_.size() >= max_size_) {
+            data_.erase(order_.back());
+            order_.pop_back();
+        }
+        order_.push_front(key);
+        data_[key] = {std::move(value), order_.begin()};
+    }
+
+private:
+    std::mutex mutex_;
+    std::list<std::string> order_;
+    std::unordered_map<std::string, std::pair<Value, std::list<std::string>::iterator>> data_;
+    size_t max_size_;
+};
+
+constexpr size_t CAPACITY = 1024;
+constexpr size_t KEY_COUNT = 1280;
+constexpr size_t OPS_PER_THREAD = 200000;
+
+std::vector<std::string> make_keys() {
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < KEY_COUNT; ++i) {
+        keys.push_back("/static/asset_" + std::to_string(i) + ".css");
+    }
+    return keys;
+}
+
+// Each thread replays its own pre-generated, skewed key sequence
+std::vector<uint32_t> make_trace(unsigned seed) {
+    std::mt19937 rng(seed);
+    std::geometric_distribution<uint32_t> hot(0.01);
+    std::vector<uint32_t> trace(OPS_PER_THREAD);
+    for (auto& index : trace) {
+        index = hot(rng) % KEY_COUNT;
+    }
+    return trace;
+}
+
+template<typename Cache>
+double run_threads(Cache& cache, const std::vector<std::string>& keys,
+                   const std::vector<std::vector<uint32_t>>& traces, unsigned threads) {
+    auto value = std::make_shared<const std::string>(4096, 'x');
+    for (size_t i = 0; i < CAPACITY; ++i) cache.put(keys[i], value);
+
+    std::atomic<unsigned> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            const auto& trace = traces[t];
+            ready.fetch_add(1);
+            while (!go.load()) std::this_thread::yield();
+            for (size_t i = 0; i < trace.size(); ++i) {
+                const std::string& key = keys[trace[i]];
+                if (i % 20 == 0) {
+                    cache.put(key, value);
+                } else {
+                    bench::do_not_optimize(cache.get(key));
+                }
+            }
+        });
+    }
+    while (ready.load() < threads) std::this_thread::yield();
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true);
+    for (auto& worker : workers) worker.join();
+    double elapsed = bench::seconds_since(start);
+    return static_cast<double>(threads) * OPS_PER_THREAD / elapsed / 1e6;
+}
+
+}  // namespace
+
+int main() {
+    const unsigned thread_counts[] = {1, 2, 4, 8, 16, 32, 64};
+    std::vector<std::string> keys = make_keys();
+    std::vector<std::vector<uint32_t>> traces;
+    for (unsigned t = 0; t < 64; ++t) traces.push_back(make_trace(t + 1));
+
+    std::printf("hardware threads: %u, capacity %zu, %zu keys, 95%% get\n\n",
+                std::thread::hardware_concurrency(), CAPACITY, KEY_COUNT);
+    std::printf("%8s %16s %16s %16s\n", "threads", "mutex-lru Mops/s", "sharded-lru", "sharded-clock");
+
+    for (unsigned threads : thread_counts) {
+        MutexLruCache baseline(CAPACITY);
+        ShardedCache<Value> lru(CAPACITY, 3600, 64, EvictionPolicy::Lru);
+        ShardedCache<Value> clock(CAPACITY, 3600, 64, EvictionPolicy::Clock);
+
+        double base = run_threads(baseline, keys, traces, threads);
+        double sharded = run_threads(lru, keys, traces, threads);
+        double clocked = run_threads(clock, keys, traces, threads);
+        std::printf("%8u %16.2f %16.2f %16.2f\n", threads, base, sharded, clocked);
+    }
+    return 0;
+}
@@ -0,0 +1,152 @@
+// Static file compression: bytes on the wire and CPU per request for the
+// identity, gzip and deflate variants of typical text assets.
+//
+//   bench_compression [repo_root]   (default "..", i.e. run from build/)
+//
+// The corpus is real text from the repo (README as HTML, sources as JS) plus
+// generated CSS and JSON. Files are written to a scratch static directory and
+// served through serve_file(), so the numbers include negotiation and the
+// file cache. "serve" is the cached per-request cost; "zlib" is what the
+// same request would cost if the body were compressed on every request.
+
+#include <unistd.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "bench_util.hpp"
+#include "compression.hpp"
+#include "file_server.hpp"
+#include "http_date.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string read_file(const fs::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+std::string make_css() {
+    std::mt19937 rng(7);
+    const char* props[] = {"color", "margin", "padding", "border-radius", "font-size", "line-height"};
+    std::string css;
+    for (int i = 0; i < 300; ++i) {
+        css += ".card-" + std::to_string(rng() % 5000) + " > .title {\n";
+        for (int p = 0; p < 3; ++p) {
+            css += "  " + std::string(props[rng() % 6]) + ": " + std::to_string(rng() % 64) + "px;\n";
+        }
+        css += "  background: #" + std::to_string(100000 + rng() % 899999) + ";\n}\n";
+    }
+    return css;
+}
+
+std::string make_json() {
+    std::mt19937 rng(11);
+    nlohmann::json items = nlohmann::json::array();
+    for (int i = 0; i < 400; ++i) {
+        items.push_back({{"id", 10000 + i},
+                         {"name", "product-" + std::to_string(rng() % 100000)},
+                         {"price", static_cast<double>(rng() % 100000) / 100.0},
+                         {"in_stock", rng() % 2 == 0},
+                         {"tags", {"tag" + std::to_string(rng() % 50), "tag" + std::to_string(rng() % 50)}}});
+    }
+    return nlohmann::json{{"items", items}}.dump();
+}
+
+// Status line + fixed headers + the per-request lines the session appends
+size_t wire_bytes(const Response& response) {
+    static const size_t per_request =
+        std::string("Date: \r\nConnection: keep-alive\r\nKeep-Alive: timeout=5, max=1000\r\n\r\n").size() +
+        HTTP_DATE_LENGTH;
+    return response.head.size() + per_request + response.body.size();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    fs::path root = fs::absolute(argc > 1 ? argv[1] : "..");
+    fs::path scratch = fs::temp_directory_path() / ("tez_bench_compression_" + std::to_string(::getpid()));
+    fs::create_directories(scratch / "static");
+    fs::create_directories(scratch / "run");
+
+    struct Asset {
+        std::string name;
+        std::string body;
+    };
+    std::vector<Asset> assets = {
+        {"page.html", read_file(root / "README.md")},
+        {"app.js", read_file(root / "src" / "session.cpp")},
+        {"style.css", make_css()},
+        {"data.json", make_json()},
+    };
+    for (const Asset& asset : assets) {
+        std::ofstream(scratch / "static" / asset.name, std::ios::binary) << asset.body;
+    }
+    // serve_file() resolves ../static against the working directory
+    fs::current_path(scratch / "run");
+
+    std::printf("%-10s %-9s %10s %10s %7s %14s %14s\n", "file", "coding", "body B", "wire B", "ratio",
+                "serve ns/req", "zlib ns/req");
+    const std::pair<const char*, ContentCoding> codings[] = {
+        {"", ContentCoding::Identity}, {"gzip", ContentCoding::Gzip}, {"deflate", ContentCoding::Deflate}};
+
+    for (const Asset& asset : assets) {
+        std::string path = "/static/" + asset.name;
+        size_t identity_wire = 0;
+        for (const auto& [accept, coding] : codings) {
+            ResponsePtr response = serve_file(path, accept);
+            if (response->status != "200 OK") {
+                std::fprintf(stderr, "%s: %s\n", path.c_str(), response->status.c_str());
+                return 1;
+            }
+            size_t wire = wire_bytes(*response);
+            if (coding == ContentCoding::Identity) identity_wire = wire;
+
+            std::string label = "serve " + asset.name + " " + std::string(coding_name(coding));
+            auto start = std::chrono::steady_clock::now();
+            const size_t iterations = 200000;
+            for (size_t i = 0; i < iterations; ++i) {
+                bench::do_not_optimize(serve_file(path, accept));
+            }
+            double serve_ns = bench::seconds_since(start) * 1e9 / iterations;
+
+            double zlib_ns = 0;
+            if (coding != ContentCoding::Identity) {
+                std::string out;
+                const size_t rounds = 200;
+                start = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < rounds; ++i) {
+                    compress_body(asset.body, coding, CompressionOptions{}.level, out);
+                    bench::do_not_optimize(out);
+                }
+                zlib_ns = bench::seconds_since(start) * 1e9 / rounds;
+            }
+
+            std::printf("%-10s %-9s %10zu %10zu %6.2fx %14.0f %14.0f\n", asset.name.c_str(),
+                        coding == ContentCoding::Identity ? "identity" : accept, response->body.size(), wire,
+                        static_cast<double>(identity_wire) / static_cast<double>(wire), serve_ns,
+                        serve_ns + zlib_ns);
+        }
+    }
+
+    std::printf("\ngzip level vs size and one-time cost (page.html, %zu bytes):\n", assets[0].body.size());
+    for (int level : {1, 6, 9}) {
+        std::string out;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < 100; ++i) compress_body(assets[0].body, ContentCoding::Gzip, level, out);
+        double us = bench::seconds_since(start) * 1e6 / 100;
+        std::printf("  level %d: %8zu bytes %10.1f us\n", level, out.size(), us);
+    }
+
+    fs::current_path(root);
+    fs::remove_all(scratch);
+    return 0;
+}
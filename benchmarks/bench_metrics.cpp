@@ -0,0 +1,77 @@
+// Cost of recording a metric on the hot path: the per-thread shards of
+// metrics.hpp against one shared atomic counter, alone and with several
+// threads bumping at once, plus the clock reads a PhaseTimer adds.
+//
+//   bench_metrics [threads]
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench_util.hpp"
+#include "metrics.hpp"
+
+namespace {
+
+std::atomic<std::uint64_t> g_shared{0};
+
+// ns per increment, per thread, with `threads` threads running fn at once
+template<typename Fn>
+double run_threads(const std::string& name, size_t threads, size_t iterations, Fn fn) {
+    std::atomic<size_t> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> workers;
+    std::vector<double> seconds(threads);
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            fn();  // Registers the thread's shard outside the timing
+            ready.fetch_add(1);
+            while (!go.load()) std::this_thread::yield();
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < iterations; ++i) fn();
+            seconds[t] = bench::seconds_since(start);
+        });
+    }
+    while (ready.load() < threads) std::this_thread::yield();
+    go.store(true);
+    for (std::thread& worker : workers) worker.join();
+    double total = 0;
+    for (double s : seconds) total += s;
+    double ns_per_op = total * 1e9 / static_cast<double>(threads * iterations);
+    std::printf("%-48s %12.1f ns/op\n", name.c_str(), ns_per_op);
+    return ns_per_op;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    size_t max_threads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4;
+    const size_t iterations = 20000000;
+
+    bench::run("count (per-thread shard)", iterations, []() { count(Counter::Requests); });
+    bench::run("shared atomic fetch_add", iterations, []() {
+        g_shared.fetch_add(1, std::memory_order_relaxed);
+    });
+    bench::run("record_phase", iterations, []() { record_phase(Phase::Parse, std::chrono::nanoseconds(900)); });
+    bench::run("steady_clock::now", iterations, []() {
+        bench::do_not_optimize(std::chrono::steady_clock::now());
+    });
+    bench::run("PhaseTimer (two clock reads + record)", iterations, []() { PhaseTimer timer(Phase::Route); });
+    bench::run("SampledPhaseTimer (1 in 16)", iterations, []() { SampledPhaseTimer timer(Phase::CacheLookup); });
+    std::printf("\n");
+
+    for (size_t threads = 2; threads <= max_threads; threads *= 2) {
+        std::string suffix = " x" + std::to_string(threads) + " threads";
+        run_threads("count (per-thread shard)" + suffix, threads, iterations / threads, []() {
+            count(Counter::Requests);
+        });
+        run_threads("shared atomic fetch_add" + suffix, threads, iterations / threads, []() {
+            g_shared.fetch_add(1, std::memory_order_relaxed);
+        });
+    }
+    bench::do_not_optimize(counter_value(Counter::Requests));
+    return 0;
+}
@@ -0,0 +1,130 @@
+// Middleware overhead by chain depth (0 to 16 pass-through layers) for
+// three ways of composing them:
+//
+//   fn-pointer   the server's chain: a vector of Middleware function
+//                pointers walked by Next, one indirect call per layer
+//   virtual      a vector of objects with a virtual handle(request, next)
+//                that recurses by index
+//   closures     Express-style: each layer gets its continuation as a
+//                std::function built per request (captures big enough to
+//                allocate)
+//
+// Each layer does the same trivial work, so the differences are the cost
+// of the composition itself. Layers alternate between two types so the
+// compiler can't devirtualize or inline its way through a uniform chain.
+
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "bench_util.hpp"
+#include "middleware_chain.hpp"
+
+namespace {
+
+size_t g_seen = 0;
+
+ResponsePtr pass_through(const Request& request, Next next) {
+    g_seen += request.path.size();
+    return next(request);
+}
+
+ResponsePtr pass_through_method(const Request& request, Next next) {
+    g_seen += request.method.size();
+    return next(request);
+}
+
+class Layer {
+public:
+    virtual ~Layer() = default;
+    virtual ResponsePtr handle(const Request& request, const std::vector<std::unique_ptr<Layer>>& chain, size_t index,
+                               const RouteTarget& target) const = 0;
+};
+
+ResponsePtr run_virtual(const std::vector<std::unique_ptr<Layer>>& chain, size_t index, const Request& request,
+                        const RouteTarget& target) {
+    if (index == chain.size()) return target.run(request);
+    return chain[index]->handle(request, chain, index, target);
+}
+
+class PassThroughLayer : public Layer {
+public:
+    ResponsePtr handle(const Request& request, const std::vector<std::unique_ptr<Layer>>& chain, size_t index,
+                       const RouteTarget& target) const override {
+        g_seen += request.path.size();
+        return run_virtual(chain, index + 1, request, target);
+    }
+};
+
+class PassThroughMethodLayer : public Layer {
+public:
+    ResponsePtr handle(const Request& request, const std::vector<std::unique_ptr<Layer>>& chain, size_t index,
+                       const RouteTarget& target) const override {
+        g_seen += request.method.size();
+        return run_virtual(chain, index + 1, request, target);
+    }
+};
+
+using Continuation = std::function<ResponsePtr(const Request&)>;
+using ClosureLayer = std::function<ResponsePtr(const Request&, const Continuation&)>;
+
+ResponsePtr run_closures(const std::vector<ClosureLayer>& chain, size_t index, const Request& request,
+                         const RouteTarget& target) {
+    if (index == chain.size()) return target.run(request);
+    Continuation next = [&chain, index, &target, padding = std::string()](const Request& r) {
+        return run_closures(chain, index + 1, r, target);
+    };
+    return chain[index](request, next);
+}
+
+}  // namespace
+
+int main() {
+    const size_t iterations = 2000000;
+
+    ResponsePtr ok = make_response("200 OK", "text/plain", "ok");
+    RouteHandler handler = [ok](const Request&, const RouteParams&) { return ok; };
+    RouteParams params;
+    RouteTarget target{&handler, &params, nullptr};
+    Request request;
+    request.method = "GET";
+    request.path = "/api/data/42";
+
+    for (size_t depth : {0, 1, 2, 4, 8, 16}) {
+        std::vector<Middleware> pointers;
+        std::vector<std::unique_ptr<Layer>> objects;
+        std::vector<ClosureLayer> closures;
+        for (size_t i = 0; i < depth; ++i) {
+            if (i % 2 == 0) {
+                pointers.push_back(pass_through);
+                objects.push_back(std::make_unique<PassThroughLayer>());
+                closures.push_back([](const Request& r, const Continuation& next) {
+                    g_seen += r.path.size();
+                    return next(r);
+                });
+            } else {
+                pointers.push_back(pass_through_method);
+                objects.push_back(std::make_unique<PassThroughMethodLayer>());
+                closures.push_back([](const Request& r, const Continuation& next) {
+                    g_seen += r.method.size();
+                    return next(r);
+                });
+            }
+        }
+
+        std::string suffix = " depth " + std::to_string(depth);
+        bench::run("fn-pointer" + suffix, iterations, [&]() {
+            bench::do_not_optimize(run_chain(pointers, request, target));
+        });
+        bench::run("virtual" + suffix, iterations, [&]() {
+            bench::do_not_optimize(run_virtual(objects, 0, request, target));
+        });
+        bench::run("closures" + suffix, iterations, [&]() {
+            bench::do_not_optimize(run_closures(closures, 0, request, target));
+        });
+        std::printf("\n");
+    }
+    bench::do_not_optimize(g_seen);
+    return 0;
+}
@@ -0,0 +1,84 @@
+// Route lookup: the old if-chain of exact comparisons (modelled as a linear
+// scan) and an exact-match hash map vs RadixRouter, with 10 to 10000
+// routes. Route sets look like a REST API: per resource, a collection, an
+// item with an {id} capture and a nested static action. The radix lookup
+// should stay flat as routes are added; the scan grows with them, and the
+// hash map can't express captures at all.
+
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "bench_util.hpp"
+#include "radix_router.hpp"
+
+namespace {
+
+struct RouteSet {
+    std::vector<std::string> statics;  // Every static path, for the baselines
+    RadixRouter router;
+};
+
+RouteSet build(size_t resources) {
+    RouteSet set;
+    ResponsePtr ok = make_response("200 OK", "text/plain", "ok");
+    RouteHandler handler = [ok](const Request&, const RouteParams&) { return ok; };
+    for (size_t i = 0; i < resources; ++i) {
+        std::string base = "/api/v1/resource" + std::to_string(i);
+        set.router.add("GET", base, handler);
+        set.router.add("POST", base, handler);
+        set.router.add("GET", base + "/{id}", handler);
+        set.router.add("GET", base + "/{id}/history", handler);
+        set.router.add("GET", base + "/export", handler);
+        set.statics.push_back(base);
+        set.statics.push_back(base + "/export");
+    }
+    set.router.add("GET", "/static/{*path}", handler);
+    return set;
+}
+
+}  // namespace
+
+int main() {
+    const size_t iterations = 1000000;
+
+    for (size_t resources : {2, 20, 200, 2000}) {
+        RouteSet set = build(resources);
+        std::unordered_map<std::string, int> exact;
+        for (const auto& path : set.statics) exact.emplace(path, 1);
+
+        std::string last = "/api/v1/resource" + std::to_string(resources - 1);
+        std::string item = last + "/8c1f2a/history";
+        std::string label = std::to_string(set.router.size()) + " routes";
+        std::printf("%s\n", label.c_str());
+
+        bench::run("  linear scan, last static route", iterations / (resources > 200 ? 100 : 1), [&]() {
+            for (const auto& path : set.statics) {
+                if (path == last) {
+                    bench::do_not_optimize(path);
+                    return;
+                }
+            }
+        });
+        bench::run("  hash map, static route", iterations, [&]() {
+            bench::do_not_optimize(exact.find(last));
+        });
+        bench::run("  radix, static route", iterations, [&]() {
+            bench::do_not_optimize(set.router.find("GET", last).handler);
+        });
+        bench::run("  radix, /{id}/history", iterations, [&]() {
+            bench::do_not_optimize(set.router.find("GET", item).params.size());
+        });
+        bench::run("  radix, /static/{*path}", iterations, [&]() {
+            bench::do_not_optimize(set.router.find("GET", "/static/css/site.css").handler);
+        });
+        bench::run("  radix, 405 (DELETE)", iterations, [&]() {
+            bench::do_not_optimize(set.router.find("DELETE", last).method_not_allowed);
+        });
+        bench::run("  radix, miss", iterations, [&]() {
+            bench::do_not_optimize(set.router.find("GET", "/api/v2/unknown").handler);
+        });
+        std::printf("\n");
+    }
+    return 0;
+}
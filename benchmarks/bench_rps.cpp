@@ -0,0 +1,132 @@
+// Small-response throughput: keep-alive GETs against a running server.
+//
+//   bench_rps <path> [connections] [seconds] [pipeline] [port]
+//
+// Each connection runs on its own thread with `pipeline` requests in flight
+// (1 = classic request/response), counting complete responses. Responses
+// are framed by Content-Length, so any body size works. The server closes
+// a connection after MAX_KEEPALIVE_REQUESTS; the client then reconnects.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench_util.hpp"
+
+namespace {
+
+int connect_to(unsigned short port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Remove one complete response from the front of buffer, if there is one
+bool take_response(std::string& buffer) {
+    size_t head_end = buffer.find("\r\n\r\n");
+    if (head_end == std::string::npos) return false;
+    size_t length = 0;
+    size_t pos = buffer.find("Content-Length: ");
+    if (pos != std::string::npos && pos < head_end) {
+        length = std::strtoull(buffer.c_str() + pos + 16, nullptr, 10);
+    }
+    size_t total = head_end + 4 + length;
+    if (buffer.size() < total) return false;
+    buffer.erase(0, total);
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <path> [connections] [seconds] [pipeline] [port]\n", argv[0]);
+        return 1;
+    }
+    std::string path = argv[1];
+    unsigned connections = argc > 2 ? std::atoi(argv[2]) : 16;
+    double seconds = argc > 3 ? std::atof(argv[3]) : 5.0;
+    unsigned pipeline = argc > 4 ? std::atoi(argv[4]) : 1;
+    unsigned short port = argc > 5 ? static_cast<unsigned short>(std::atoi(argv[5])) : 8080;
+
+    std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\nUser-Agent: bench_rps\r\n\r\n";
+    std::string batch;
+    for (unsigned i = 0; i < pipeline; ++i) batch += request;
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> responses{0};
+    std::atomic<unsigned> failures{0};
+
+    std::vector<std::thread> workers;
+    for (unsigned c = 0; c < connections; ++c) {
+        workers.emplace_back([&]() {
+            int fd = connect_to(port);
+            if (fd < 0) {
+                failures.fetch_add(1);
+                return;
+            }
+            std::string buffer;
+            char chunk[16384];
+            uint64_t done = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (fd < 0) {
+                    failures.fetch_add(1);
+                    break;
+                }
+                if (::send(fd, batch.data(), batch.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(batch.size())) {
+                    ::close(fd);
+                    buffer.clear();
+                    fd = connect_to(port);
+                    continue;
+                }
+                unsigned pending = pipeline;
+                while (pending > 0) {
+                    while (pending > 0 && take_response(buffer)) --pending;
+                    if (pending == 0) break;
+                    ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+                    if (n <= 0) {
+                        // Closed by the server: requests not answered are dropped
+                        ::close(fd);
+                        buffer.clear();
+                        fd = connect_to(port);
+                        break;
+                    }
+                    buffer.append(chunk, static_cast<size_t>(n));
+                }
+                done += pipeline - pending;
+            }
+            responses.fetch_add(done);
+            if (fd >= 0) ::close(fd);
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop.store(true);
+    for (auto& worker : workers) worker.join();
+    double elapsed = bench::seconds_since(start);
+
+    std::printf("%-24s %4u conns x%-3u %12.0f req/s%s\n", path.c_str(), connections, pipeline,
+                static_cast<double>(responses.load()) / elapsed,
+                failures.load() ? " (connection failures)" : "");
+    return failures.load() ? 1 : 0;
+}
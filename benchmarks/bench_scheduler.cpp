@@ -0,0 +1,257 @@
+// Task scheduler: the old ThreadPool (one std::queue of std::function under
+// one mutex, a packaged_task + future per task) vs the work-stealing pool,
+// through both its enqueue() (future) and post() (fire-and-forget) paths.
+//
+//   bench_scheduler [threads]
+//
+// burst   one outside thread submits every task up front
+// fan-out tasks spawn two children until the tree is done (submits from
+//         the workers themselves, which is where per-worker deques help)
+// paced   one task every 20us; measures post-to-start latency of idle workers
+//
+// Task sizes are in units of a ~tiny spin loop, so "0" is pure overhead.
+// Latency is the time from submit to the task starting to run.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+#include "bench_util.hpp"
+#include "thread_pool.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// The ThreadPool this repo used before the work-stealing scheduler
+class LockedQueuePool {
+public:
+    explicit LockedQueuePool(size_t num_threads) {
+        for (size_t i = 0; i < num_threads; ++i) {
+            workers_.emplace_back([this] {
+                while (true) {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock<std::mutex> lock(queue_mutex_);
+                        condition_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+                        if (stop_ && tasks_.empty()) return;
+                        task = std::move(tasks_.front());
+                        tasks_.pop();
+                    }
+                    task();
+                }
+            });
+        }
+    }
+
+    ~LockedQueuePool() {
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            stop_ = true;
+        }
+        condition_.notify_all();
+        for (auto& worker : workers_) worker.join();
+    }
+
+    template<class F>
+    auto enqueue(F&& f) -> std::future<typename std::invoke_result<F>::type> {
+        using return_type = typename std::invoke_result<F>::type;
+        auto task = std::make_shared<std::packaged_task<return_type()>>(std::bind(std::forward<F>(f)));
+        std::future<return_type> res = task->get_future();
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            tasks_.emplace([task]() { (*task)(); });
+        }
+        condition_.notify_one();
+        return res;
+    }
+
+private:
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex queue_mutex_;
+    std::condition_variable condition_;
+    bool stop_ = false;
+};
+
+// Uniform submit interface over the three variants; the futures are
+// dropped, like main.cpp used to do
+struct OldPool {
+    LockedQueuePool pool;
+    explicit OldPool(size_t threads) : pool(threads) {}
+    template<class F> void submit(F&& f) { pool.enqueue(std::forward<F>(f)); }
+};
+
+struct NewEnqueue {
+    ThreadPool pool;
+    explicit NewEnqueue(size_t threads) : pool(threads) {}
+    template<class F> void submit(F&& f) { pool.enqueue(std::forward<F>(f)); }
+};
+
+struct NewPost {
+    ThreadPool pool;
+    explicit NewPost(size_t threads) : pool(threads) {}
+    template<class F> void submit(F&& f) { pool.post(std::forward<F>(f)); }
+};
+
+inline void burn(unsigned units) {
+    volatile unsigned sink = 0;
+    for (unsigned i = 0; i < units; ++i) sink = sink + i;
+}
+
+inline uint64_t nanos_since(Clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+
+void wait_for(const std::atomic<size_t>& done, size_t expected) {
+    while (done.load(std::memory_order_acquire) < expected) std::this_thread::yield();
+}
+
+struct Result {
+    double mtasks_per_s = 0;
+    double p50_us = 0;
+    double p99_us = 0;
+    double p999_us = 0;
+};
+
+void fill_percentiles(Result& result, std::vector<uint64_t>& latencies) {
+    if (latencies.empty()) return;
+    std::sort(latencies.begin(), latencies.end());
+    auto at = [&](double q) {
+        return static_cast<double>(latencies[static_cast<size_t>(q * (latencies.size() - 1))]) / 1000.0;
+    };
+    result.p50_us = at(0.50);
+    result.p99_us = at(0.99);
+    result.p999_us = at(0.999);
+}
+
+template<typename Pool>
+Result run_burst(size_t threads, size_t tasks, unsigned units) {
+    Pool pool(threads);
+    std::vector<uint64_t> latencies(tasks);
+    std::atomic<size_t> done{0};
+    uint64_t* slots = latencies.data();
+    std::atomic<size_t>* counter = &done;
+
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < tasks; ++i) {
+        Clock::time_point submitted = Clock::now();
+        pool.submit([slots, counter, i, submitted, units]() {
+            slots[i] = nanos_since(submitted);
+            burn(units);
+            counter->fetch_add(1, std::memory_order_release);
+        });
+    }
+    wait_for(done, tasks);
+    Result result;
+    result.mtasks_per_s = static_cast<double>(tasks) / bench::seconds_since(start) / 1e6;
+    fill_percentiles(result, latencies);
+    return result;
+}
+
+template<typename Pool>
+struct Tree {
+    Pool* pool;
+    std::atomic<size_t>* done;
+    unsigned units;
+
+    void spawn(int depth) {
+        burn(units);
+        done->fetch_add(1, std::memory_order_release);
+        if (depth == 0) return;
+        Tree self = *this;
+        pool->submit([self, depth]() mutable { self.spawn(depth - 1); });
+        pool->submit([self, depth]() mutable { self.spawn(depth - 1); });
+    }
+};
+
+template<typename Pool>
+Result run_fanout(size_t threads, int depth, unsigned units) {
+    Pool pool(threads);
+    std::atomic<size_t> done{0};
+    size_t tasks = (size_t{1} << (depth + 1)) - 1;
+    Tree<Pool> tree{&pool, &done, units};
+
+    Clock::time_point start = Clock::now();
+    pool.submit([tree, depth]() mutable { tree.spawn(depth); });
+    wait_for(done, tasks);
+    Result result;
+    result.mtasks_per_s = static_cast<double>(tasks) / bench::seconds_since(start) / 1e6;
+    return result;
+}
+
+template<typename Pool>
+Result run_paced(size_t threads, size_t tasks) {
+    Pool pool(threads);
+    std::vector<uint64_t> latencies(tasks);
+    std::atomic<size_t> done{0};
+    uint64_t* slots = latencies.data();
+    std::atomic<size_t>* counter = &done;
+
+    for (size_t i = 0; i < tasks; ++i) {
+        Clock::time_point next = Clock::now() + std::chrono::microseconds(20);
+        Clock::time_point submitted = Clock::now();
+        pool.submit([slots, counter, i, submitted]() {
+            slots[i] = nanos_since(submitted);
+            counter->fetch_add(1, std::memory_order_release);
+        });
+        while (Clock::now() < next) std::this_thread::yield();
+    }
+    wait_for(done, tasks);
+    Result result;
+    fill_percentiles(result, latencies);
+    return result;
+}
+
+void print_row(const char* scenario, unsigned units, const char* name, const Result& result, bool latency) {
+    std::printf("%-8s %6u  %-14s", scenario, units, name);
+    if (result.mtasks_per_s > 0) {
+        std::printf(" %10.2f", result.mtasks_per_s);
+    } else {
+        std::printf(" %10s", "-");
+    }
+    if (latency) {
+        std::printf(" %10.1f %10.1f %10.1f", result.p50_us, result.p99_us, result.p999_us);
+    }
+    std::printf("\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    size_t threads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+    if (threads == 0) threads = 4;
+    const unsigned task_units[] = {0, 100, 1000, 10000};
+
+    std::printf("hardware threads: %u, pool threads: %zu\n\n", std::thread::hardware_concurrency(), threads);
+    std::printf("%-8s %6s  %-14s %10s %10s %10s %10s\n", "scenario", "units", "pool", "Mtasks/s",
+                "p50 us", "p99 us", "p99.9 us");
+
+    for (unsigned units : task_units) {
+        size_t tasks = units >= 10000 ? 20000 : 200000;
+        print_row("burst", units, "old-locked", run_burst<OldPool>(threads, tasks, units), true);
+        print_row("burst", units, "ws-enqueue", run_burst<NewEnqueue>(threads, tasks, units), true);
+        print_row("burst", units, "ws-post", run_burst<NewPost>(threads, tasks, units), true);
+    }
+    std::printf("\n");
+    for (unsigned units : task_units) {
+        int depth = units >= 10000 ? 14 : 17;
+        print_row("fan-out", units, "old-locked", run_fanout<OldPool>(threads, depth, units), false);
+        print_row("fan-out", units, "ws-enqueue", run_fanout<NewEnqueue>(threads, depth, units), false);
+        print_row("fan-out", units, "ws-post", run_fanout<NewPost>(threads, depth, units), false);
+    }
+    std::printf("\n");
+    print_row("paced", 0, "old-locked", run_paced<OldPool>(threads, 5000), true);
+    print_row("paced", 0, "ws-enqueue", run_paced<NewEnqueue>(threads, 5000), true);
+    print_row("paced", 0, "ws-post", run_paced<NewPost>(threads, 5000), true);
+    return 0;
+}
@@ -0,0 +1,42 @@
+#ifndef BENCH_UTIL_HPP
+#define BENCH_UTIL_HPP
+
+// Minimal timing helpers shared by the micro-benchmarks. Each benchmark is a
+// plain executable (built with -DTEZ_BUILD_BENCHMARKS=ON) that prints one line
+// per case so results can be pasted into metrics/.
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+namespace bench {
+
+// Keep the compiler from discarding a computed value
+template<typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Run fn() `iterations` times and print ns/op and ops/s
+template<typename Fn>
+double run(const std::string& name, size_t iterations, Fn&& fn) {
+    // Warm up caches and branch predictors
+    for (size_t i = 0; i < iterations / 10 + 1; ++i) fn();
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) fn();
+    double elapsed = seconds_since(start);
+
+    double ns_per_op = elapsed * 1e9 / static_cast<double>(iterations);
+    std::printf("%-48s %12.1f ns/op %14.0f ops/s\n", name.c_str(), ns_per_op,
+                static_cast<double>(iterations) / elapsed);
+    return ns_per_op;
+}
+
+}  // namespace bench
+
+#endif
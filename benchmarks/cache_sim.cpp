@@ -0,0 +1,171 @@
+// Trace-driven cache simulator: replays an access trace against the cache
+// configurations the server can run with and prints hit ratios.
+//
+//   cache_sim [trace] [--bytes N] [--entries N] [--size N]
+//
+// Trace lines are either "<key> [bytes]" or server.log lines
+// ("[ts] ip - METHOD path"); entries without a size use --size (4096).
+// Without a trace, a synthetic one is generated: Zipf-distributed requests
+// over 10,000 files interleaved with one-off scans of cold files.
+//
+// Every configuration replays the same trace single-threaded as
+// get-then-put-on-miss, which is what the router and file server do.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "sharded_cache.hpp"
+
+namespace {
+
+struct Access {
+    std::string key;
+    size_t bytes;
+};
+
+bool load_trace(const std::string& path, size_t default_size, std::vector<Access>& trace) {
+    std::ifstream in(path);
+    if (!in) return false;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        Access access{"", default_size};
+        if (!line.empty() && line[0] == '[') {
+            // server.log: "[ts] ip - METHOD path"
+            std::string ts, ip, dash, method;
+            if (!(fields >> ts >> ip >> dash >> method >> access.key)) continue;
+        } else {
+            if (!(fields >> access.key)) continue;
+            size_t bytes;
+            if (fields >> bytes) access.bytes = bytes;
+        }
+        trace.push_back(std::move(access));
+    }
+    return true;
+}
+
+std::vector<Access> synthetic_trace(size_t length) {
+    const size_t files = 10000;
+    const double skew = 0.9;
+
+    std::vector<double> cdf(files);
+    double total = 0;
+    for (size_t i = 0; i < files; ++i) {
+        total += 1.0 / std::pow(static_cast<double>(i + 1), skew);
+        cdf[i] = total;
+    }
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> uniform(0.0, total);
+    std::lognormal_distribution<double> size_dist(8.5, 1.2);  // Median ~5 KB
+    std::vector<size_t> sizes(files);
+    for (auto& size : sizes) size = std::min<size_t>(static_cast<size_t>(size_dist(rng)) + 100, 1024 * 1024);
+
+    std::vector<Access> trace;
+    trace.reserve(length);
+    size_t scan_id = 0;
+    while (trace.size() < length) {
+        // Every 50,000 requests someone walks 5,000 files nobody else wants
+        if (trace.size() % 50000 == 25000) {
+            for (size_t i = 0; i < 5000; ++i, ++scan_id) {
+                trace.push_back({"/static/archive/" + std::to_string(scan_id), 16 * 1024});
+            }
+            continue;
+        }
+        size_t rank = static_cast<size_t>(std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin());
+        rank = std::min(rank, files - 1);
+        trace.push_back({"/static/file_" + std::to_string(rank), sizes[rank]});
+    }
+    return trace;
+}
+
+struct Result {
+    double hit_ratio;
+    double byte_hit_ratio;
+    CacheStats stats;
+};
+
+Result replay(const std::vector<Access>& trace, const CacheOptions& options) {
+    ShardedCache<size_t> cache(options, [](const size_t& bytes) { return bytes; });
+    size_t hit_bytes = 0, total_bytes = 0;
+    for (const Access& access : trace) {
+        total_bytes += access.bytes;
+        if (cache.get(access.key)) {
+            hit_bytes += access.bytes;
+        } else {
+            cache.put(access.key, std::max<size_t>(access.bytes, 1));  // 0 reads as a miss
+        }
+    }
+    CacheStats stats = cache.stats();
+    return {stats.hit_ratio(), total_bytes ? static_cast<double>(hit_bytes) / total_bytes : 0.0, stats};
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string trace_path;
+    size_t max_bytes = 64 * 1024 * 1024;
+    size_t max_entries = 50;  // What the old file cache held
+    size_t default_size = 4096;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--bytes" && i + 1 < argc) {
+            max_bytes = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--entries" && i + 1 < argc) {
+            max_entries = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--size" && i + 1 < argc) {
+            default_size = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            trace_path = arg;
+        }
+    }
+
+    std::vector<Access> trace;
+    if (trace_path.empty()) {
+        trace = synthetic_trace(1000000);
+        std::printf("trace: synthetic (%zu requests)\n", trace.size());
+    } else if (!load_trace(trace_path, default_size, trace)) {
+        std::fprintf(stderr, "cannot read %s\n", trace_path.c_str());
+        return 1;
+    } else {
+        std::printf("trace: %s (%zu requests)\n", trace_path.c_str(), trace.size());
+    }
+
+    struct Config {
+        const char* name;
+        CacheOptions options;
+    };
+    auto make = [](size_t entries, size_t bytes, EvictionPolicy policy, bool admission) {
+        CacheOptions options;
+        options.max_entries = entries;
+        options.max_bytes = bytes;
+        options.ttl_seconds = 24 * 3600;  // Traces are replayed faster than real time
+        options.policy = policy;
+        options.admission = admission;
+        return options;
+    };
+    std::vector<Config> configs = {
+        {"lru, entry limit (old cache)", make(max_entries, 0, EvictionPolicy::Lru, false)},
+        {"lru, byte budget", make(0, max_bytes, EvictionPolicy::Lru, false)},
+        {"clock, byte budget", make(0, max_bytes, EvictionPolicy::Clock, false)},
+        {"tinylfu, byte budget", make(0, max_bytes, EvictionPolicy::Clock, true)},
+    };
+
+    std::printf("byte budget %zu, entry limit %zu\n\n", max_bytes, max_entries);
+    std::printf("%-30s %10s %10s %10s %10s\n", "policy", "hit%", "byte hit%", "evicted", "rejected");
+    for (const Config& config : configs) {
+        Result result = replay(trace, config.options);
+        std::printf("%-30s %9.2f%% %9.2f%% %10llu %10llu\n", config.name, result.hit_ratio * 100.0,
+                    result.byte_hit_ratio * 100.0, static_cast<unsigned long long>(result.stats.evictions),
+                    static_cast<unsigned long long>(result.stats.rejections));
+    }
+    return 0;
+}
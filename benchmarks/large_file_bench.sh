@@ -0,0 +1,64 @@
+#!/usr/bin/env bash
+# Large static-file downloads: sendfile path vs the in-memory path.
+# Reports wall time, throughput and the server's peak RSS (Linux /proc).
+#
+# Usage: benchmarks/large_file_bench.sh [build_dir] [size_mb] [concurrent] [rounds]
+set -euo pipefail
+
+ROOT_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+BUILD_DIR="${1:-$ROOT_DIR/build}"
+SIZE_MB="${2:-50}"
+CONCURRENT="${3:-16}"
+ROUNDS="${4:-4}"
+FILE_NAME="bench_${SIZE_MB}mb.bin"
+URL="http://127.0.0.1:8080/static/$FILE_NAME"
+OUT="$ROOT_DIR/metrics/$(date +%Y-%m-%d_%H-%M-%S)_large_file_sendfile.txt"
+
+[ -x "$BUILD_DIR/Tez" ] || { echo "Tez binary not found in $BUILD_DIR"; exit 1; }
+command -v curl >/dev/null || { echo "curl not found"; exit 1; }
+
+CONFIG="$(mktemp)"
+trap 'rm -f "$CONFIG" "$ROOT_DIR/static/$FILE_NAME"' EXIT
+head -c "$((SIZE_MB * 1024 * 1024))" /dev/urandom > "$ROOT_DIR/static/$FILE_NAME"
+
+run_case() {
+    local label="$1" threshold="$2"
+    echo "{\"server\": {\"sendfile_threshold\": $threshold}}" > "$CONFIG"
+
+    (cd "$BUILD_DIR" && TEZ_CONFIG="$CONFIG" exec ./Tez >/dev/null 2>&1) &
+    local pid=$!
+    sleep 1
+
+    local start end
+    start=$(date +%s.%N)
+    for _ in $(seq "$ROUNDS"); do
+        for _ in $(seq "$CONCURRENT"); do
+            curl -s -o /dev/null "$URL" &
+        done
+        wait $(jobs -p | grep -v "^$pid$") 2>/dev/null || true
+    done
+    end=$(date +%s.%N)
+
+    local rss="n/a"
+    if [ -r "/proc/$pid/status" ]; then
+        rss=$(awk '/VmHWM/ {print $2 " " $3}' "/proc/$pid/status")
+    fi
+
+    local total_mb=$((SIZE_MB * CONCURRENT * ROUNDS))
+    {
+        echo "=== $label (sendfile_threshold=$threshold) ==="
+        awk -v s="$start" -v e="$end" -v mb="$total_mb" \
+            'BEGIN { t = e - s; printf "transferred: %d MB in %.2f s (%.1f MB/s)\n", mb, t, mb / t }'
+        echo "peak RSS:    $rss"
+        echo
+    } | tee -a "$OUT"
+
+    kill -INT "$pid" 2>/dev/null || true
+    wait "$pid" 2>/dev/null || true
+}
+
+echo "$CONCURRENT concurrent downloads x $ROUNDS rounds of a $SIZE_MB MB file" | tee "$OUT"
+run_case "in-memory" 0
+run_case "sendfile" 1048576
+
+echo "Results written to $OUT"
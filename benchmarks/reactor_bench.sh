@@ -0,0 +1,48 @@
+#!/usr/bin/env bash
+# Compare the shared io_context model (one acceptor, N threads) with the
+# multi-reactor model (N SO_REUSEPORT acceptors, one thread each).
+#
+# Usage: benchmarks/reactor_bench.sh [build_dir] [reactors] [requests] [concurrency]
+# Requires ApacheBench (ab). Results are also written to metrics/.
+set -euo pipefail
+
+ROOT_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+BUILD_DIR="${1:-$ROOT_DIR/build}"
+REACTORS="${2:-$(nproc 2>/dev/null || sysctl -n hw.ncpu)}"
+REQUESTS="${3:-100000}"
+CONCURRENCY="${4:-200}"
+URL="http://127.0.0.1:8080/health"
+OUT="$ROOT_DIR/metrics/$(date +%Y-%m-%d_%H-%M-%S)_reactor_vs_shared.txt"
+
+command -v ab >/dev/null || { echo "ab not found (apache2-utils / httpd)"; exit 1; }
+[ -x "$BUILD_DIR/Tez" ] || { echo "Tez binary not found in $BUILD_DIR"; exit 1; }
+
+CONFIG="$(mktemp)"
+trap 'rm -f "$CONFIG"' EXIT
+
+run_case() {
+    local label="$1" server_json="$2"
+    echo "{\"server\": $server_json}" > "$CONFIG"
+
+    (cd "$BUILD_DIR" && TEZ_CONFIG="$CONFIG" ./Tez >/dev/null 2>&1) &
+    local pid=$!
+    sleep 1
+
+    {
+        echo "=== $label: $server_json ==="
+        echo "--- new connection per request ---"
+        ab -q -n "$REQUESTS" -c "$CONCURRENCY" "$URL" | grep -E "Requests per second|Time per request|Failed requests|  50%|  99%"
+        echo "--- keep-alive ---"
+        ab -q -k -n "$REQUESTS" -c "$CONCURRENCY" "$URL" | grep -E "Requests per second|Time per request|Failed requests|  50%|  99%"
+        echo
+    } | tee -a "$OUT"
+
+    kill -INT "$pid" 2>/dev/null || true
+    wait "$pid" 2>/dev/null || true
+}
+
+run_case "shared io_context" "{\"reactors\": 0, \"threads\": $REACTORS}"
+run_case "multi-reactor" "{\"reactors\": $REACTORS}"
+run_case "multi-reactor (pinned)" "{\"reactors\": $REACTORS, \"pin_reactors\": true}"
+
+echo "Results written to $OUT"
@@ -0,0 +1,44 @@
+#!/usr/bin/env bash
+# Small-response throughput for cached routes and a cached static file.
+# Pass a second build directory to compare two builds (e.g. before/after).
+#
+# Usage: benchmarks/small_response_bench.sh [build_dir] [baseline_build_dir] [seconds]
+# Needs bench_rps (cmake -DTEZ_BUILD_BENCHMARKS=ON). Results are also written to metrics/.
+set -euo pipefail
+
+ROOT_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+BUILD_DIR="${1:-$ROOT_DIR/build}"
+BASELINE_DIR="${2:-}"
+SECONDS_PER_CASE="${3:-5}"
+PATHS=("/" "/about" "/static/style.css")
+OUT="$ROOT_DIR/metrics/$(date +%Y-%m-%d_%H-%M-%S)_small_response_rps.txt"
+
+[ -x "$BUILD_DIR/Tez" ] || { echo "Tez binary not found in $BUILD_DIR"; exit 1; }
+[ -x "$BUILD_DIR/bench_rps" ] || { echo "bench_rps not found in $BUILD_DIR (TEZ_BUILD_BENCHMARKS=ON)"; exit 1; }
+
+run_build() {
+    local label="$1" dir="$2"
+
+    (cd "$dir" && TEZ_CONFIG="$ROOT_DIR/config.json" exec ./Tez >/dev/null 2>&1) &
+    local pid=$!
+    sleep 1
+
+    {
+        echo "=== $label ($dir) ==="
+        for path in "${PATHS[@]}"; do
+            "$BUILD_DIR/bench_rps" "$path" 16 "$SECONDS_PER_CASE" 1
+            "$BUILD_DIR/bench_rps" "$path" 16 "$SECONDS_PER_CASE" 16
+        done
+        echo
+    } | tee -a "$OUT"
+
+    kill -INT "$pid" 2>/dev/null || true
+    wait "$pid" 2>/dev/null || true
+}
+
+if [ -n "$BASELINE_DIR" ]; then
+    run_build "baseline" "$BASELINE_DIR"
+fi
+run_build "current" "$BUILD_DIR"
+
+echo "Results written to $OUT"
@@ -0,0 +1,45 @@
+#ifndef ACCESS_LOG_HPP
+#define ACCESS_LOG_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Asynchronous access log. Workers copy a fixed-size record into a
+// per-thread single-producer ring (no locks, no allocation, no syscalls);
+// a background thread drains every ring each flush interval (or as soon as
+// one is half full), formats the records into one buffer and appends it to
+// the log with large writes. A full ring drops the record and counts it.
+//
+// Until start_access_log() is called (and after stop_access_log()),
+// log_access() appends synchronously, one line per call.
+struct AccessLogConfig {
+    bool enabled = true;
+    std::string path = "server.log";
+    unsigned flush_interval_ms = 100;
+    size_t ring_records = 8192;   // Per worker thread, rounded up to a power of two
+    std::uint64_t max_bytes = 0;  // Rotate when the file would grow past this (0 = never)
+    unsigned max_files = 5;       // Rotated files kept: path.1 (newest) .. path.N
+    bool json = false;            // JSON lines instead of the plain text format
+};
+
+struct AccessLogStats {
+    std::uint64_t written = 0;  // Records written to the file
+    std::uint64_t dropped = 0;  // Records lost to full rings
+    std::uint64_t rotations = 0;
+};
+
+// Plain text:  [1729130000] 127.0.0.1 - GET /about 200 172 41us
+// JSON lines:  {"ts":1729130000,"ip":"127.0.0.1","method":"GET","path":"/about",
+//               "status":200,"bytes":172,"latency_us":41}
+// status 0 means unknown; the text format then stops after the path.
+void log_access(std::string_view client_ip, std::string_view method, std::string_view path,
+                int status = 0, std::uint64_t bytes = 0, std::uint32_t latency_us = 0);
+
+// Start the background writer (replacing a running one)
+void start_access_log(const AccessLogConfig& config);
+// Drain every ring, flush and join the writer
+void stop_access_log();
+AccessLogStats access_log_stats();
+
+#endif
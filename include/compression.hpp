@@ -0,0 +1,37 @@
+#ifndef COMPRESSION_HPP
+#define COMPRESSION_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Response compression knobs, read from the optional "compression" object
+// in config.json (see server_config.hpp)
+struct CompressionOptions {
+    bool enabled = true;
+    int level = 6;              // zlib level, 1 (fastest) .. 9 (smallest)
+    size_t min_bytes = 256;     // Smaller bodies are sent as they are
+};
+
+enum class ContentCoding {
+    Identity,
+    Gzip,
+    Deflate,  // The zlib format, as HTTP's "deflate" coding specifies
+};
+
+// Content-Encoding value ("" for Identity)
+std::string_view coding_name(ContentCoding coding);
+
+// Pick the best coding the client accepts from an Accept-Encoding value:
+// gzip over deflate over identity, honouring q-values (q=0 refuses a
+// coding) and "*". A missing or empty header means identity.
+ContentCoding negotiate_coding(std::string_view accept_encoding);
+
+// Text-like MIME types that shrink well; images, media, fonts and
+// archives are already compressed
+bool is_compressible(std::string_view content_type);
+
+// Compress input with zlib. Returns false on failure or for Identity.
+bool compress_body(std::string_view input, ContentCoding coding, int level, std::string& out);
+
+#endif
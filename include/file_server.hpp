@@ -1,9 +1,43 @@
 #ifndef FILE_SERVER_HPP
 #define FILE_SERVER_HPP
 
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include "compression.hpp"
 #include "response.hpp"  // Add this
 
-Response serve_file(const std::string& path);
+// Files of at least this many bytes are returned as a FileBody and sent with
+// sendfile instead of being read into memory and cached (0 = never)
+constexpr std::uint64_t DEFAULT_SENDFILE_THRESHOLD = 1024 * 1024;  // 1 MB
+void set_sendfile_threshold(std::uint64_t bytes);
+
+// Compressible files (text, JS, JSON, XML, SVG) are negotiated against
+// Accept-Encoding and carry "Vary: Accept-Encoding". A gzip/deflate variant
+// is built once, from a fresh "<file>.gz" sibling when there is one or with
+// zlib otherwise, and kept in the file cache next to the identity variant.
+void set_compression_options(const CompressionOptions& options);
+
+// Cache-Control value per lowercase extension (".css"), with "*" as the
+// fallback; files with no matching policy get no Cache-Control line
+void set_cache_control_policies(const std::unordered_map<std::string, std::string>& policies);
+
+// Successful file responses carry a strong ETag (modification time + size,
+// plus the coding for compressed variants), Last-Modified and the
+// extension's Cache-Control, and a pre-serialized 304 head for
+// is_not_modified() hits.
+ResponsePtr serve_file(const std::string& path, std::string_view accept_encoding = {});
+
+// Watch ../static with inotify and drop the cached representations of each
+// file as it changes, so file cache entries can live until evicted for
+// space. Returns false when the tree can't be watched (or off Linux); the
+// file cache TTL is then the only way changes are picked up.
+bool start_static_watcher();
+void stop_static_watcher();
+
+// Drop every cached representation of a file under ../static ("css/a.css");
+// an empty path drops the whole file cache. Called by the watcher.
+void invalidate_static_file(const std::string& relative_path);
 
 #endif
\ No newline at end of file
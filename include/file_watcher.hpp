@@ -0,0 +1,53 @@
+#ifndef FILE_WATCHER_HPP
+#define FILE_WATCHER_HPP
+
+#include <functional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+struct WatchOptions {
+    bool recursive = true;          // Subdirectories too, including ones created later
+    bool completed_writes = false;  // Only files closed after writing or renamed into place
+};
+
+// Watches a directory tree with inotify on a background thread and reports
+// changed files. By default subdirectories are watched recursively,
+// including ones created later, and every write is reported.
+//
+// The callback runs on the watcher thread with the changed file's path
+// relative to the root ("css/site.css"), or with an empty path when
+// anything under the root may have changed (a directory was created,
+// removed or renamed, or the kernel queue overflowed and events were lost).
+class FileWatcher {
+public:
+    using Callback = std::function<void(const std::string& relative_path)>;
+
+    FileWatcher() = default;
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // Returns false if the root can't be watched, or on platforms without
+    // inotify; callers then keep relying on cache TTLs
+    bool start(const std::string& root, Callback callback, WatchOptions options = {});
+    void stop();
+
+    bool running() const { return thread_.joinable(); }
+
+private:
+    void run();
+    void watch_tree(const std::string& relative_dir);
+    void handle_events(const char* buffer, long length);
+
+    std::string root_;
+    Callback callback_;
+    WatchOptions options_;
+    std::thread thread_;
+    int inotify_fd_ = -1;
+    int wake_fd_ = -1;  // eventfd that tells the thread to stop
+    std::unordered_map<int, std::string> dirs_;  // Watch descriptor -> directory relative to the root
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef HANDLER_ARENA_HPP
+#define HANDLER_ARENA_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+// Per-connection memory for the operations Asio allocates on every async
+// call (the read, the write, the timer wait). Asio recycles one freed
+// operation per thread, which a session with a read and a timer in flight
+// exhausts on every request. The arena keeps a few fixed slots instead;
+// an operation too big for a slot, or one that finds them all busy, goes
+// to the heap. Slots are claimed atomically because Asio frees an
+// operation before dispatching its handler onto the session's strand.
+class HandlerArena {
+public:
+    static constexpr size_t SLOT_SIZE = 1024;
+    static constexpr size_t SLOT_COUNT = 4;
+
+    HandlerArena() = default;
+    HandlerArena(const HandlerArena&) = delete;
+    HandlerArena& operator=(const HandlerArena&) = delete;
+
+    void* allocate(size_t size) {
+        if (size <= SLOT_SIZE) {
+            for (size_t i = 0; i < SLOT_COUNT; ++i) {
+                if (!used_[i].exchange(true, std::memory_order_acquire)) {
+                    return slots_[i];
+                }
+            }
+        }
+        return ::operator new(size);
+    }
+
+    void deallocate(void* p) {
+        for (size_t i = 0; i < SLOT_COUNT; ++i) {
+            if (p == slots_[i]) {
+                used_[i].store(false, std::memory_order_release);
+                return;
+            }
+        }
+        ::operator delete(p);
+    }
+
+private:
+    alignas(std::max_align_t) unsigned char slots_[SLOT_COUNT][SLOT_SIZE];
+    std::atomic<bool> used_[SLOT_COUNT] = {};
+};
+
+// Allocator drawing from a HandlerArena, found by Asio as a handler's
+// associated allocator
+template<typename T>
+class HandlerAllocator {
+public:
+    using value_type = T;
+
+    explicit HandlerAllocator(HandlerArena& arena) noexcept : arena_(&arena) {}
+    template<typename U>
+    HandlerAllocator(const HandlerAllocator<U>& other) noexcept : arena_(other.arena_) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena_->allocate(sizeof(T) * n)); }
+    void deallocate(T* p, size_t) noexcept { arena_->deallocate(p); }
+
+    template<typename U>
+    bool operator==(const HandlerAllocator<U>& other) const noexcept { return arena_ == other.arena_; }
+    template<typename U>
+    bool operator!=(const HandlerAllocator<U>& other) const noexcept { return arena_ != other.arena_; }
+
+private:
+    template<typename> friend class HandlerAllocator;
+    HandlerArena* arena_;
+};
+
+// A completion handler whose operation is allocated from arena. The arena
+// must outlive the operation; sessions keep themselves alive through the
+// handler, so their own arena does.
+template<typename Handler>
+class ArenaHandler {
+public:
+    using allocator_type = HandlerAllocator<Handler>;
+
+    ArenaHandler(HandlerArena& arena, Handler handler) : arena_(&arena), handler_(std::move(handler)) {}
+
+    allocator_type get_allocator() const noexcept { return allocator_type(*arena_); }
+
+    template<typename... Args>
+    void operator()(Args&&... args) {
+        handler_(std::forward<Args>(args)...);
+    }
+
+private:
+    HandlerArena* arena_;
+    Handler handler_;
+};
+
+template<typename Handler>
+ArenaHandler<std::decay_t<Handler>> bind_arena(HandlerArena& arena, Handler&& handler) {
+    return ArenaHandler<std::decay_t<Handler>>(arena, std::forward<Handler>(handler));
+}
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef HEADERS_HPP
+#define HEADERS_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Headers the server itself looks at, interned at parse time
+enum class HeaderId : uint8_t {
+    Host,
+    Connection,
+    ContentLength,
+    ContentType,
+    TransferEncoding,
+    Expect,
+    Accept,
+    AcceptEncoding,
+    IfNoneMatch,
+    IfModifiedSince,
+    Range,
+    IfRange,
+    UserAgent,
+    Authorization,
+    Cookie,
+    Count,
+    Unknown = Count
+};
+
+constexpr size_t WELL_KNOWN_HEADER_COUNT = static_cast<size_t>(HeaderId::Count);
+
+// Case-insensitive; HeaderId::Unknown for anything not in the table
+HeaderId lookup_header_id(std::string_view name);
+
+// Lowercase canonical name ("" for Unknown)
+std::string_view header_name(HeaderId id);
+
+// Flat header container. Well-known headers live in a fixed array indexed by
+// HeaderId, so looking them up is O(1) with no hashing or allocation; any
+// other header goes into a small vector with its name lowercased.
+// Setting a header that is already present replaces its value. clear()
+// keeps every string's capacity, so a map refilled per request settles
+// into not allocating.
+class HeaderMap {
+public:
+    void set(std::string_view name, std::string_view value);
+    void set(HeaderId id, std::string_view value);
+
+    // nullptr if absent
+    const std::string* get(HeaderId id) const {
+        size_t i = static_cast<size_t>(id);
+        return i < WELL_KNOWN_HEADER_COUNT && (present_ & (1u << i)) ? &known_[i] : nullptr;
+    }
+    const std::string* get(std::string_view name) const;
+
+    bool contains(HeaderId id) const { return get(id) != nullptr; }
+    bool contains(std::string_view name) const { return get(name) != nullptr; }
+
+    size_t size() const;
+    bool empty() const { return size() == 0; }
+    void clear();
+
+    // Visit every header as (lowercase name, value)
+    template<typename Fn>
+    void for_each(Fn&& fn) const {
+        for (size_t i = 0; i < WELL_KNOWN_HEADER_COUNT; ++i) {
+            if (present_ & (1u << i)) fn(header_name(static_cast<HeaderId>(i)), std::string_view(known_[i]));
+        }
+        for (size_t i = 0; i < other_count_; ++i) {
+            fn(std::string_view(other_[i].first), std::string_view(other_[i].second));
+        }
+    }
+
+private:
+    std::array<std::string, WELL_KNOWN_HEADER_COUNT> known_;
+    uint32_t present_ = 0;
+    std::vector<std::pair<std::string, std::string>> other_;  // Only the first other_count_ are set
+    size_t other_count_ = 0;
+};
+
+#endif
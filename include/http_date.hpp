@@ -0,0 +1,23 @@
+#ifndef HTTP_DATE_HPP
+#define HTTP_DATE_HPP
+
+#include <cstddef>
+#include <ctime>
+#include <string_view>
+
+constexpr size_t HTTP_DATE_LENGTH = 29;  // "Sun, 06 Nov 1994 08:49:37 GMT"
+
+// Format a UTC time as an IMF-fixdate (RFC 9110 5.6.7) into out, without
+// locales or allocation. out must hold HTTP_DATE_LENGTH bytes.
+void format_http_date(std::time_t time, char* out);
+
+// Parse an IMF-fixdate (as sent back in If-Modified-Since). The obsolete
+// RFC 850 and asctime forms are not accepted; callers treat them as absent.
+bool parse_http_date(std::string_view text, std::time_t& out);
+
+// The current time as an IMF-fixdate, for the Date header. Each thread keeps
+// its own copy and reformats it at most once per second, so callers never
+// share gmtime's static buffer. Valid until the thread's next call.
+std::string_view http_date();
+
+#endif
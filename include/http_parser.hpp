@@ -0,0 +1,145 @@
+#ifndef HTTP_PARSER_HPP
+#define HTTP_PARSER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "headers.hpp"
+
+constexpr size_t MAX_HEADER_COUNT = 64;  // Headers per request
+
+struct HeaderField {
+    std::string_view name;   // As sent (not lowercased)
+    std::string_view value;  // Surrounding whitespace trimmed
+    HeaderId id;             // Interned at parse time, Unknown if not well known
+};
+
+// Resumable, non-allocating HTTP/1.x request-head parser.
+//
+// Feed it the bytes of the current request received so far (always starting
+// at the request's first byte); it only looks at bytes it has not examined
+// yet, so it can be called again after every read. The buffer may move
+// between calls since progress is kept as offsets. Once parse() returns
+// Complete, the accessors return string_views into the data passed to that
+// call, valid until the caller modifies the buffer.
+class RequestParser {
+public:
+    enum class Result { Complete, Incomplete, Error };
+
+    explicit RequestParser(size_t max_header_size = 8 * 1024);
+
+    Result parse(std::string_view data);
+    void reset();
+
+    std::string_view method() const { return method_; }
+    std::string_view target() const { return target_; }
+    std::string_view version() const { return version_; }
+    const HeaderField* headers() const { return fields_; }
+    size_t header_count() const { return header_count_; }
+
+    // Case-insensitive lookup of the first header with this name
+    const HeaderField* find_header(std::string_view name) const;
+    const HeaderField* find_header(HeaderId id) const;  // O(1)
+    std::string_view header(std::string_view name) const;  // "" if absent
+
+    // Bytes taken by the request line, headers and the blank line
+    size_t header_length() const { return header_length_; }
+
+    // HTTP status to reply with after an Error (400, 431 or 505)
+    int error_status() const { return error_status_; }
+
+private:
+    struct Span {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    enum class State { RequestLine, Headers, Done };
+    enum class Step { Progress, NeedMore, EndOfHead, Error };
+
+    Result fail(int status);
+    Step fail_step(int status);
+    Result parse_request_line(std::string_view line, size_t line_start);
+    Step parse_header_line(std::string_view data);
+    void publish(std::string_view data);
+
+    size_t max_header_size_;
+    State state_ = State::RequestLine;
+    size_t line_start_ = 0;  // Start of the first line not parsed yet
+    size_t scanned_ = 0;     // Bytes already searched for the request line's end
+    Span method_span_{}, target_span_{}, version_span_{};
+    Span name_spans_[MAX_HEADER_COUNT];
+    Span value_spans_[MAX_HEADER_COUNT];
+    HeaderId ids_[MAX_HEADER_COUNT];
+    uint8_t first_index_[WELL_KNOWN_HEADER_COUNT];  // 1 + index of first occurrence, 0 if absent
+    size_t header_count_ = 0;
+    size_t header_length_ = 0;
+    int error_status_ = 0;
+
+    std::string_view method_, target_, version_;
+    HeaderField fields_[MAX_HEADER_COUNT];
+};
+
+// Resumable decoder for a chunked request body (RFC 9112 7.1).
+//
+// Feed it the body bytes received so far, starting after what the previous
+// call consumed. Each call decodes framing until it reaches chunk data, the
+// end of the body, or the end of the input; data comes back as a view into
+// the input (no copy), possibly a piece of a larger chunk. Chunk extensions
+// and trailer fields are validated for size and skipped. Line ends are CRLF
+// or, like RequestParser accepts, a bare LF.
+class ChunkedDecoder {
+public:
+    enum class Result {
+        Data,      // data holds the next piece of the body
+        NeedMore,  // All input consumed; call again with more
+        Done,      // Last chunk and trailers read; consumed stops right after them
+        Error,     // Malformed framing (answer 400 and close)
+    };
+
+    explicit ChunkedDecoder(size_t max_line_size = 8 * 1024);
+
+    // consumed is how many input bytes were used (framing plus data)
+    Result decode(std::string_view input, size_t& consumed, std::string_view& data);
+    void reset();
+
+private:
+    enum class State {
+        Size, Extension, SizeLineEnd,
+        Data, DataLineEnd, DataLineEndLf,
+        TrailerStart, Trailer, TrailerLineEnd, LastLineEnd,
+        Done
+    };
+
+    size_t max_line_size_;
+    State state_ = State::Size;
+    std::uint64_t remaining_ = 0;  // Chunk size while parsing it, then data bytes left
+    size_t size_digits_ = 0;
+    size_t line_size_ = 0;         // Extension or trailer section bytes, against max_line_size_
+    bool error_ = false;
+};
+
+// Strict Content-Length parse: digits only, no sign, no overflow.
+// Returns -1 for an invalid value.
+long long parse_content_length(std::string_view value);
+
+// ASCII case-insensitive equality (header names, tokens)
+inline bool iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        char x = a[i] >= 'A' && a[i] <= 'Z' ? static_cast<char>(a[i] + ('a' - 'A')) : a[i];
+        char y = b[i] >= 'A' && b[i] <= 'Z' ? static_cast<char>(b[i] + ('a' - 'A')) : b[i];
+        if (x != y) return false;
+    }
+    return true;
+}
+
+// Strip optional whitespace (spaces and tabs) from both ends of a header
+// value or list element
+inline std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+#endif
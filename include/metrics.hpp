@@ -0,0 +1,139 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Runtime metrics, served in the Prometheus text format on GET /metrics.
+//
+// Every thread records into its own shard, registered the first time it
+// records. A shard's counters and histogram buckets are relaxed atomics
+// written only by that thread (a load and a store, no locked instruction),
+// so recording costs a few nanoseconds and never contends; a scrape sums
+// the shards. Shards outlive their threads, so totals never go backwards.
+//
+// Latencies go into HDR-style histograms: log-linear buckets, 8 per power
+// of two from 1 ns up to about 137 s, so every percentile is known to
+// within 12.5%.
+
+enum class Phase : std::uint8_t {
+    Read,         // First byte of a request to its last
+    Parse,        // Head parsed and copied into the Request
+    Route,        // Middleware and handler (includes the two below)
+    CacheLookup,  // One response cache lookup (sampled)
+    ServeFile,    // Static file: file cache lookup, or load and compression
+    Write,        // A batch handed to the socket until the write completes
+    Count
+};
+
+constexpr size_t PHASE_COUNT = static_cast<size_t>(Phase::Count);
+
+enum class Counter : std::uint8_t {
+    ConnectionsAccepted,
+    ConnectionsClosed,
+    Requests,
+    ResponseBodyBytes,
+    Responses1xx,
+    Responses2xx,
+    Responses3xx,
+    Responses4xx,
+    Responses5xx,
+    Count
+};
+
+constexpr size_t COUNTER_COUNT = static_cast<size_t>(Counter::Count);
+
+void count(Counter counter, std::uint64_t n = 1);
+// One answered request: its status class and body size
+void count_response(int status, std::uint64_t body_bytes);
+void record_phase(Phase phase, std::chrono::steady_clock::duration elapsed);
+
+// Records the lifetime of a scope into phase
+class PhaseTimer {
+public:
+    explicit PhaseTimer(Phase phase) : phase_(phase), start_(std::chrono::steady_clock::now()) {}
+    ~PhaseTimer() { record_phase(phase_, std::chrono::steady_clock::now() - start_); }
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    Phase phase_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// A PhaseTimer for one scope in PHASE_SAMPLE_PERIOD on each thread, for
+// phases shorter than the two clock reads that would time them. The
+// percentiles stay representative; the phase's count is 1/PHASE_SAMPLE_PERIOD
+// of the real one.
+constexpr unsigned PHASE_SAMPLE_PERIOD = 16;
+
+class SampledPhaseTimer {
+public:
+    explicit SampledPhaseTimer(Phase phase) : phase_(phase) {
+        thread_local unsigned countdown = 0;
+        if (countdown-- == 0) {
+            countdown = PHASE_SAMPLE_PERIOD - 1;
+            sampled_ = true;
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+    ~SampledPhaseTimer() {
+        if (sampled_) record_phase(phase_, std::chrono::steady_clock::now() - start_);
+    }
+
+    SampledPhaseTimer(const SampledPhaseTimer&) = delete;
+    SampledPhaseTimer& operator=(const SampledPhaseTimer&) = delete;
+
+private:
+    Phase phase_;
+    bool sampled_ = false;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Histogram bucket layout: values below 8 ns get a bucket each, then every
+// power of two is split into 8 equal buckets. Longer values land in the
+// last bucket.
+constexpr unsigned LATENCY_SUB_BUCKET_BITS = 3;
+constexpr unsigned LATENCY_MAX_BITS = 37;
+constexpr size_t LATENCY_BUCKET_COUNT = (LATENCY_MAX_BITS - LATENCY_SUB_BUCKET_BITS + 1) << LATENCY_SUB_BUCKET_BITS;
+
+inline size_t latency_bucket(std::uint64_t ns) {
+    constexpr std::uint64_t sub_buckets = 1u << LATENCY_SUB_BUCKET_BITS;
+    if (ns < sub_buckets) return static_cast<size_t>(ns);
+    if (ns >> LATENCY_MAX_BITS) return LATENCY_BUCKET_COUNT - 1;
+    unsigned exponent = 63 - static_cast<unsigned>(__builtin_clzll(ns));
+    unsigned shift = exponent - LATENCY_SUB_BUCKET_BITS;
+    return ((shift + 1) << LATENCY_SUB_BUCKET_BITS) + static_cast<size_t>((ns >> shift) & (sub_buckets - 1));
+}
+
+// Smallest value past bucket (its exclusive upper bound, in ns)
+std::uint64_t latency_bucket_limit(size_t bucket);
+
+// Totals across every thread at one moment
+struct LatencySnapshot {
+    std::uint64_t buckets[LATENCY_BUCKET_COUNT] = {};
+    std::uint64_t count = 0;
+    std::uint64_t sum_ns = 0;
+
+    // Upper bound of the bucket holding quantile q (0..1); 0 when empty
+    std::uint64_t quantile_ns(double q) const;
+};
+
+std::uint64_t counter_value(Counter counter);
+LatencySnapshot phase_snapshot(Phase phase);
+
+// A value sampled at scrape time, such as a thread pool's queue depth.
+// Register before serving; name should be a valid Prometheus metric name.
+void add_metrics_gauge(const std::string& name, const std::string& help, std::function<double()> sample);
+void clear_metrics_gauges();
+
+// Every metric in the Prometheus text exposition format (version 0.0.4),
+// including the response and file cache statistics and the access log's
+// counts
+std::string render_metrics();
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef MIDDLEWARE_HPP
 #define MIDDLEWARE_HPP
+#include "middleware_chain.hpp"
 #include "response.hpp"
+#include "sharded_cache.hpp"
 #include <chrono>
 #include <unordered_map>
 #include <fstream>
@@ -8,9 +10,31 @@
 #include <string>
 
 void log_request(const std::string& client_ip, const std::string& method, const std::string& path);
-Response get_cached_response(const std::string& path);
+
+// Cache lookups return nullptr on a miss
+ResponsePtr get_cached_response(const std::string& path);
+void cache_response(const std::string& path, ResponsePtr response);
 void cache_response(const std::string& path, const Response& response);
-Response get_cached_file(const std::string& path);  // New for static files
-void cache_file(const std::string& path, const Response& response);  // New for static files
+void clear_response_cache();
+ResponsePtr get_cached_file(const std::string& path);  // New for static files
+void cache_file(const std::string& path, ResponsePtr response);  // New for static files
+void cache_file(const std::string& path, const Response& response);
+bool erase_cached_file(const std::string& path);
+void clear_file_cache();
+
+// Middleware that answers repeated GETs from the response cache, keyed by
+// path. Only complete in-memory 200s are stored: streams, file bodies,
+// static files (responses with validators or Accept-Ranges, which the file
+// cache holds), responses that vary by Accept-Encoding and
+// "Cache-Control: no-store" ones always go to the handler. Publishing a new
+// route table clears the cache; other handlers' responses stay until
+// evicted or expired, so only enable it for routes whose answers don't
+// change.
+ResponsePtr cache_middleware(const Request& request, Next next);
+
+// Rebuild both caches with new limits (call before serving; drops entries)
+void configure_caches(const CacheOptions& response_options, const CacheOptions& file_options);
+CacheStats response_cache_stats();
+CacheStats file_cache_stats();
 
 #endif
\ No newline at end of file
@@ -0,0 +1,55 @@
+#ifndef MIDDLEWARE_CHAIN_HPP
+#define MIDDLEWARE_CHAIN_HPP
+
+#include <vector>
+#include "radix_router.hpp"
+
+// What a request was routed to: its handler, or the fixed response (404 or
+// 405) that stands in for one
+struct RouteTarget {
+    const RouteHandler* handler = nullptr;
+    const RouteParams* params = nullptr;
+    const ResponsePtr* response = nullptr;  // Used when there is no handler
+
+    ResponsePtr run(const Request& request) const { return handler ? (*handler)(request, *params) : *response; }
+};
+
+class Next;
+
+// Middleware sees each routed request on its way to the handler and the
+// response on its way back. It continues with next(request), or answers
+// by itself without calling it. Middleware are plain function pointers
+// kept in a vector built before serving, so running a chain costs one
+// indirect call per layer: no per-request allocation, std::function or
+// virtual calls. Settings come from globals set before serving, like the
+// rest of the server's knobs.
+using Middleware = ResponsePtr (*)(const Request& request, Next next);
+
+// The rest of a chain after the running middleware: three pointers,
+// passed by value
+class Next {
+public:
+    Next(const Middleware* layer, const Middleware* end, const RouteTarget* target)
+        : layer_(layer), end_(end), target_(target) {}
+
+    ResponsePtr operator()(const Request& request) const {
+        if (layer_ == end_) {
+            return target_->run(request);
+        }
+        return (*layer_)(request, Next(layer_ + 1, end_, target_));
+    }
+
+    const RouteTarget& target() const { return *target_; }
+
+private:
+    const Middleware* layer_;
+    const Middleware* end_;
+    const RouteTarget* target_;
+};
+
+// Run request through chain, outermost first, then target
+inline ResponsePtr run_chain(const std::vector<Middleware>& chain, const Request& request, const RouteTarget& target) {
+    return Next(chain.data(), chain.data() + chain.size(), &target)(request);
+}
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef RADIX_ROUTER_HPP
+#define RADIX_ROUTER_HPP
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include "request.hpp"
+#include "response.hpp"
+
+// Captures per route pattern beyond this many are refused when adding it
+constexpr size_t MAX_ROUTE_PARAMS = 8;
+
+// Values captured by {name} and {*name}, in pattern order. Views into the
+// route's pattern and the request path: valid while both are. The storage
+// is left uninitialized, so an unused RouteParams costs nothing to build.
+class RouteParams {
+public:
+    // The capture's value; empty when the route has no such capture
+    std::string_view get(std::string_view name) const {
+        for (size_t i = 0; i < size_; ++i) {
+            if (this->name(i) == name) return value(i);
+        }
+        return {};
+    }
+
+    size_t size() const { return size_; }
+    std::string_view name(size_t i) const { return {items_[i].name, items_[i].name_length}; }
+    std::string_view value(size_t i) const { return {items_[i].value, items_[i].value_length}; }
+
+private:
+    friend class RadixRouter;
+
+    void push(std::string_view name, std::string_view value) {
+        items_[size_++] = {name.data(), name.size(), value.data(), value.size()};
+    }
+
+    struct Capture {
+        const char* name;
+        size_t name_length;
+        const char* value;
+        size_t value_length;
+    };
+
+    std::array<Capture, MAX_ROUTE_PARAMS> items_;
+    size_t size_ = 0;
+};
+
+using RouteHandler = std::function<ResponsePtr(const Request& request, const RouteParams& params)>;
+
+struct RouteMatch {
+    const RouteHandler* handler = nullptr;  // The path and method matched
+    // The path matched but not the method: its prebuilt 405, whose Allow
+    // lists the methods that did
+    const ResponsePtr* method_not_allowed = nullptr;
+    RouteParams params;
+};
+
+// Path router over a compressed prefix tree. A pattern is made of:
+//
+//   static bytes   "/api/data/"
+//   {name}         one non-empty path segment ("/api/data/{id}")
+//   {*name}        the rest of the path, possibly empty; last in a pattern
+//                  ("/static/{*path}")
+//
+// Captures span whole segments. A HEAD with no route of its own takes the
+// GET route, and Allow lists it next to GET. Each node keeps a small method table, so
+// one walk answers both "which route" and "which methods". A lookup costs
+// one pass over the path whatever the number of routes: static children
+// are picked by their first byte, and static beats {name} beats {*name},
+// falling back to the next kind only when the more specific branch dead-ends.
+//
+// Routes are added before serving; lookups are const and need no locking.
+class RadixRouter {
+public:
+    RadixRouter();
+    ~RadixRouter();
+    RadixRouter(RadixRouter&&) noexcept;
+    RadixRouter& operator=(RadixRouter&&) noexcept;
+
+    // Throws std::invalid_argument for a malformed pattern, a capture whose
+    // name differs from the one already at that position, or a method and
+    // pattern that are already routed
+    void add(std::string_view method, std::string_view pattern, RouteHandler handler);
+
+    RouteMatch find(std::string_view method, std::string_view path) const;
+
+    size_t size() const { return routes_; }
+
+    struct Node;  // Defined in radix_router.cpp
+
+private:
+    static const Node* match(const Node& node, std::string_view path, RouteParams& params);
+
+    std::unique_ptr<Node> root_;
+    size_t routes_ = 0;
+};
+
+#endif
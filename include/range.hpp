@@ -0,0 +1,53 @@
+#ifndef RANGE_HPP
+#define RANGE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "response.hpp"
+
+// Ranges beyond this many in one request are refused (the Range header is
+// ignored), so a client can't make one small request expand into a huge
+// multipart response
+constexpr size_t MAX_BYTE_RANGES = 16;
+
+// Inclusive byte positions, already clamped to the representation
+struct ByteRange {
+    std::uint64_t first = 0;
+    std::uint64_t last = 0;
+
+    std::uint64_t length() const { return last - first + 1; }
+};
+
+enum class RangeResult {
+    Ignore,          // No usable "bytes" ranges: send the whole response
+    Satisfiable,     // ranges holds at least one range, sorted and merged
+    Unsatisfiable,   // Well-formed, but no range overlaps the representation
+};
+
+// Parse a Range value (RFC 9110 14.1.2: "bytes=0-99,200-", "bytes=-500")
+// against a representation of size bytes. Overlapping or adjacent ranges
+// are merged; invalid syntax or too many ranges means Ignore.
+RangeResult parse_byte_ranges(std::string_view header, std::uint64_t size, std::vector<ByteRange>& ranges);
+
+// Whether an If-Range value still names the response, so Range applies:
+// an entity tag must equal the strong ETag, a date must equal Last-Modified.
+// A missing header (nullptr) always matches.
+bool if_range_matches(const Response& response, const std::string* if_range);
+
+// The 206 for a full 200 static file response: a single range keeps the
+// content type and carries Content-Range, several become
+// multipart/byteranges. File bodies stay on disk (the ranges become
+// sendfile offsets); only in-memory bodies are sliced.
+ResponsePtr make_range_response(const Response& full, const std::vector<ByteRange>& ranges);
+
+// 416 Range Not Satisfiable with "Content-Range: bytes */size"
+ResponsePtr make_unsatisfiable_response(std::uint64_t size);
+
+// Apply a request's Range and If-Range headers (nullptr when absent) to a
+// response that accepts ranges; returns it unchanged when they don't apply
+ResponsePtr apply_range(const ResponsePtr& response, const std::string* range, const std::string* if_range);
+
+#endif
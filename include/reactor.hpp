@@ -0,0 +1,33 @@
+#ifndef REACTOR_HPP
+#define REACTOR_HPP
+
+#include <boost/asio.hpp>
+#include <thread>
+
+// A single-threaded event loop with its own SO_REUSEPORT acceptor. The kernel
+// spreads incoming connections across all reactors bound to the port, and a
+// connection then lives on its reactor's thread for its whole life, so no
+// strands or cross-thread handoff are needed.
+class Reactor {
+public:
+    // cpu < 0 leaves the thread unpinned
+    Reactor(unsigned short port, int cpu);
+    ~Reactor();
+
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    void start();
+    void stop();
+    void join();
+
+private:
+    void do_accept();
+
+    boost::asio::io_context io_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    std::thread thread_;
+    int cpu_;
+};
+
+#endif
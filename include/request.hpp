@@ -2,13 +2,13 @@
 #define REQUEST_HPP
 
 #include <string>
-#include <unordered_map>
+#include "headers.hpp"
 
 struct Request {
     std::string method;
     std::string path;
     std::string version;
-    std::unordered_map<std::string, std::string> headers;
+    HeaderMap headers;
     std::string body;
 };
 
@@ -16,6 +16,6 @@ struct Request {
 Request parse_request(const std::string& raw_request);
 
 // Extract Content-Length from headers
-int get_content_length(const std::unordered_map<std::string, std::string>& headers);
+int get_content_length(const HeaderMap& headers);
 
 #endif
@@ -1,12 +1,112 @@
 #ifndef RESPONSE_HPP
 #define RESPONSE_HPP
 
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <optional>
 #include <string>
+#include <vector>
+
+// One byte range of a multipart/byteranges file body, sent after its part
+// header
+struct FileSegment {
+    std::string prefix;  // Delimiter and part header lines
+    std::uint64_t offset = 0;
+    std::uint64_t length = 0;
+};
+
+// A body sent straight from disk (sendfile) instead of from memory: either
+// [offset, offset + length) of the file, or, when segments is non-empty,
+// each segment followed by trailer (length is then the total on the wire)
+struct FileBody {
+    std::string path;
+    std::uint64_t offset = 0;
+    std::uint64_t length = 0;
+    std::vector<FileSegment> segments;
+    std::string trailer;
+};
+
+// Resumes a paused body stream. Safe to call from any thread, and after the
+// connection is gone.
+using BodyResume = std::function<void()>;
+
+// A response body produced over time, for handlers that shouldn't build the
+// whole body before the first byte goes out. It is sent with
+// Transfer-Encoding: chunked (HTTP/1.0: unframed, then the connection
+// closes). The session pulls the next piece only once the previous one has
+// been written, so output is paced by the socket and a fast producer never
+// queues more than one piece. Called on the connection's strand.
+class BodyStream {
+public:
+    enum class Status {
+        Data,     // out holds the next piece
+        Pending,  // Nothing yet: call the resume function once there is
+        Done,     // End of the body; out may hold a last piece
+    };
+
+    virtual ~BodyStream() = default;
+    // Before the first pull. A stream pending for longer than the request
+    // timeout loses the connection.
+    virtual void start(BodyResume resume) { (void)resume; }
+    virtual Status pull(std::string& out) = 0;
+    // The connection failed before Done
+    virtual void on_error() {}
+};
+
+// Stream from a callback that appends the next piece to out and returns
+// false when that was the last one (out may then be empty). Never Pending,
+// so each call should be quick.
+std::shared_ptr<BodyStream> make_generator_stream(std::function<bool(std::string& out)> next);
 
 struct Response {
     std::string status;
     std::string content_type;
     std::string body;
+    std::optional<FileBody> file;  // When set, replaces body on the wire
+    std::shared_ptr<BodyStream> stream;  // When set, replaces body; single use, never cache
+    std::string content_encoding;  // "gzip" / "deflate"; empty for identity
+    bool vary_accept_encoding = false;  // Another Accept-Encoding may get other bytes
+    // Validators and caching policy (static files); empty / 0 when unset
+    std::string etag;                // Quoted strong entity tag
+    std::time_t last_modified = 0;
+    std::string cache_control;
+    bool accept_ranges = false;      // Sends "Accept-Ranges: bytes" (Range is honoured)
+    std::string content_range;       // Content-Range value of a 206 / 416
+    std::string allow;               // Allow value of a 405 ("GET, POST")
+    // Serialized status line and the headers that don't change per request
+    // (filled by make_response; empty means "serialize when sending")
+    std::string head;
+    // Head of the matching 304 Not Modified, when the response has
+    // validators (filled by make_response)
+    std::string not_modified_head;
 };
 
+// Responses are shared read-only between the caches and in-flight writes,
+// so a cache hit only bumps a reference count
+using ResponsePtr = std::shared_ptr<const Response>;
+
+// Append the status line, Content-Type, the optional Content-Encoding,
+// Content-Range, Accept-Ranges, Allow, Vary, ETag, Last-Modified and Cache-Control
+// lines, Server and Content-Length (left out for a stream, whose framing
+// depends on the request). The per-request headers (Transfer-Encoding,
+// Date, Connection) and the blank line follow.
+void append_response_head(std::string& out, const Response& response);
+
+// Freeze a response for sharing, serializing its head (and 304 head) once
+// up front
+ResponsePtr make_response(Response response);
+
+// A plain in-memory response: status line, type and body, everything else
+// left at its default
+ResponsePtr make_response(std::string status, std::string content_type, std::string body);
+
+// Whether a GET/HEAD with these conditional headers (nullptr when absent)
+// should get the response's 304 instead: If-None-Match is checked against
+// the ETag (weak comparison, "*" matches), and If-Modified-Since against
+// Last-Modified only when If-None-Match is absent (RFC 9110 13.2.2).
+bool is_not_modified(const Response& response, const std::string* if_none_match,
+                     const std::string* if_modified_since);
+
 #endif
\ No newline at end of file
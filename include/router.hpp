@@ -1,14 +1,83 @@
 #ifndef ROUTER_HPP
 #define ROUTER_HPP
 
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
+#include <string_view>
+#include "middleware_chain.hpp"
 #include "response.hpp"
 #include "request.hpp"
 
 // Initialize the router configuration (call once at startup)
 void init_router_config();
 
-Response handle_route(const std::string& path);
-Response handle_route_with_method(const std::string& method, const std::string& path, const std::string& body);
+// Config routes ("/path": {status, content_type, body}) are compiled into an
+// immutable route tree of ready-to-send responses. A reload builds a new one
+// off to the side and publishes it atomically: lookups never lock, and
+// requests already holding a response finish with it. If the file can't be
+// read or an entry is invalid, the current routes stay in place and false
+// is returned.
+bool load_router_config(const std::string& path);
+bool reload_router_config();  // From config_path(), e.g. on SIGHUP
+
+// Reload whenever config.json is saved (Linux inotify). Returns false if
+// its directory can't be watched.
+bool start_config_watcher();
+void stop_config_watcher();
+
+// Route a complete request: the built-in routes (/health, /metrics, /echo,
+// /api/data[/{id}], /api/stream, /static/{*path}), then the config routes.
+// A path routed for other methods gets a 405 with Allow; an unknown one a 404.
+ResponsePtr route_request(const Request& request);
+// GET of path
+ResponsePtr handle_route(const std::string& path);
+
+// Embedding API. Register before serving; lookups don't lock.
+//
+// add_route adds a handler next to the built-ins (see radix_router.hpp for
+// patterns). A handler returns a ready response, or one with a BodyStream.
+// Throws std::invalid_argument for a bad pattern or a method and pattern
+// that are already routed.
+void add_route(const std::string& method, const std::string& pattern, RouteHandler handler);
+
+// Middleware run in the order added (the first added is outermost) around
+// every request route_request answers, including its 404s and 405s.
+// Streaming routes (below) bypass the chain.
+void add_middleware(Middleware middleware);
+void clear_middleware();
+
+// Consumer of a request body that is handed over piece by piece as it
+// arrives (Content-Length or chunked), instead of being buffered first, so
+// an upload of any size takes constant memory. Runs on the connection's
+// strand; pieces are views into the read buffer, valid only during the call.
+class BodySink {
+public:
+    enum class Flow {
+        Continue,  // Keep reading
+        Pause,     // Stop reading the socket until the resume function is called
+        Abort,     // Reject the rest: on_end() gives the response, then the connection closes
+    };
+
+    virtual ~BodySink() = default;
+    virtual Flow on_data(std::string_view data) = 0;
+    // The body is complete (or was aborted): the response to send
+    virtual ResponsePtr on_end() = 0;
+    // The body was malformed or too large, or the client went away; no
+    // response will be sent
+    virtual void on_error() {}
+};
+
+// Creates the sink for one request, given its head; nullptr buffers the
+// body and dispatches it like any other request
+using StreamingHandler = std::function<std::unique_ptr<BodySink>(const Request& request, BodyResume resume)>;
+
+// Streaming routes are registered before serving. Bodies for every other
+// route are buffered (up to MAX_CONTENT_LENGTH) and passed to
+// route_request. Built in: POST/PUT /upload, which counts the
+// bytes it receives.
+void add_streaming_route(const std::string& method, const std::string& path, StreamingHandler handler);
+const StreamingHandler* find_streaming_route(std::string_view method, std::string_view path);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,79 @@
+#ifndef SERVER_CONFIG_HPP
+#define SERVER_CONFIG_HPP
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include "access_log.hpp"
+#include "compression.hpp"
+#include "sharded_cache.hpp"
+
+CacheOptions default_response_cache_options();
+CacheOptions default_file_cache_options();
+
+constexpr int FALLBACK_FILE_CACHE_TTL_SECONDS = 60;
+
+// Server tuning knobs, read from the optional "server" object in config.json:
+//
+//   "server": { "port": 8080, "threads": 0, "reactors": 4, "pin_reactors": true,
+//               "sendfile_threshold": 1048576, "watch_static": true, "watch_config": true }
+//
+// With watch_static, an inotify watcher drops file cache entries as files
+// under ../static change, so file entries don't expire (file ttl_seconds
+// defaults to 0). If the watcher can't start, a file ttl of 0 becomes
+// FALLBACK_FILE_CACHE_TTL_SECONDS.
+//
+// Routes are reloaded from config.json on SIGHUP and, with watch_config,
+// whenever the file is saved. Server settings take effect only at startup.
+//
+// Cache sizing comes from the optional "cache" object:
+//
+//   "cache": { "response": { "max_entries": 100, "max_bytes": 8388608, "ttl_seconds": 60,
+//                            "policy": "clock" },
+//              "file": { "max_entries": 0, "max_bytes": 67108864, "policy": "tinylfu" } }
+//
+// policy is "lru", "clock" or "tinylfu" (CLOCK plus W-TinyLFU admission);
+// a limit of 0 means unlimited.
+//
+// The access log comes from the optional "log" object:
+//
+//   "log": { "enabled": true, "path": "server.log", "format": "json", "flush_interval_ms": 100,
+//            "ring_records": 8192, "max_bytes": 104857600, "max_files": 5 }
+//
+// format is "text" or "json" (JSON lines with status, bytes and latency).
+//
+// Static file compression comes from the optional "compression" object:
+//
+//   "compression": { "enabled": true, "level": 6, "min_bytes": 256 }
+//
+// level is the zlib level (1-9); bodies below min_bytes are not compressed.
+//
+// Cache-Control for static files comes from the optional "cache_control"
+// object, keyed by extension with "*" as the fallback:
+//
+//   "cache_control": { ".css": "public, max-age=31536000, immutable",
+//                      ".html": "no-cache", "*": "public, max-age=3600" }
+//
+// Missing keys keep their defaults.
+struct ServerConfig {
+    unsigned short port = 8080;
+    unsigned int threads = 0;       // io_context threads in shared mode (0 = CPU cores)
+    unsigned int reactors = 0;      // 0 = one shared io_context, N = N SO_REUSEPORT reactors
+    bool pin_reactors = false;      // Pin reactor i to core i (Linux only)
+    std::uint64_t sendfile_threshold = 1024 * 1024;  // Static files this large use sendfile (0 = never)
+    bool watch_static = true;       // Invalidate cached static files on change (Linux inotify)
+    bool watch_config = true;       // Reload routes when config.json changes (Linux inotify)
+    CacheOptions response_cache = default_response_cache_options();
+    CacheOptions file_cache = default_file_cache_options();
+    AccessLogConfig access_log;
+    CompressionOptions compression;
+    std::unordered_map<std::string, std::string> cache_control;  // Extension -> Cache-Control
+};
+
+// Path of config.json: $TEZ_CONFIG if set, otherwise ../config.json (from build/)
+std::string config_path();
+
+// Load the "server" section of the config file, falling back to defaults
+ServerConfig load_server_config(const std::string& path);
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef SESSION_HPP
+#define SESSION_HPP
+
+#include <boost/asio.hpp>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "handler_arena.hpp"
+#include "http_parser.hpp"
+#include "request.hpp"
+#include "response.hpp"
+#include "router.hpp"
+
+// Security limits
+constexpr size_t MAX_CONTENT_LENGTH = 10 * 1024 * 1024;  // 10 MB, buffered bodies
+constexpr std::uint64_t MAX_STREAMED_BODY_LENGTH = 16ull << 30;  // 16 GB, bodies fed to a BodySink
+constexpr size_t MAX_HEADER_SIZE = 8 * 1024;              // 8 KB
+constexpr size_t MAX_KEEPALIVE_REQUESTS = 1000;           // Max requests per connection
+constexpr int REQUEST_TIMEOUT_SECONDS = 30;               // Request timeout
+
+constexpr size_t READ_CHUNK_SIZE = 16 * 1024;              // Bytes requested per socket read
+constexpr size_t FILE_SLICE_SIZE = 1024 * 1024;            // File bytes sent before yielding to other connections
+constexpr size_t MAX_RETAINED_BODY_SIZE = 64 * 1024;      // Larger request body buffers are freed after use
+
+// One keep-alive connection. Drives an async read -> parse -> dispatch -> write
+// loop on the socket's executor, so an idle client never pins a thread.
+// The socket should be created on a strand when the io_context is run by
+// several threads (the read timer and the I/O chain share that strand).
+//
+// Bytes are read into a persistent per-connection buffer. Every complete
+// request it holds is answered in order (HTTP/1.1 pipelining), and the
+// responses of one batch go out with a single write; leftover bytes are kept
+// for the next read. Each response's status line and fixed headers are
+// serialized once when it is created (Response::head) and written from the
+// shared response, next to a few per-request lines (Date, Connection).
+//
+// A response with a FileBody ends the batch: its head is written first and
+// the file follows with sendfile(2) (a bounded pread/write loop where
+// sendfile is unavailable), never passing through user-space buffers.
+// A multipart/byteranges file body alternates small part-header writes with
+// sendfile over each range.
+//
+// Request bodies with Content-Length are buffered and dispatched whole.
+// Chunked bodies are decoded as they arrive (ChunkedDecoder), and bodies for
+// a streaming route are fed to its BodySink in pieces of at most one read,
+// so the connection holds a bounded amount of body whatever its size. A
+// sink that pauses stops the reads, and TCP flow control pushes back on
+// the client; one paused past REQUEST_TIMEOUT_SECONDS loses the connection.
+// "Expect: 100-continue" is answered when such a body starts.
+//
+// A response with a BodyStream also ends the batch. Each piece it produces
+// is written as one chunk, and the next is pulled when that write completes.
+//
+// The connection's Request is refilled in place for each request, and its
+// async operations are allocated from a HandlerArena, so a keep-alive
+// connection serving prebuilt responses stops touching the heap. A request
+// body over MAX_RETAINED_BODY_SIZE is freed once it has been answered.
+//
+// GETs of static files honour Range and If-Range (see range.hpp); the 206
+// or 416 is built per request from the shared full response.
+class Session : public std::enable_shared_from_this<Session> {
+public:
+    explicit Session(boost::asio::ip::tcp::socket socket);
+    ~Session();
+
+    void start();
+
+private:
+    void arm_timeout();
+    void do_read();
+    void on_read(const boost::system::error_code& ec, size_t bytes);
+    void process_buffer();
+    bool handle_request(const Request& request, std::chrono::steady_clock::time_point parsed);
+    bool queue_response(const Request& request, ResponsePtr response,
+                        std::chrono::steady_clock::time_point started,
+                        std::chrono::steady_clock::time_point routed);
+    void start_body(const StreamingHandler* handler, bool chunked, std::uint64_t content_length);
+    bool read_body(size_t& offset);
+    bool deliver_body(std::string_view data);
+    void finish_body();
+    void fail_body(const char* canned_response);
+    void resume_body();
+    void do_stream();
+    void finish_stream();
+    void resume_stream();
+    BodyResume resume_handler(void (Session::*resume)());
+    void do_write();
+    void on_write(const boost::system::error_code& ec, size_t bytes);
+    void do_send_file();
+    void send_next_segment();
+    void on_response_sent();
+    void close_file();
+    void close();
+
+    HandlerArena handler_arena_;  // Declared first: outlives the socket and timer
+    boost::asio::ip::tcp::socket socket_;
+    boost::asio::steady_timer timer_;
+    std::string client_ip_;
+    std::string read_buffer_;   // Unconsumed bytes received from the client
+    std::string write_buffer_;  // Per-request header lines of the current batch
+
+    // Responses of the current batch, kept alive until the write completes.
+    // Their per-request lines are write_buffer_[tail_start, tail_end).
+    // A not_modified entry sends the response's 304 head and no body.
+    struct BatchEntry {
+        size_t tail_start;
+        size_t tail_end;
+        ResponsePtr response;
+        bool not_modified = false;
+        bool head_only = false;  // HEAD: the head goes out, the body never does
+    };
+    std::vector<BatchEntry> batch_;
+    std::vector<boost::asio::const_buffer> write_iov_;
+    RequestParser parser_;      // Head of the request at the front of read_buffer_
+    Request request_;           // Refilled for each request, keeping its capacity
+    size_t read_hint_ = 0;      // Bytes still missing from a partially received body
+    size_t request_count_ = 0;  // Track requests per connection
+    bool close_after_write_ = false;
+    bool output_pending_ = false;  // A batch or file body is being written
+
+    // Phase timing (metrics.hpp): when the request being read first showed
+    // up, where the next parse starts, and when the batch write began
+    std::chrono::steady_clock::time_point arrived_;
+    std::chrono::steady_clock::time_point mark_;
+    std::chrono::steady_clock::time_point write_started_;
+    bool request_partial_ = false;  // The last pass stopped inside a request
+
+    // Request whose body is still arriving (chunked, or for a streaming route)
+    enum class BodyMode { None, Buffered, Streaming };
+    BodyMode body_mode_ = BodyMode::None;  // request_ holds its head meanwhile
+    std::chrono::steady_clock::time_point body_started_;
+    ChunkedDecoder chunked_;
+    bool body_chunked_ = false;
+    std::uint64_t body_remaining_ = 0;  // Content-Length bytes still to come
+    std::uint64_t body_received_ = 0;
+    std::unique_ptr<BodySink> sink_;
+    bool sink_paused_ = false;
+
+    // File body queued behind the current batch
+    int file_fd_ = -1;
+    std::uint64_t file_offset_ = 0;
+    std::uint64_t file_remaining_ = 0;
+    ResponsePtr file_response_;  // Multipart body whose segments are being sent
+    size_t file_segment_ = 0;    // Next segment; segments.size() is the trailer
+    std::string file_chunk_;  // Only used where sendfile is unavailable
+
+    // Streamed body queued behind the current batch
+    std::shared_ptr<BodyStream> stream_;
+    bool stream_chunked_ = false;  // Chunked framing; HTTP/1.0 gets raw bytes up to the close
+    bool stream_waiting_ = false;  // Pending until the stream's resume function is called
+    std::string stream_piece_;
+    std::string stream_size_line_;
+};
+
+#endif
@@ -0,0 +1,415 @@
+#ifndef SHARDED_CACHE_HPP
+#define SHARDED_CACHE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+enum class EvictionPolicy {
+    Lru,    // Exact LRU: every hit relinks the entry under the shard's write lock
+    Clock   // Approximate LRU (second chance): hits only set a reference bit under a read lock
+};
+
+// Limits are for the whole cache and are split evenly between the shards.
+// A limit of 0 means unlimited.
+struct CacheOptions {
+    size_t max_entries = 100;
+    size_t max_bytes = 0;
+    int ttl_seconds = 60;  // 0 = entries never expire (only capacity evicts them)
+    size_t shards = 16;
+    EvictionPolicy policy = EvictionPolicy::Clock;
+    // W-TinyLFU: new entries land in a small LRU window (1% of the capacity)
+    // and only move into the main cache if a frequency sketch says they are
+    // used more often than the entry they would evict
+    bool admission = false;
+};
+
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;   // Entries pushed out to make room
+    uint64_t rejections = 0;  // New entries refused by admission or for being too large
+    size_t entries = 0;
+    size_t bytes = 0;
+
+    double hit_ratio() const {
+        uint64_t lookups = hits + misses;
+        return lookups ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0;
+    }
+};
+
+// Concurrent TTL cache split into independently locked shards by key hash.
+//
+// Each shard keeps its entries in an unordered_map whose nodes are threaded
+// onto intrusive recency lists, so the key is stored once and a hit never
+// allocates. Capacity is divided evenly between the shards, which makes
+// eviction approximate across the whole cache but keeps every operation
+// local to one lock.
+template<typename Value>
+class ShardedCache {
+public:
+    // Size of a value in bytes, for max_bytes (the key is always counted)
+    using Weigher = std::function<size_t(const Value&)>;
+
+    ShardedCache(size_t max_size, int ttl_seconds, size_t shard_count = 16,
+                 EvictionPolicy policy = EvictionPolicy::Lru)
+        : ShardedCache(CacheOptions{max_size, 0, ttl_seconds, shard_count, policy, false}) {}
+
+    explicit ShardedCache(const CacheOptions& options, Weigher weigher = {})
+        : ttl_(std::chrono::seconds(options.ttl_seconds)), policy_(options.policy),
+          admission_(options.admission), weigher_(std::move(weigher)) {
+        // Power-of-two shard count, never more shards than entries
+        size_t limit = options.max_entries ? options.max_entries : SIZE_MAX;
+        size_t shards = 1;
+        while (shards < options.shards && shards * 2 <= limit) shards *= 2;
+        shard_count_ = shards;
+        shard_mask_ = shards - 1;
+        entry_capacity_ = options.max_entries ? (options.max_entries + shards - 1) / shards : 0;
+        byte_capacity_ = options.max_bytes ? (options.max_bytes + shards - 1) / shards : 0;
+        window_entries_ = entry_capacity_ / 100;
+        window_bytes_ = byte_capacity_ / 100;
+        shards_ = std::make_unique<Shard[]>(shards);
+
+        if (admission_) {
+            // One sketch column per expected entry; with only a byte limit,
+            // assume 4 KB per entry
+            size_t expected = entry_capacity_ ? entry_capacity_ : byte_capacity_ / 4096;
+            size_t width = 64;
+            while (width < expected) width *= 2;
+            for (size_t i = 0; i < shards; ++i) shards_[i].sketch.init(width);
+        }
+    }
+
+    // Copy of the cached value, or a default-constructed Value on a miss
+    Value get(const std::string& key) {
+        size_t hash = std::hash<std::string>{}(key);
+        Shard& shard = shards_[hash & shard_mask_];
+        if (admission_) shard.sketch.increment(hash);
+        auto now = std::chrono::steady_clock::now();
+
+        if (policy_ == EvictionPolicy::Clock) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            auto it = shard.map.find(key);
+            if (it == shard.map.end() || expired(it->second, now)) {
+                shard.misses.fetch_add(1, std::memory_order_relaxed);
+                return {};  // Expired entries are reclaimed by put()
+            }
+            it->second.referenced.store(true, std::memory_order_relaxed);
+            shard.hits.fetch_add(1, std::memory_order_relaxed);
+            return it->second.value;
+        }
+
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it == shard.map.end()) {
+            shard.misses.fetch_add(1, std::memory_order_relaxed);
+            return {};
+        }
+        if (expired(it->second, now)) {
+            shard.erase(&*it);
+            shard.misses.fetch_add(1, std::memory_order_relaxed);
+            return {};
+        }
+        List& list = shard.list_of(&*it);
+        list.unlink(&*it);
+        list.push_front(&*it);
+        shard.hits.fetch_add(1, std::memory_order_relaxed);
+        return it->second.value;
+    }
+
+    void put(const std::string& key, Value value) {
+        size_t hash = std::hash<std::string>{}(key);
+        Shard& shard = shards_[hash & shard_mask_];
+        size_t weight = key.size() + (weigher_ ? weigher_(value) : sizeof(Value));
+        auto now = std::chrono::steady_clock::now();
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+        auto it = shard.map.find(key);
+        if (byte_capacity_ && weight > byte_capacity_) {
+            if (it != shard.map.end()) shard.erase(&*it);
+            ++shard.rejections;
+            return;
+        }
+
+        // Room is made before linking the entry, so eviction never picks it.
+        // Window entries are bounded by the window size instead.
+        Node* node;
+        if (it != shard.map.end()) {
+            node = &*it;
+            shard.list_of(node).unlink(node);
+            node->second.value = std::move(value);
+            node->second.timestamp = now;
+            node->second.weight = weight;
+            node->second.referenced.store(false, std::memory_order_relaxed);
+        } else {
+            node = &*shard.map.emplace(std::piecewise_construct, std::forward_as_tuple(key),
+                                       std::forward_as_tuple(std::move(value), now, weight)).first;
+            node->second.in_window = admission_;
+        }
+        if (!node->second.in_window) make_room(shard, weight, now);
+        shard.list_of(node).push_front(node);
+
+        // W-TinyLFU: entries leaving the window compete with the main
+        // list's victim and the less frequently used one is dropped
+        while (admission_ && shard.window.tail && window_full(shard)) {
+            Node* candidate = shard.window.tail;
+            shard.window.unlink(candidate);
+            candidate->second.in_window = false;
+            admit(shard, candidate, now);
+        }
+    }
+
+    // Drop one entry; returns whether it was present
+    bool erase(const std::string& key) {
+        size_t hash = std::hash<std::string>{}(key);
+        Shard& shard = shards_[hash & shard_mask_];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it == shard.map.end()) return false;
+        shard.erase(&*it);
+        return true;
+    }
+
+    void clear() {
+        for (size_t i = 0; i < shard_count_; ++i) {
+            std::unique_lock<std::shared_mutex> lock(shards_[i].mutex);
+            shards_[i].map.clear();
+            shards_[i].window = List();
+            shards_[i].main = List();
+        }
+    }
+
+    size_t size() const {
+        size_t total = 0;
+        for (size_t i = 0; i < shard_count_; ++i) {
+            std::shared_lock<std::shared_mutex> lock(shards_[i].mutex);
+            total += shards_[i].map.size();
+        }
+        return total;
+    }
+
+    CacheStats stats() const {
+        CacheStats stats;
+        for (size_t i = 0; i < shard_count_; ++i) {
+            const Shard& shard = shards_[i];
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            stats.hits += shard.hits.load(std::memory_order_relaxed);
+            stats.misses += shard.misses.load(std::memory_order_relaxed);
+            stats.evictions += shard.evictions;
+            stats.rejections += shard.rejections;
+            stats.entries += shard.map.size();
+            stats.bytes += shard.window.bytes + shard.main.bytes;
+        }
+        return stats;
+    }
+
+    size_t shard_count() const { return shard_count_; }
+    EvictionPolicy policy() const { return policy_; }
+
+private:
+    struct Entry;
+    using Map = std::unordered_map<std::string, Entry>;
+    using Node = typename Map::value_type;  // Address is stable until erased
+
+    struct Entry {
+        Entry(Value v, std::chrono::steady_clock::time_point t, size_t w)
+            : value(std::move(v)), timestamp(t), weight(w) {}
+
+        Value value;
+        std::chrono::steady_clock::time_point timestamp;
+        size_t weight;
+        std::atomic<bool> referenced{false};  // CLOCK bit, set by readers
+        bool in_window = false;               // On the admission window rather than the main list
+        Node* prev = nullptr;  // Towards the most recent entry
+        Node* next = nullptr;  // Towards the eviction end
+    };
+
+    struct List {
+        Node* head = nullptr;  // Most recently inserted/used
+        Node* tail = nullptr;  // Next eviction candidate
+        size_t count = 0;
+        size_t bytes = 0;
+
+        void push_front(Node* node) {
+            node->second.prev = nullptr;
+            node->second.next = head;
+            if (head) head->second.prev = node;
+            head = node;
+            if (!tail) tail = node;
+            ++count;
+            bytes += node->second.weight;
+        }
+
+        void unlink(Node* node) {
+            Entry& entry = node->second;
+            if (entry.prev) entry.prev->second.next = entry.next; else head = entry.next;
+            if (entry.next) entry.next->second.prev = entry.prev; else tail = entry.prev;
+            entry.prev = entry.next = nullptr;
+            --count;
+            bytes -= entry.weight;
+        }
+    };
+
+    // Count-min sketch of access frequencies: four rows of saturating 4-bit
+    // counts (one byte each), halved every 10 * width increments so old
+    // popularity fades. Updated without the shard lock, so counts are
+    // approximate under concurrency, which is all admission needs.
+    struct Sketch {
+        static constexpr size_t DEPTH = 4;
+        std::unique_ptr<std::atomic<uint8_t>[]> counters;
+        size_t mask = 0;
+        size_t sample_limit = 0;
+        std::atomic<size_t> samples{0};
+
+        void init(size_t width) {
+            counters = std::make_unique<std::atomic<uint8_t>[]>(width * DEPTH);
+            for (size_t i = 0; i < width * DEPTH; ++i) counters[i].store(0, std::memory_order_relaxed);
+            mask = width - 1;
+            sample_limit = width * 10;
+        }
+
+        size_t index(size_t hash, size_t row) const {
+            uint64_t x = static_cast<uint64_t>(hash) + 0x9e3779b97f4a7c15ULL * (row + 1);
+            x ^= x >> 33;
+            x *= 0xff51afd7ed558ccdULL;
+            x ^= x >> 33;
+            return row * (mask + 1) + (static_cast<size_t>(x) & mask);
+        }
+
+        void increment(size_t hash) {
+            for (size_t row = 0; row < DEPTH; ++row) {
+                std::atomic<uint8_t>& counter = counters[index(hash, row)];
+                uint8_t count = counter.load(std::memory_order_relaxed);
+                if (count < 15) counter.store(static_cast<uint8_t>(count + 1), std::memory_order_relaxed);
+            }
+            if (samples.fetch_add(1, std::memory_order_relaxed) + 1 >= sample_limit) {
+                samples.store(0, std::memory_order_relaxed);
+                for (size_t i = 0; i < (mask + 1) * DEPTH; ++i) {
+                    counters[i].store(counters[i].load(std::memory_order_relaxed) / 2, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        uint8_t frequency(size_t hash) const {
+            uint8_t lowest = 15;
+            for (size_t row = 0; row < DEPTH; ++row) {
+                uint8_t count = counters[index(hash, row)].load(std::memory_order_relaxed);
+                if (count < lowest) lowest = count;
+            }
+            return lowest;
+        }
+    };
+
+    // Aligned so neighbouring shards' locks don't share a cache line
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        Map map;
+        List window;  // Admission window (W-TinyLFU only)
+        List main;
+        Sketch sketch;
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+        uint64_t evictions = 0;
+        uint64_t rejections = 0;
+
+        List& list_of(Node* node) {
+            return node->second.in_window ? window : main;
+        }
+
+        void erase(Node* node) {
+            list_of(node).unlink(node);
+            map.erase(map.find(node->first));
+        }
+    };
+
+    bool expired(const Entry& entry, std::chrono::steady_clock::time_point now) const {
+        return ttl_.count() > 0 && now - entry.timestamp >= ttl_;
+    }
+
+    // Whether one more entry of `weight` bytes fits in the shard
+    bool has_room(const Shard& shard, size_t weight) const {
+        return (!entry_capacity_ || shard.window.count + shard.main.count < entry_capacity_) &&
+               (!byte_capacity_ || shard.window.bytes + shard.main.bytes + weight <= byte_capacity_);
+    }
+
+    // Under admission the main list gets what the window does not use
+    bool main_has_room(const Shard& shard, size_t weight) const {
+        return (!entry_capacity_ || shard.main.count < entry_capacity_ - window_entries_) &&
+               (!byte_capacity_ || shard.main.bytes + weight <= byte_capacity_ - window_bytes_);
+    }
+
+    bool window_full(const Shard& shard) const {
+        return (entry_capacity_ && shard.window.count > window_entries_) ||
+               (byte_capacity_ && shard.window.bytes > window_bytes_);
+    }
+
+    // Next entry to evict from the main list. Under CLOCK, referenced
+    // entries get a second chance: their bit is cleared and they move back
+    // to the head.
+    Node* select_victim(Shard& shard, std::chrono::steady_clock::time_point now) {
+        Node* victim = shard.main.tail;
+        if (policy_ == EvictionPolicy::Clock) {
+            // Bounded: after one full lap every bit is clear
+            for (size_t i = 0; i < shard.main.count && victim; ++i) {
+                Entry& entry = victim->second;
+                if (expired(entry, now) || !entry.referenced.exchange(false, std::memory_order_relaxed)) {
+                    break;
+                }
+                shard.main.unlink(victim);
+                shard.main.push_front(victim);
+                victim = shard.main.tail;
+            }
+        }
+        return victim;
+    }
+
+    void make_room(Shard& shard, size_t weight, std::chrono::steady_clock::time_point now) {
+        while (!has_room(shard, weight)) {
+            Node* victim = shard.main.tail ? select_victim(shard, now) : shard.window.tail;
+            if (!victim) break;
+            shard.erase(victim);
+            ++shard.evictions;
+        }
+    }
+
+    // Move a candidate that left the window into the main list if it is
+    // used more often than every entry that has to go to make room for it
+    void admit(Shard& shard, Node* candidate, std::chrono::steady_clock::time_point now) {
+        size_t candidate_hash = std::hash<std::string>{}(candidate->first);
+        while (!main_has_room(shard, candidate->second.weight)) {
+            Node* victim = shard.main.tail ? select_victim(shard, now) : nullptr;
+            if (!victim || (!expired(victim->second, now) &&
+                            shard.sketch.frequency(candidate_hash) <=
+                                shard.sketch.frequency(std::hash<std::string>{}(victim->first)))) {
+                shard.map.erase(shard.map.find(candidate->first));
+                ++shard.rejections;
+                return;
+            }
+            shard.erase(victim);
+            ++shard.evictions;
+        }
+        shard.main.push_front(candidate);
+    }
+
+    std::chrono::steady_clock::duration ttl_;
+    EvictionPolicy policy_;
+    bool admission_;
+    Weigher weigher_;
+    size_t shard_count_;
+    size_t shard_mask_;
+    size_t entry_capacity_;  // Per shard, 0 = unlimited
+    size_t byte_capacity_;   // Per shard, 0 = unlimited
+    size_t window_entries_;
+    size_t window_bytes_;
+    std::unique_ptr<Shard[]> shards_;
+};
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef SIMD_SCAN_HPP
+#define SIMD_SCAN_HPP
+
+// Vectorized byte scanning for request framing (in the spirit of
+// picohttpparser). Each function returns a pointer to the first matching
+// byte in [begin, end), or `end` if there is none.
+//
+// The implementation is picked once at startup: AVX2 (32 bytes per step)
+// when the CPU supports it, SSE2 (16 bytes) on other x86-64 CPUs, and a
+// table-driven scalar loop elsewhere or when built with TEZ_DISABLE_SIMD.
+
+// First occurrence of c
+const char* scan_for_byte(const char* begin, const char* end, char c);
+
+// First byte that is not an RFC 9110 tchar (methods, header names).
+// For "Name: value" this stops at the colon.
+const char* scan_non_token(const char* begin, const char* end);
+
+// First byte not allowed in a request target (controls, SP, DEL)
+const char* scan_non_target(const char* begin, const char* end);
+
+// First byte not allowed in a field value (controls other than HTAB, DEL)
+const char* scan_non_field_value(const char* begin, const char* end);
+
+// Name of the selected implementation: "avx2", "sse2" or "scalar"
+const char* scan_isa_name();
+
+#endif
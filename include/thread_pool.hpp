@@ -1,53 +1,137 @@
 #ifndef THREAD_POOL_HPP
 #define THREAD_POOL_HPP
 
-#include <vector>
-#include <queue>
-#include <thread>
-#include <mutex>
+#include <atomic>
 #include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
 #include <functional>
 #include <future>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// A type-erased, fire-and-forget task that fits in one cache line. Small
+// trivially copyable callables (lambdas capturing pointers, references and
+// integers) are stored inline; anything else is moved to the heap and the
+// inline storage holds the pointer. Either way the task itself is plain
+// bytes, so the work-stealing deques can copy it without locks.
+class Task {
+public:
+    static constexpr size_t INLINE_SIZE = 56;
+
+    Task() = default;
+
+    template<class F>
+    static Task make(F&& f) {
+        using Fn = std::decay_t<F>;
+        Task task;
+        if constexpr (sizeof(Fn) <= INLINE_SIZE && alignof(Fn) <= alignof(std::uint64_t) &&
+                      std::is_trivially_copyable_v<Fn>) {
+            ::new (static_cast<void*>(task.storage_)) Fn(std::forward<F>(f));
+            task.invoke_ = [](unsigned char* storage, bool run) {
+                if (run) (*std::launder(reinterpret_cast<Fn*>(storage)))();
+            };
+        } else {
+            Fn* heap = new Fn(std::forward<F>(f));
+            std::memcpy(task.storage_, &heap, sizeof(heap));
+            task.invoke_ = [](unsigned char* storage, bool run) {
+                Fn* heap;
+                std::memcpy(&heap, storage, sizeof(heap));
+                std::unique_ptr<Fn> owner(heap);
+                if (run) (*heap)();
+            };
+        }
+        return task;
+    }
+
+    explicit operator bool() const { return invoke_ != nullptr; }
+
+    // Exactly one of run() and discard() must be called on a made task
+    void run() { invoke_(storage_, true); }
+    void discard() { invoke_(storage_, false); }
+
+private:
+    void (*invoke_)(unsigned char*, bool) = nullptr;
+    alignas(std::uint64_t) unsigned char storage_[INLINE_SIZE];
+};
 
+static_assert(sizeof(Task) == 64, "Task should fill exactly one cache line");
+static_assert(std::is_trivially_copyable_v<Task>, "Task is copied as raw words");
+
+// Work-stealing thread pool. Each worker owns a Chase-Lev deque: tasks
+// posted from a worker go to the bottom of its own deque (no locks, taken
+// LIFO while still hot in cache), and idle workers steal from the top of
+// other workers' deques. Tasks posted from outside the pool go through a
+// small shared injection queue. A worker with nothing to do spins briefly,
+// then parks on a condition variable until new work is posted.
 class ThreadPool {
 public:
-    ThreadPool(size_t num_threads);
+    explicit ThreadPool(size_t num_threads);
     ~ThreadPool();
 
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Fire-and-forget: no future, and no allocation for small callables.
+    // A task that throws has its exception reported and discarded. Throws
+    // std::runtime_error once the pool is shutting down.
+    template<class F>
+    void post(F&& f) {
+        submit(Task::make(std::forward<F>(f)));
+    }
+
+    // Like post(), but returns a future for the result
     template<class F, class... Args>
     auto enqueue(F&& f, Args&&... args) -> std::future<typename std::invoke_result<F, Args...>::type>;
 
+    // Runs every task already posted, then joins the workers
     void shutdown();
 
+    size_t size() const { return workers_.size(); }
+    // Tasks posted and not yet started; a snapshot that may be stale by the
+    // time it returns, meant for monitoring
+    size_t queued() const;
+    // Workers parked for lack of work
+    size_t idle() const { return sleepers_.load(std::memory_order_relaxed); }
+
 private:
-    std::vector<std::thread> workers;
-    std::queue<std::function<void()>> tasks;
+    struct Worker;
+
+    void submit(Task task);
+    void worker_loop(size_t index);
+    bool find_task(size_t index, Task& task);
+    bool has_work() const;
+    bool park();
+    void wake_one();
 
-    std::mutex queue_mutex;
-    std::condition_variable condition;
-    bool stop;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+
+    // Tasks posted from threads outside the pool
+    std::mutex inject_mutex_;
+    std::deque<Task> injected_;
+    std::atomic<size_t> injected_count_{0};
+
+    std::mutex park_mutex_;
+    std::condition_variable park_cv_;
+    std::atomic<unsigned> sleepers_{0};
+    std::atomic<bool> stop_{false};
+    unsigned spin_rounds_;
 };
 
-// Template implementation must be in header
 template<class F, class... Args>
 auto ThreadPool::enqueue(F&& f, Args&&... args) -> std::future<typename std::invoke_result<F, Args...>::type> {
     using return_type = typename std::invoke_result<F, Args...>::type;
 
-    auto task = std::make_shared<std::packaged_task<return_type()>>(
-        std::bind(std::forward<F>(f), std::forward<Args>(args)...)
-    );
-
-    std::future<return_type> res = task->get_future();
-    {
-        std::unique_lock<std::mutex> lock(queue_mutex);
-
-        if (stop) {
-            throw std::runtime_error("enqueue on stopped ThreadPool");
-        }
-
-        tasks.emplace([task](){ (*task)(); });
-    }
-    condition.notify_one();
+    std::packaged_task<return_type()> task(std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+    std::future<return_type> res = task.get_future();
+    post([task = std::move(task)]() mutable { task(); });
     return res;
 }
 
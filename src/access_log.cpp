@@ -0,0 +1,386 @@
+#include "access_log.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+constexpr size_t WRITE_BUFFER_SIZE = 64 * 1024;  // Bytes formatted before each write()
+
+// Fixed size so a push is a plain copy; longer fields are truncated
+struct AccessRecord {
+    std::int64_t timestamp;
+    std::uint64_t bytes;
+    std::uint32_t latency_us;
+    std::int16_t status;
+    std::uint8_t ip_length;
+    std::uint8_t method_length;
+    std::uint16_t path_length;
+    char ip[46];       // INET6_ADDRSTRLEN
+    char method[16];
+    char path[256];
+};
+
+void copy_field(char* dest, size_t capacity, std::string_view value, size_t& length) {
+    length = std::min(value.size(), capacity);
+    std::memcpy(dest, value.data(), length);
+}
+
+// Single-producer (the owning worker thread), single-consumer (the writer)
+class LogRing {
+public:
+    explicit LogRing(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size *= 2;
+        slots_ = std::make_unique<AccessRecord[]>(size);
+        mask_ = size - 1;
+    }
+
+    enum class Push { Ok, HalfFull, Dropped };
+
+    // HalfFull is returned once as the ring fills past half, so the
+    // producer can wake the writer before records are lost
+    Push push(const AccessRecord& record) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t used = head - tail_.load(std::memory_order_acquire);
+        if (used > mask_) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return Push::Dropped;
+        }
+        slots_[head & mask_] = record;
+        head_.store(head + 1, std::memory_order_release);
+        return used == (mask_ + 1) / 2 ? Push::HalfFull : Push::Ok;
+    }
+
+    template<typename Fn>
+    size_t drain(Fn&& fn) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t head = head_.load(std::memory_order_acquire);
+        for (size_t i = tail; i != head; ++i) {
+            fn(slots_[i & mask_]);
+        }
+        tail_.store(head, std::memory_order_release);
+        return head - tail;
+    }
+
+    std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    std::unique_ptr<AccessRecord[]> slots_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> head_{0};  // Written by the producer
+    alignas(64) std::atomic<size_t> tail_{0};  // Written by the consumer
+    std::atomic<std::uint64_t> dropped_{0};
+};
+
+void append_json_string(std::string& out, const char* data, size_t length) {
+    out += '"';
+    for (size_t i = 0; i < length; ++i) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    out += '"';
+}
+
+void format_record(std::string& out, const AccessRecord& record, bool json) {
+    if (json) {
+        out += "{\"ts\":";
+        out += std::to_string(record.timestamp);
+        out += ",\"ip\":";
+        append_json_string(out, record.ip, record.ip_length);
+        out += ",\"method\":";
+        append_json_string(out, record.method, record.method_length);
+        out += ",\"path\":";
+        append_json_string(out, record.path, record.path_length);
+        out += ",\"status\":";
+        out += std::to_string(record.status);
+        out += ",\"bytes\":";
+        out += std::to_string(record.bytes);
+        out += ",\"latency_us\":";
+        out += std::to_string(record.latency_us);
+        out += "}\n";
+        return;
+    }
+
+    out += '[';
+    out += std::to_string(record.timestamp);
+    out += "] ";
+    out.append(record.ip, record.ip_length);
+    out += " - ";
+    out.append(record.method, record.method_length);
+    out += ' ';
+    out.append(record.path, record.path_length);
+    if (record.status) {
+        out += ' ';
+        out += std::to_string(record.status);
+        out += ' ';
+        out += std::to_string(record.bytes);
+        out += ' ';
+        out += std::to_string(record.latency_us);
+        out += "us";
+    }
+    out += '\n';
+}
+
+class AccessLogger {
+public:
+    explicit AccessLogger(const AccessLogConfig& config) : config_(config) {
+        buffer_.reserve(WRITE_BUFFER_SIZE + 1024);
+        open_file();
+        thread_ = std::thread([this]() { run(); });
+    }
+
+    ~AccessLogger() {
+        shutdown();
+    }
+
+    // Final drain, then join the writer. Records pushed afterwards are lost.
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) return;
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+    }
+
+    // Drain before the next interval (a ring is filling up)
+    void request_drain() {
+        drain_requested_.store(true, std::memory_order_relaxed);
+        wake_.notify_one();
+    }
+
+    std::shared_ptr<LogRing> add_ring() {
+        auto ring = std::make_shared<LogRing>(config_.ring_records);
+        std::lock_guard<std::mutex> lock(mutex_);
+        rings_.push_back(ring);
+        return ring;
+    }
+
+    AccessLogStats stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        AccessLogStats stats;
+        stats.written = written_.load(std::memory_order_relaxed);
+        stats.rotations = rotations_.load(std::memory_order_relaxed);
+        for (const auto& ring : rings_) stats.dropped += ring->dropped();
+        return stats;
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait_for(lock, std::chrono::milliseconds(config_.flush_interval_ms),
+                           [this]() { return stopping_ || drain_requested_.load(std::memory_order_relaxed); });
+            drain_requested_.store(false, std::memory_order_relaxed);
+            bool stopping = stopping_;
+            std::vector<std::shared_ptr<LogRing>> rings = rings_;
+            lock.unlock();
+
+            drain(rings);
+
+            lock.lock();
+            if (stopping) break;
+        }
+    }
+
+    void drain(const std::vector<std::shared_ptr<LogRing>>& rings) {
+        std::uint64_t count = 0;
+        for (const auto& ring : rings) {
+            count += ring->drain([this](const AccessRecord& record) {
+                format_record(buffer_, record, config_.json);
+                if (buffer_.size() >= WRITE_BUFFER_SIZE) flush();
+            });
+        }
+        flush();
+        written_.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    void open_file() {
+        fd_ = ::open(config_.path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            std::cerr << "Cannot open access log " << config_.path << ": " << std::strerror(errno) << "\n";
+            file_bytes_ = 0;
+            return;
+        }
+        struct stat st;
+        file_bytes_ = ::fstat(fd_, &st) == 0 ? static_cast<std::uint64_t>(st.st_size) : 0;
+    }
+
+    // path -> path.1 -> path.2 ... ; the oldest file falls off the end
+    void rotate() {
+        if (fd_ >= 0) ::close(fd_);
+        if (config_.max_files == 0) {
+            ::unlink(config_.path.c_str());
+        } else {
+            for (unsigned i = config_.max_files; i > 1; --i) {
+                std::string from = config_.path + "." + std::to_string(i - 1);
+                std::string to = config_.path + "." + std::to_string(i);
+                std::rename(from.c_str(), to.c_str());
+            }
+            std::rename(config_.path.c_str(), (config_.path + ".1").c_str());
+        }
+        rotations_.fetch_add(1, std::memory_order_relaxed);
+        open_file();
+    }
+
+    void flush() {
+        if (buffer_.empty()) return;
+        if (config_.max_bytes && file_bytes_ > 0 && file_bytes_ + buffer_.size() > config_.max_bytes) {
+            rotate();
+        }
+        if (fd_ >= 0) {
+            const char* data = buffer_.data();
+            size_t remaining = buffer_.size();
+            while (remaining > 0) {
+                ssize_t n = ::write(fd_, data, remaining);
+                if (n < 0) {
+                    if (errno == EINTR) continue;
+                    break;
+                }
+                data += n;
+                remaining -= static_cast<size_t>(n);
+            }
+            file_bytes_ += buffer_.size() - remaining;
+        }
+        buffer_.clear();
+    }
+
+    AccessLogConfig config_;
+    std::mutex mutex_;  // Guards rings_ and stopping_
+    std::condition_variable wake_;
+    std::vector<std::shared_ptr<LogRing>> rings_;
+    bool stopping_ = false;
+    std::thread thread_;
+
+    // Writer thread only
+    std::string buffer_;
+    int fd_ = -1;
+    std::uint64_t file_bytes_ = 0;
+
+    std::atomic<bool> drain_requested_{false};
+    std::atomic<std::uint64_t> written_{0};
+    std::atomic<std::uint64_t> rotations_{0};
+};
+
+// The running logger, if any. Workers hold a shared_ptr to the logger their
+// ring belongs to, so a restart hands them a new ring on their next call.
+std::mutex g_logger_mutex;
+std::shared_ptr<AccessLogger> g_logger;
+std::atomic<AccessLogger*> g_active{nullptr};
+std::atomic<bool> g_disabled{false};
+AccessLogStats g_last_stats;  // Of the most recently stopped logger
+std::mutex g_sync_mutex;  // Serializes the synchronous fallback
+
+struct ThreadRing {
+    std::shared_ptr<AccessLogger> logger;
+    std::shared_ptr<LogRing> ring;
+};
+
+AccessRecord make_record(std::string_view client_ip, std::string_view method, std::string_view path,
+                         int status, std::uint64_t bytes, std::uint32_t latency_us) {
+    AccessRecord record;
+    record.timestamp = static_cast<std::int64_t>(std::time(nullptr));
+    record.bytes = bytes;
+    record.latency_us = latency_us;
+    record.status = static_cast<std::int16_t>(status);
+    size_t length;
+    copy_field(record.ip, sizeof(record.ip), client_ip, length);
+    record.ip_length = static_cast<std::uint8_t>(length);
+    copy_field(record.method, sizeof(record.method), method, length);
+    record.method_length = static_cast<std::uint8_t>(length);
+    copy_field(record.path, sizeof(record.path), path, length);
+    record.path_length = static_cast<std::uint16_t>(length);
+    return record;
+}
+
+}  // namespace
+
+void log_access(std::string_view client_ip, std::string_view method, std::string_view path,
+                int status, std::uint64_t bytes, std::uint32_t latency_us) {
+    if (g_disabled.load(std::memory_order_relaxed)) return;
+    AccessRecord record = make_record(client_ip, method, path, status, bytes, latency_us);
+
+    AccessLogger* active = g_active.load(std::memory_order_acquire);
+    if (active) {
+        thread_local ThreadRing t_ring;
+        if (t_ring.logger.get() != active) {
+            std::lock_guard<std::mutex> lock(g_logger_mutex);
+            if (g_logger) {
+                t_ring.logger = g_logger;
+                t_ring.ring = g_logger->add_ring();
+            }
+        }
+        if (t_ring.logger.get() == active) {
+            if (t_ring.ring->push(record) == LogRing::Push::HalfFull) {
+                active->request_drain();
+            }
+            return;
+        }
+    }
+
+    // Not started: append this line directly
+    std::string line;
+    format_record(line, record, false);
+    std::lock_guard<std::mutex> lock(g_sync_mutex);
+    int fd = ::open("server.log", O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd >= 0) {
+        ssize_t ignored = ::write(fd, line.data(), line.size());
+        (void)ignored;
+        ::close(fd);
+    }
+}
+
+void start_access_log(const AccessLogConfig& config) {
+    stop_access_log();
+    if (!config.enabled) {
+        g_disabled.store(true, std::memory_order_relaxed);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(g_logger_mutex);
+    g_logger = std::make_shared<AccessLogger>(config);
+    g_active.store(g_logger.get(), std::memory_order_release);
+}
+
+void stop_access_log() {
+    std::lock_guard<std::mutex> lock(g_logger_mutex);
+    g_disabled.store(false, std::memory_order_relaxed);
+    g_active.store(nullptr, std::memory_order_release);
+    if (!g_logger) return;
+
+    // Workers may still hold the logger, but its writer stops here after
+    // draining everything pushed so far
+    g_logger->shutdown();
+    g_last_stats = g_logger->stats();
+    g_logger.reset();
+}
+
+AccessLogStats access_log_stats() {
+    std::lock_guard<std::mutex> lock(g_logger_mutex);
+    return g_logger ? g_logger->stats() : g_last_stats;
+}
@@ -0,0 +1,106 @@
+#include "compression.hpp"
+#include <zlib.h>
+#include <cstdint>
+#include "http_parser.hpp"
+
+namespace {
+
+constexpr int MAX_QUALITY = 1000;  // q=1, in thousandths
+
+// A qvalue in thousandths (RFC 9110 12.4.2: "0" or "1", then optionally
+// "." and up to three digits, never above 1), or -1 when malformed. Parsed
+// by hand: strtod follows the locale and takes "5", "inf" or hex floats.
+int parse_qvalue(std::string_view text) {
+    if (text.empty() || (text[0] != '0' && text[0] != '1')) return -1;
+    int value = (text[0] - '0') * MAX_QUALITY;
+    if (text.size() == 1) return value;
+    if (text[1] != '.' || text.size() > 5) return -1;
+    int scale = MAX_QUALITY / 10;
+    for (char c : text.substr(2)) {
+        if (c < '0' || c > '9') return -1;
+        value += (c - '0') * scale;
+        scale /= 10;
+    }
+    return value > MAX_QUALITY ? -1 : value;
+}
+
+// Quality of one Accept-Encoding element's parameters (";q=0.5"), in
+// thousandths; 1 if absent. A malformed qvalue makes the coding
+// unacceptable (0).
+int parse_quality(std::string_view params) {
+    while (!params.empty()) {
+        size_t semicolon = params.find(';');
+        std::string_view param = trim(params.substr(0, semicolon));
+        params = semicolon == std::string_view::npos ? std::string_view() : params.substr(semicolon + 1);
+        if (param.size() >= 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=') {
+            int quality = parse_qvalue(param.substr(2));
+            return quality < 0 ? 0 : quality;
+        }
+    }
+    return MAX_QUALITY;
+}
+
+}  // namespace
+
+std::string_view coding_name(ContentCoding coding) {
+    switch (coding) {
+        case ContentCoding::Gzip: return "gzip";
+        case ContentCoding::Deflate: return "deflate";
+        case ContentCoding::Identity: break;
+    }
+    return "";
+}
+
+ContentCoding negotiate_coding(std::string_view accept_encoding) {
+    int gzip = -1, deflate = -1, any = -1;
+    while (!accept_encoding.empty()) {
+        size_t comma = accept_encoding.find(',');
+        std::string_view element = accept_encoding.substr(0, comma);
+        accept_encoding = comma == std::string_view::npos ? std::string_view() : accept_encoding.substr(comma + 1);
+
+        size_t semicolon = element.find(';');
+        std::string_view name = trim(element.substr(0, semicolon));
+        int quality = semicolon == std::string_view::npos ? MAX_QUALITY : parse_quality(element.substr(semicolon + 1));
+        if (iequals(name, "gzip") || iequals(name, "x-gzip")) gzip = quality;
+        else if (iequals(name, "deflate")) deflate = quality;
+        else if (name == "*") any = quality;
+    }
+    // Codings not listed fall back to "*"
+    if (gzip < 0) gzip = any;
+    if (deflate < 0) deflate = any;
+
+    if (gzip > 0 && gzip >= deflate) return ContentCoding::Gzip;
+    if (deflate > 0) return ContentCoding::Deflate;
+    return ContentCoding::Identity;
+}
+
+bool is_compressible(std::string_view content_type) {
+    std::string_view type = trim(content_type.substr(0, content_type.find(';')));
+    return type.substr(0, 5) == "text/" ||
+           type == "application/javascript" ||
+           type == "application/json" ||
+           type == "application/xml" ||
+           type == "image/svg+xml";
+}
+
+bool compress_body(std::string_view input, ContentCoding coding, int level, std::string& out) {
+    if (coding == ContentCoding::Identity || input.size() > UINT32_MAX) return false;
+
+    z_stream stream{};
+    // windowBits 15 is the zlib wrapper; +16 asks for a gzip header instead
+    int window_bits = coding == ContentCoding::Gzip ? 15 + 16 : 15;
+    if (deflateInit2(&stream, level, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+
+    out.resize(deflateBound(&stream, static_cast<uLong>(input.size())) + 32);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream.avail_in = static_cast<uInt>(input.size());
+    stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = static_cast<uInt>(out.size());
+
+    int result = deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return result == Z_STREAM_END;
+}
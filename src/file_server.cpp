@@ -4,10 +4,44 @@
 #include <filesystem>
 #include <unordered_map>
 #include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <sys/stat.h>
+#include "file_watcher.hpp"
+#include "metrics.hpp"
 #include "middleware.hpp"
 
 namespace fs = std::filesystem;
 
+// Set once at startup, before any request is served
+static std::uint64_t g_sendfile_threshold = DEFAULT_SENDFILE_THRESHOLD;
+
+static CompressionOptions g_compression;
+static std::unordered_map<std::string, std::string> g_cache_control;
+
+// Bumped before every invalidation. A load that saw the counter move while
+// it was reading the file may hold stale bytes, so it isn't cached.
+static std::atomic<std::uint64_t> g_invalidations{0};
+static std::atomic<bool> g_watching{false};
+static FileWatcher g_watcher;
+
+void set_sendfile_threshold(std::uint64_t bytes) {
+    g_sendfile_threshold = bytes;
+}
+
+void set_compression_options(const CompressionOptions& options) {
+    g_compression = options;
+}
+
+void set_cache_control_policies(const std::unordered_map<std::string, std::string>& policies) {
+    g_cache_control.clear();
+    for (const auto& [extension, policy] : policies) {
+        std::string key = extension;
+        std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+        g_cache_control[key] = policy;
+    }
+}
+
 // MIME type map for efficient lookup
 static const std::unordered_map<std::string, std::string> MIME_TYPES = {
     // Text formats
@@ -111,12 +145,61 @@ std::string get_mime_type(const std::string& path) {
     return "application/octet-stream";  // Default for unknown types
 }
 
-Response serve_file(const std::string& path) {
-    Response cached = get_cached_file(path);
-    if (!cached.body.empty()) {
-        return cached;
+static std::uint64_t mtime_ns(const struct stat& info) {
+#ifdef __linux__
+    return static_cast<std::uint64_t>(info.st_mtim.tv_sec) * 1000000000u + static_cast<std::uint64_t>(info.st_mtim.tv_nsec);
+#else
+    return static_cast<std::uint64_t>(info.st_mtime) * 1000000000u;
+#endif
+}
+
+// Strong validator from the file's modification time and size; suffix
+// tells compressed variants apart
+static std::string make_etag(const struct stat& info, std::string_view suffix) {
+    char tag[64];
+    int n = std::snprintf(tag, sizeof(tag), "\"%llx-%llx", static_cast<unsigned long long>(mtime_ns(info)),
+                          static_cast<unsigned long long>(info.st_size));
+    std::string etag(tag, static_cast<size_t>(n));
+    etag.append(suffix);
+    etag += '"';
+    return etag;
+}
+
+// Cache-Control for a path: its extension's policy, else the "*" policy
+static std::string cache_control_for(const std::string& path) {
+    if (g_cache_control.empty()) return "";
+    size_t dot_pos = path.find_last_of('.');
+    if (dot_pos != std::string::npos && path.find('/', dot_pos) == std::string::npos) {
+        std::string extension = path.substr(dot_pos);
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        auto it = g_cache_control.find(extension);
+        if (it != g_cache_control.end()) return it->second;
     }
+    auto it = g_cache_control.find("*");
+    return it != g_cache_control.end() ? it->second : "";
+}
+
+static void set_validators(Response& resp, const struct stat& info, const std::string& path) {
+    resp.etag = make_etag(info, "");
+    resp.last_modified = info.st_mtime;
+    resp.cache_control = cache_control_for(path);
+    resp.accept_ranges = true;
+}
+
+// Cache a response built after the counter read epoch, unless a file
+// changed meanwhile. Checked again after the put: an invalidation that
+// erased the key just before the put would otherwise leave it stale.
+static void cache_if_current(const std::string& key, const ResponsePtr& response, std::uint64_t epoch) {
+    if (g_invalidations.load() != epoch) return;
+    cache_file(key, response);
+    if (g_invalidations.load() != epoch) erase_cached_file(key);
+}
 
+// Read (or stat, for large files) the identity representation and cache it;
+// cacheable is cleared for names the watcher can't invalidate
+static ResponsePtr load_file(const std::string& path, bool& cacheable) {
+    std::uint64_t epoch = g_invalidations.load();
+    cacheable = true;
     Response resp;
     resp.status = "200 OK";
     resp.content_type = "text/plain; charset=utf-8";
@@ -131,12 +214,36 @@ Response serve_file(const std::string& path) {
             resp.body = "Access denied: Invalid file path.\r\n";
             resp.content_type = "text/plain; charset=utf-8";
         } else {
+            // The watcher reports canonical paths, so while it runs a file
+            // reached through a symlink or a non-canonical name ("a//b.css")
+            // would never be invalidated; serve it uncached instead
+            if (g_watching.load(std::memory_order_relaxed)) {
+                cacheable = file_path.size() > filename.size() &&
+                            file_path.compare(file_path.size() - filename.size(), filename.size(), filename) == 0 &&
+                            file_path[file_path.size() - filename.size() - 1] == '/';
+            }
+
+            // Large files are streamed from disk by the session; only the
+            // path and size are kept, and they bypass the file cache
+            struct stat info{};
+            bool found = ::stat(file_path.c_str(), &info) == 0 && S_ISREG(info.st_mode);
+            std::uint64_t file_size = found ? static_cast<std::uint64_t>(info.st_size) : 0;
+            if (found && g_sendfile_threshold > 0 && file_size >= g_sendfile_threshold) {
+                resp.content_type = get_mime_type(path);
+                resp.vary_accept_encoding = g_compression.enabled && is_compressible(resp.content_type);
+                resp.file = FileBody{file_path, 0, file_size, {}, {}};
+                set_validators(resp, info, path);
+                return make_response(std::move(resp));
+            }
+
             std::ifstream file(file_path, std::ios::binary);
-            if (file) {
+            if (found && file) {
                 std::string file_content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
                 resp.body = file_content;
                 // Set MIME type using efficient lookup
                 resp.content_type = get_mime_type(path);
+                resp.vary_accept_encoding = g_compression.enabled && is_compressible(resp.content_type);
+                set_validators(resp, info, path);
             } else {
                 resp.status = "404 Not Found";
                 resp.body = "File not found.\r\n";
@@ -147,6 +254,134 @@ Response serve_file(const std::string& path) {
         resp.status = "400 Bad Request";
         resp.body = "Not a static file request.\r\n";
     }
-    cache_file(path, resp);
-    return resp;
-}
\ No newline at end of file
+    auto shared = make_response(std::move(resp));
+    if (cacheable) cache_if_current(path, shared, epoch);
+    return shared;
+}
+
+// A precompressed "<file>.gz" next to the file, if it is at least as new
+static std::string gzip_sibling(const std::string& file_path, struct stat& sibling_info) {
+    std::string sibling = file_path + ".gz";
+    struct stat file_info{};
+    if (::stat(sibling.c_str(), &sibling_info) != 0 || !S_ISREG(sibling_info.st_mode) ||
+        ::stat(file_path.c_str(), &file_info) != 0 || mtime_ns(sibling_info) < mtime_ns(file_info)) {
+        return "";
+    }
+    return sibling;
+}
+
+// Build the compressed variant of an identity response: a *.gz sibling for
+// gzip if there is one, otherwise zlib over the cached body. Falls back to
+// the identity response when compression doesn't pay.
+static ResponsePtr load_variant(const std::string& path, const ResponsePtr& identity, ContentCoding coding) {
+    std::string sibling;
+    struct stat sibling_info{};
+    if (coding == ContentCoding::Gzip) {
+        std::string file_path = identity->file ? identity->file->path : sanitize_path(path.substr(8));
+        if (!file_path.empty()) sibling = gzip_sibling(file_path, sibling_info);
+    }
+
+    Response variant;
+    variant.status = identity->status;
+    variant.content_type = identity->content_type;
+    variant.vary_accept_encoding = true;
+    variant.content_encoding = std::string(coding_name(coding));
+    variant.last_modified = identity->last_modified;
+    variant.cache_control = identity->cache_control;
+    variant.accept_ranges = identity->accept_ranges;
+    std::string suffix = "-" + variant.content_encoding;
+    // Each representation needs its own strong tag
+    if (!sibling.empty()) {
+        variant.etag = make_etag(sibling_info, suffix);
+    } else if (!identity->etag.empty()) {
+        variant.etag = identity->etag.substr(0, identity->etag.size() - 1) + suffix + "\"";
+    }
+    if (identity->file) {
+        // Large files are never compressed on the fly
+        if (sibling.empty()) return identity;
+        variant.file = FileBody{sibling, 0, static_cast<std::uint64_t>(sibling_info.st_size), {}, {}};
+        return make_response(std::move(variant));
+    }
+
+    bool loaded = false;
+    if (!sibling.empty()) {
+        std::ifstream file(sibling, std::ios::binary);
+        if (file) {
+            variant.body.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            loaded = true;
+        }
+    }
+    if (!loaded) {
+        if (identity->body.size() < g_compression.min_bytes ||
+            !compress_body(identity->body, coding, g_compression.level, variant.body) ||
+            variant.body.size() >= identity->body.size()) {
+            return identity;
+        }
+    }
+    return make_response(std::move(variant));
+}
+
+ResponsePtr serve_file(const std::string& path, std::string_view accept_encoding) {
+    PhaseTimer timer(Phase::ServeFile);
+    ContentCoding coding = g_compression.enabled ? negotiate_coding(accept_encoding) : ContentCoding::Identity;
+
+    // Compressed variants are cached next to the identity one, under the
+    // coding name plus the path (paths always start with '/'). The key is
+    // built in a per-thread buffer so a cache hit doesn't allocate.
+    thread_local std::string variant_key;
+    if (coding != ContentCoding::Identity) {
+        variant_key.assign(coding_name(coding)).append(":").append(path);
+        if (ResponsePtr cached = get_cached_file(variant_key)) {
+            return cached;
+        }
+    }
+
+    std::uint64_t epoch = g_invalidations.load();
+    bool cacheable = true;
+    ResponsePtr identity = get_cached_file(path);
+    if (!identity) {
+        identity = load_file(path, cacheable);
+    }
+    if (coding == ContentCoding::Identity || !identity->vary_accept_encoding) {
+        return identity;
+    }
+
+    ResponsePtr variant = load_variant(path, identity, coding);
+    if (!variant->file && cacheable) {
+        cache_if_current(variant_key, variant, epoch);
+    }
+    return variant;
+}
+
+void invalidate_static_file(const std::string& relative_path) {
+    g_invalidations.fetch_add(1);
+    if (relative_path.empty()) {
+        clear_file_cache();
+        return;
+    }
+    std::string path = "/static/" + relative_path;
+    erase_cached_file(path);
+    erase_cached_file("gzip:" + path);
+    erase_cached_file("deflate:" + path);
+    // A precompressed sibling feeds the base file's gzip variant
+    if (path.size() > 3 && path.compare(path.size() - 3, 3, ".gz") == 0) {
+        erase_cached_file("gzip:" + path.substr(0, path.size() - 3));
+    }
+}
+
+bool start_static_watcher() {
+    std::error_code ec;
+    fs::path root = fs::weakly_canonical(fs::absolute("../static"), ec);
+    if (ec || !g_watcher.start(root.string(), invalidate_static_file)) {
+        return false;
+    }
+    // Entries cached before the watch began may already be stale
+    invalidate_static_file("");
+    g_watching = true;
+    return true;
+}
+
+void stop_static_watcher() {
+    g_watching = false;
+    g_watcher.stop();
+}
@@ -0,0 +1,182 @@
+#include "file_watcher.hpp"
+#include <filesystem>
+#include <iostream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#endif
+
+namespace fs = std::filesystem;
+
+#ifdef __linux__
+
+namespace {
+
+// Content writes, metadata changes (mtime feeds the ETag) and entries
+// appearing or disappearing
+constexpr uint32_t WATCH_MASK = IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_CREATE | IN_DELETE |
+                                IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+
+// Files whose new contents are complete, as an editor or deploy leaves them
+constexpr uint32_t COMPLETED_WRITES_MASK = IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+
+std::string join(const std::string& dir, const char* name) {
+    return dir.empty() ? std::string(name) : dir + "/" + name;
+}
+
+}  // namespace
+
+FileWatcher::~FileWatcher() {
+    stop();
+}
+
+bool FileWatcher::start(const std::string& root, Callback callback, WatchOptions options) {
+    stop();
+    std::error_code ec;
+    if (!fs::is_directory(root, ec)) {
+        return false;
+    }
+    inotify_fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (inotify_fd_ < 0 || wake_fd_ < 0) {
+        std::cerr << "Warning: inotify unavailable (" << std::strerror(errno) << ")\n";
+        stop();
+        return false;
+    }
+    root_ = root;
+    callback_ = std::move(callback);
+    options_ = options;
+    watch_tree("");
+    if (dirs_.empty()) {
+        stop();
+        return false;
+    }
+    thread_ = std::thread([this]() { run(); });
+    return true;
+}
+
+void FileWatcher::stop() {
+    if (thread_.joinable()) {
+        uint64_t one = 1;
+        ssize_t ignored = ::write(wake_fd_, &one, sizeof(one));
+        (void)ignored;
+        thread_.join();
+    }
+    if (inotify_fd_ >= 0) ::close(inotify_fd_);
+    if (wake_fd_ >= 0) ::close(wake_fd_);
+    inotify_fd_ = wake_fd_ = -1;
+    dirs_.clear();
+}
+
+// Watch a directory and, when recursive, everything below it. Directories
+// only; files are covered by their parent's watch.
+void FileWatcher::watch_tree(const std::string& relative_dir) {
+    std::string path = relative_dir.empty() ? root_ : root_ + "/" + relative_dir;
+    uint32_t mask = options_.completed_writes ? COMPLETED_WRITES_MASK : WATCH_MASK;
+    int wd = ::inotify_add_watch(inotify_fd_, path.c_str(), mask | IN_ONLYDIR);
+    if (wd < 0) {
+        if (errno == ENOSPC) {
+            std::cerr << "Warning: inotify watch limit reached; " << path << " falls back to the cache TTL\n";
+        }
+        return;
+    }
+    dirs_[wd] = relative_dir;
+    if (!options_.recursive) {
+        return;
+    }
+
+    std::error_code ec;
+    for (fs::directory_iterator it(path, ec), end; !ec && it != end; it.increment(ec)) {
+        std::error_code type_ec;
+        if (it->is_directory(type_ec) && !it->is_symlink(type_ec)) {
+            watch_tree(join(relative_dir, it->path().filename().c_str()));
+        }
+    }
+}
+
+void FileWatcher::run() {
+    alignas(inotify_event) char buffer[64 * 1024];
+    pollfd fds[2] = {{inotify_fd_, POLLIN, 0}, {wake_fd_, POLLIN, 0}};
+    while (true) {
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[1].revents) {
+            break;
+        }
+        ssize_t length = ::read(inotify_fd_, buffer, sizeof(buffer));
+        if (length > 0) {
+            handle_events(buffer, static_cast<long>(length));
+        } else if (length < 0 && errno != EAGAIN && errno != EINTR) {
+            break;
+        }
+    }
+}
+
+void FileWatcher::handle_events(const char* buffer, long length) {
+    for (long offset = 0; offset < length;) {
+        const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+        offset += static_cast<long>(sizeof(inotify_event) + event->len);
+
+        if (event->mask & IN_Q_OVERFLOW) {
+            callback_("");
+            continue;
+        }
+        auto dir = dirs_.find(event->wd);
+        if (dir == dirs_.end()) {
+            continue;
+        }
+        if (event->mask & IN_IGNORED) {
+            dirs_.erase(dir);  // Watched directory is gone
+            continue;
+        }
+        if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+            callback_("");
+            continue;
+        }
+        if (event->len == 0) {
+            continue;
+        }
+
+        std::string path = join(dir->second, event->name);
+        if (event->mask & IN_ISDIR) {
+            // A new or renamed-in directory may hold files whose earlier
+            // 404s are cached; a removed one takes its files with it
+            if (options_.recursive && (event->mask & (IN_CREATE | IN_MOVED_TO))) {
+                watch_tree(path);
+            }
+            if (event->mask & (IN_CREATE | IN_MOVED_TO | IN_DELETE | IN_MOVED_FROM)) {
+                callback_("");
+            }
+            continue;
+        }
+        callback_(path);
+    }
+}
+
+#else
+
+FileWatcher::~FileWatcher() {
+    stop();
+}
+
+bool FileWatcher::start(const std::string&, Callback, WatchOptions) {
+    return false;  // No inotify: callers keep relying on cache TTLs
+}
+
+void FileWatcher::stop() {}
+
+void FileWatcher::run() {}
+
+void FileWatcher::watch_tree(const std::string&) {}
+
+void FileWatcher::handle_events(const char*, long) {}
+
+#endif
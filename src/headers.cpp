@@ -0,0 +1,100 @@
+#include "headers.hpp"
+#include <algorithm>
+#include <cctype>
+#include "http_parser.hpp"
+
+namespace {
+
+// Indexed by HeaderId
+constexpr std::string_view WELL_KNOWN_NAMES[WELL_KNOWN_HEADER_COUNT] = {
+    "host",
+    "connection",
+    "content-length",
+    "content-type",
+    "transfer-encoding",
+    "expect",
+    "accept",
+    "accept-encoding",
+    "if-none-match",
+    "if-modified-since",
+    "range",
+    "if-range",
+    "user-agent",
+    "authorization",
+    "cookie",
+};
+
+}  // namespace
+
+HeaderId lookup_header_id(std::string_view name) {
+    // The length check rejects almost every candidate before any compare
+    for (size_t i = 0; i < WELL_KNOWN_HEADER_COUNT; ++i) {
+        if (WELL_KNOWN_NAMES[i].size() == name.size() && iequals(WELL_KNOWN_NAMES[i], name)) {
+            return static_cast<HeaderId>(i);
+        }
+    }
+    return HeaderId::Unknown;
+}
+
+std::string_view header_name(HeaderId id) {
+    size_t i = static_cast<size_t>(id);
+    return i < WELL_KNOWN_HEADER_COUNT ? WELL_KNOWN_NAMES[i] : std::string_view();
+}
+
+void HeaderMap::set(HeaderId id, std::string_view value) {
+    size_t i = static_cast<size_t>(id);
+    if (i >= WELL_KNOWN_HEADER_COUNT) return;
+    known_[i].assign(value.data(), value.size());
+    present_ |= 1u << i;
+}
+
+void HeaderMap::set(std::string_view name, std::string_view value) {
+    HeaderId id = lookup_header_id(name);
+    if (id != HeaderId::Unknown) {
+        set(id, value);
+        return;
+    }
+
+    for (size_t i = 0; i < other_count_; ++i) {
+        if (iequals(other_[i].first, name)) {
+            other_[i].second.assign(value.data(), value.size());
+            return;
+        }
+    }
+
+    // Store header in lowercase for case-insensitive lookup, in a slot left
+    // by clear() when there is one
+    if (other_count_ == other_.size()) {
+        other_.emplace_back();
+    }
+    auto& [key, existing] = other_[other_count_++];
+    key.resize(name.size());
+    std::transform(name.begin(), name.end(), key.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    existing.assign(value.data(), value.size());
+}
+
+const std::string* HeaderMap::get(std::string_view name) const {
+    HeaderId id = lookup_header_id(name);
+    if (id != HeaderId::Unknown) {
+        return get(id);
+    }
+    for (size_t i = 0; i < other_count_; ++i) {
+        if (iequals(other_[i].first, name)) {
+            return &other_[i].second;
+        }
+    }
+    return nullptr;
+}
+
+size_t HeaderMap::size() const {
+    return static_cast<size_t>(__builtin_popcount(present_)) + other_count_;
+}
+
+void HeaderMap::clear() {
+    // Keep the strings' capacity for reuse; only the presence bits and the
+    // count of other headers matter
+    present_ = 0;
+    other_count_ = 0;
+}
@@ -0,0 +1,98 @@
+#include "http_date.hpp"
+
+namespace {
+
+const char WEEKDAYS[7][4] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+const char MONTHS[12][4] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                            "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+char* put_2digits(char* p, int value) {
+    *p++ = static_cast<char>('0' + value / 10);
+    *p++ = static_cast<char>('0' + value % 10);
+    return p;
+}
+
+char* put_name(char* p, const char* name) {
+    *p++ = name[0];
+    *p++ = name[1];
+    *p++ = name[2];
+    return p;
+}
+
+bool read_digits(std::string_view text, size_t pos, size_t count, int& value) {
+    value = 0;
+    for (size_t i = pos; i < pos + count; ++i) {
+        if (text[i] < '0' || text[i] > '9') return false;
+        value = value * 10 + (text[i] - '0');
+    }
+    return true;
+}
+
+struct DateCache {
+    std::time_t second = -1;
+    char text[HTTP_DATE_LENGTH];
+};
+
+}  // namespace
+
+void format_http_date(std::time_t time, char* out) {
+    std::tm tm{};
+    gmtime_r(&time, &tm);
+
+    char* p = put_name(out, WEEKDAYS[tm.tm_wday]);
+    *p++ = ',';
+    *p++ = ' ';
+    p = put_2digits(p, tm.tm_mday);
+    *p++ = ' ';
+    p = put_name(p, MONTHS[tm.tm_mon]);
+    *p++ = ' ';
+    int year = tm.tm_year + 1900;
+    p = put_2digits(p, year / 100);
+    p = put_2digits(p, year % 100);
+    *p++ = ' ';
+    p = put_2digits(p, tm.tm_hour);
+    *p++ = ':';
+    p = put_2digits(p, tm.tm_min);
+    *p++ = ':';
+    p = put_2digits(p, tm.tm_sec);
+    *p++ = ' ';
+    *p++ = 'G';
+    *p++ = 'M';
+    *p++ = 'T';
+}
+
+bool parse_http_date(std::string_view text, std::time_t& out) {
+    // "Sun, 06 Nov 1994 08:49:37 GMT"
+    if (text.size() != HTTP_DATE_LENGTH || text.substr(3, 2) != ", " || text.substr(25) != " GMT" ||
+        text[7] != ' ' || text[11] != ' ' || text[16] != ' ' || text[19] != ':' || text[22] != ':') {
+        return false;
+    }
+    int month = -1;
+    for (int m = 0; m < 12; ++m) {
+        if (text.substr(8, 3) == std::string_view(MONTHS[m], 3)) month = m;
+    }
+    std::tm tm{};
+    int year = 0;
+    if (month < 0 || !read_digits(text, 5, 2, tm.tm_mday) || !read_digits(text, 12, 4, year) ||
+        !read_digits(text, 17, 2, tm.tm_hour) || !read_digits(text, 20, 2, tm.tm_min) ||
+        !read_digits(text, 23, 2, tm.tm_sec)) {
+        return false;
+    }
+    if (tm.tm_mday < 1 || tm.tm_mday > 31 || tm.tm_hour > 23 || tm.tm_min > 59 || tm.tm_sec > 60) {
+        return false;
+    }
+    tm.tm_mon = month;
+    tm.tm_year = year - 1900;
+    out = timegm(&tm);
+    return true;
+}
+
+std::string_view http_date() {
+    thread_local DateCache cache;
+    std::time_t now = std::time(nullptr);
+    if (now != cache.second) {
+        format_http_date(now, cache.text);
+        cache.second = now;
+    }
+    return std::string_view(cache.text, HTTP_DATE_LENGTH);
+}
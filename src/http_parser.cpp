@@ -0,0 +1,359 @@
+#include "http_parser.hpp"
+#include <algorithm>
+#include <iterator>
+#include "simd_scan.hpp"
+
+namespace {
+
+bool is_ows(char c) {
+    return c == ' ' || c == '\t';
+}
+
+}  // namespace
+
+RequestParser::RequestParser(size_t max_header_size) : max_header_size_(max_header_size) {
+    reset();
+}
+
+void RequestParser::reset() {
+    state_ = State::RequestLine;
+    line_start_ = 0;
+    scanned_ = 0;
+    header_count_ = 0;
+    header_length_ = 0;
+    error_status_ = 0;
+    method_ = target_ = version_ = {};
+    std::fill(std::begin(first_index_), std::end(first_index_), 0);
+}
+
+RequestParser::Result RequestParser::fail(int status) {
+    error_status_ = status;
+    state_ = State::Done;
+    return Result::Error;
+}
+
+RequestParser::Result RequestParser::parse(std::string_view data) {
+    if (state_ == State::Done) {
+        if (error_status_) return Result::Error;
+        publish(data);  // The buffer may have moved since the last call
+        return Result::Complete;
+    }
+
+    if (state_ == State::RequestLine) {
+        // Look for the end of the request line, skipping bytes already seen
+        const char* data_end = data.data() + data.size();
+        while (true) {
+            // Reset each pass: after a skipped empty line there may be
+            // nothing left to scan
+            const char* nl = data_end;
+            size_t search_from = scanned_ > line_start_ ? scanned_ : line_start_;
+            if (search_from < data.size()) {
+                nl = scan_for_byte(data.data() + search_from, data_end, '\n');
+            }
+            if (nl == data_end) {
+                scanned_ = data.size();
+                return data.size() > max_header_size_ ? fail(431) : Result::Incomplete;
+            }
+
+            size_t line_end = static_cast<size_t>(nl - data.data());
+            if (line_end + 1 > max_header_size_) {
+                return fail(431);
+            }
+
+            // Accept CRLF and bare LF line endings
+            std::string_view line = data.substr(line_start_, line_end - line_start_);
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            size_t start = line_start_;
+            line_start_ = line_end + 1;
+            scanned_ = line_start_;
+
+            // Ignore empty lines before the request line (RFC 9112 2.2)
+            if (line.empty()) continue;
+            if (parse_request_line(line, start) == Result::Error) return Result::Error;
+            state_ = State::Headers;
+            break;
+        }
+    }
+
+    // Header lines are scanned in a single pass each: the name scan stops
+    // at the colon and the value scan stops at the CR/LF ending the line
+    while (true) {
+        Step step = parse_header_line(data);
+        if (step == Step::Error) return Result::Error;
+        if (line_start_ > max_header_size_) return fail(431);
+        if (step == Step::NeedMore) {
+            return data.size() > max_header_size_ ? fail(431) : Result::Incomplete;
+        }
+        if (step == Step::EndOfHead) {
+            header_length_ = line_start_;
+            state_ = State::Done;
+            publish(data);
+            return Result::Complete;
+        }
+    }
+}
+
+RequestParser::Result RequestParser::parse_request_line(std::string_view line, size_t line_start) {
+    const char* begin = line.data();
+    const char* end = begin + line.size();
+
+    // The method ends at the first non-token byte, which must be the SP
+    const char* method_end = scan_non_token(begin, end);
+    if (method_end == begin || method_end == end || *method_end != ' ') return fail(400);
+
+    // Likewise the target ends at the first byte a target may not contain
+    const char* target_begin = method_end + 1;
+    const char* target_end = scan_non_target(target_begin, end);
+    if (target_end == target_begin || target_end == end || *target_end != ' ') return fail(400);
+
+    size_t sp1 = static_cast<size_t>(method_end - begin);
+    size_t sp2 = static_cast<size_t>(target_end - begin);
+    std::string_view method = line.substr(0, sp1);
+    std::string_view target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    std::string_view version = line.substr(sp2 + 1);
+
+    // HTTP-version = "HTTP/" DIGIT "." DIGIT
+    if (version.size() != 8 || version.substr(0, 5) != "HTTP/" ||
+        version[5] < '0' || version[5] > '9' || version[6] != '.' ||
+        version[7] < '0' || version[7] > '9') {
+        return fail(400);
+    }
+    if (version[5] != '1') return fail(505);
+
+    method_span_ = {static_cast<uint32_t>(line_start), static_cast<uint32_t>(method.size())};
+    target_span_ = {static_cast<uint32_t>(line_start + sp1 + 1), static_cast<uint32_t>(target.size())};
+    version_span_ = {static_cast<uint32_t>(line_start + sp2 + 1), static_cast<uint32_t>(version.size())};
+    return Result::Incomplete;
+}
+
+// Parse the header line starting at line_start_ and advance past it
+RequestParser::Step RequestParser::parse_header_line(std::string_view data) {
+    const char* begin = data.data();
+    const char* end = begin + data.size();
+    const char* p = begin + line_start_;
+    if (p == end) return Step::NeedMore;
+
+    // Blank line: end of the head
+    if (*p == '\n' || *p == '\r') {
+        if (*p == '\r') {
+            if (p + 1 == end) return Step::NeedMore;
+            if (p[1] != '\n') return fail_step(400);
+            ++p;
+        }
+        line_start_ = static_cast<size_t>(p + 1 - begin);
+        return Step::EndOfHead;
+    }
+
+    // Obsolete line folding is rejected (RFC 9112 5.2)
+    if (is_ows(*p)) return fail_step(400);
+
+    // The name runs up to the first non-token byte, which must be the colon
+    // (so whitespace between the field name and the colon is rejected too)
+    const char* name_end = scan_non_token(p, end);
+    if (name_end == end) return Step::NeedMore;
+    if (name_end == p || *name_end != ':') return fail_step(400);
+
+    const char* value_begin = name_end + 1;
+    while (value_begin < end && is_ows(*value_begin)) ++value_begin;
+
+    // The value runs up to the first byte a value may not contain, which
+    // must be the line ending
+    const char* value_end = scan_non_field_value(value_begin, end);
+    if (value_end == end) return Step::NeedMore;
+    const char* next_line;
+    if (*value_end == '\r') {
+        if (value_end + 1 == end) return Step::NeedMore;
+        if (value_end[1] != '\n') return fail_step(400);
+        next_line = value_end + 2;
+    } else if (*value_end == '\n') {
+        next_line = value_end + 1;
+    } else {
+        return fail_step(400);
+    }
+    while (value_end > value_begin && is_ows(value_end[-1])) --value_end;
+
+    if (header_count_ == MAX_HEADER_COUNT) return fail_step(431);
+
+    // Intern well-known names so later lookups are a table index
+    HeaderId id = lookup_header_id(std::string_view(p, static_cast<size_t>(name_end - p)));
+    size_t known = static_cast<size_t>(id);
+    if (id != HeaderId::Unknown && first_index_[known] == 0) {
+        first_index_[known] = static_cast<uint8_t>(header_count_ + 1);
+    }
+    ids_[header_count_] = id;
+    name_spans_[header_count_] = {static_cast<uint32_t>(p - begin), static_cast<uint32_t>(name_end - p)};
+    value_spans_[header_count_] = {static_cast<uint32_t>(value_begin - begin), static_cast<uint32_t>(value_end - value_begin)};
+    ++header_count_;
+    line_start_ = static_cast<size_t>(next_line - begin);
+    return Step::Progress;
+}
+
+RequestParser::Step RequestParser::fail_step(int status) {
+    fail(status);
+    return Step::Error;
+}
+
+void RequestParser::publish(std::string_view data) {
+    auto view = [&data](const Span& span) {
+        return data.substr(span.offset, span.length);
+    };
+    method_ = view(method_span_);
+    target_ = view(target_span_);
+    version_ = view(version_span_);
+    for (size_t i = 0; i < header_count_; ++i) {
+        fields_[i] = {view(name_spans_[i]), view(value_spans_[i]), ids_[i]};
+    }
+}
+
+const HeaderField* RequestParser::find_header(HeaderId id) const {
+    size_t known = static_cast<size_t>(id);
+    if (known >= WELL_KNOWN_HEADER_COUNT || first_index_[known] == 0) {
+        return nullptr;
+    }
+    return &fields_[first_index_[known] - 1];
+}
+
+const HeaderField* RequestParser::find_header(std::string_view name) const {
+    HeaderId id = lookup_header_id(name);
+    if (id != HeaderId::Unknown) {
+        return find_header(id);
+    }
+    for (size_t i = 0; i < header_count_; ++i) {
+        if (iequals(fields_[i].name, name)) {
+            return &fields_[i];
+        }
+    }
+    return nullptr;
+}
+
+std::string_view RequestParser::header(std::string_view name) const {
+    const HeaderField* field = find_header(name);
+    return field ? field->value : std::string_view();
+}
+
+ChunkedDecoder::ChunkedDecoder(size_t max_line_size) : max_line_size_(max_line_size) {}
+
+void ChunkedDecoder::reset() {
+    state_ = State::Size;
+    remaining_ = 0;
+    size_digits_ = 0;
+    line_size_ = 0;
+    error_ = false;
+}
+
+ChunkedDecoder::Result ChunkedDecoder::decode(std::string_view input, size_t& consumed, std::string_view& data) {
+    consumed = 0;
+    if (error_) return Result::Error;
+    auto fail = [this]() {
+        error_ = true;
+        return Result::Error;
+    };
+
+    while (state_ != State::Done) {
+        if (state_ == State::Data) {
+            if (consumed == input.size()) return Result::NeedMore;
+            size_t take = static_cast<size_t>(std::min<std::uint64_t>(remaining_, input.size() - consumed));
+            data = input.substr(consumed, take);
+            consumed += take;
+            remaining_ -= take;
+            if (remaining_ == 0) state_ = State::DataLineEnd;
+            return Result::Data;
+        }
+        if (consumed == input.size()) return Result::NeedMore;
+        char c = input[consumed++];
+
+        switch (state_) {
+            case State::Size: {
+                int digit = c >= '0' && c <= '9' ? c - '0'
+                          : (c | 0x20) >= 'a' && (c | 0x20) <= 'f' ? (c | 0x20) - 'a' + 10 : -1;
+                if (digit >= 0) {
+                    if (++size_digits_ > 15) return fail();  // Keeps sizes below 2^60
+                    remaining_ = remaining_ * 16 + static_cast<std::uint64_t>(digit);
+                    break;
+                }
+                if (size_digits_ == 0) return fail();
+                if (c == ';' || is_ows(c)) {
+                    state_ = State::Extension;
+                    line_size_ = 1;
+                } else if (c == '\r') {
+                    state_ = State::SizeLineEnd;
+                } else if (c == '\n') {
+                    state_ = remaining_ ? State::Data : State::TrailerStart;
+                } else {
+                    return fail();
+                }
+                break;
+            }
+            case State::Extension:
+                if (c == '\r') {
+                    state_ = State::SizeLineEnd;
+                } else if (c == '\n') {
+                    state_ = remaining_ ? State::Data : State::TrailerStart;
+                    line_size_ = 0;
+                } else if (++line_size_ > max_line_size_) {
+                    return fail();
+                }
+                break;
+            case State::SizeLineEnd:
+                if (c != '\n') return fail();
+                state_ = remaining_ ? State::Data : State::TrailerStart;
+                line_size_ = 0;
+                break;
+            case State::DataLineEnd:
+                // Data must be followed by exactly a line end, or the size lied
+                if (c == '\r') {
+                    state_ = State::DataLineEndLf;
+                    break;
+                }
+                [[fallthrough]];
+            case State::DataLineEndLf:
+                if (c != '\n') return fail();
+                state_ = State::Size;
+                size_digits_ = 0;
+                break;
+            case State::TrailerStart:
+                if (c == '\r') {
+                    state_ = State::LastLineEnd;
+                } else if (c == '\n') {
+                    state_ = State::Done;
+                } else {
+                    // The whole trailer section shares one size limit
+                    if (++line_size_ > max_line_size_) return fail();
+                    state_ = State::Trailer;
+                }
+                break;
+            case State::Trailer:
+                if (++line_size_ > max_line_size_) return fail();
+                if (c == '\r') {
+                    state_ = State::TrailerLineEnd;
+                } else if (c == '\n') {
+                    state_ = State::TrailerStart;
+                }
+                break;
+            case State::TrailerLineEnd:
+                if (c != '\n') return fail();
+                state_ = State::TrailerStart;
+                break;
+            case State::LastLineEnd:
+                if (c != '\n') return fail();
+                state_ = State::Done;
+                break;
+            case State::Data:
+            case State::Done:
+                break;
+        }
+    }
+    return Result::Done;
+}
+
+long long parse_content_length(std::string_view value) {
+    if (value.empty() || value.size() > 18) return -1;
+    long long length = 0;
+    for (char c : value) {
+        if (c < '0' || c > '9') return -1;
+        length = length * 10 + (c - '0');
+    }
+    return length;
+}
@@ -2,229 +2,173 @@
 #include <iostream>
 #include <string>
 #include <functional>
-#include <sstream>
-#include <algorithm>
-#include <cctype>
-#include <ctime>
-#include <iomanip>
+#include <memory>
 #include <thread>
-#include "router.hpp"
-#include "middleware.hpp"
+#include <vector>
+#include "access_log.hpp"
 #include "file_server.hpp"
-#include "request.hpp"
+#include "metrics.hpp"
+#include "middleware.hpp"
+#include "router.hpp"
+#include "reactor.hpp"
+#include "server_config.hpp"
+#include "session.hpp"
 #include "thread_pool.hpp"
 
 using boost::asio::ip::tcp;
 namespace asio = boost::asio;
 
-// Security limits
-constexpr size_t MAX_CONTENT_LENGTH = 10 * 1024 * 1024;  // 10 MB
-constexpr size_t MAX_HEADER_SIZE = 8 * 1024;              // 8 KB
-constexpr size_t MAX_KEEPALIVE_REQUESTS = 1000;           // Max requests per connection
-constexpr int REQUEST_TIMEOUT_SECONDS = 30;               // Request timeout
-
-void handle_request(tcp::socket socket){
-    size_t request_count = 0;  // Track requests per connection
-
-    while (true) {
-        auto do_read = [&socket, &request_count](){
-            std::string req_headers;
-            boost::system::error_code ec;
-
-            // Read headers with size limit
-            read_until(socket, asio::dynamic_buffer(req_headers),"\r\n\r\n", ec);
-            if (ec) {
-                if (ec == boost::asio::error::eof || ec == boost::asio::error::connection_reset || ec == boost::asio::error::operation_aborted) {
-                    return;
-                }
-                std::cerr << "Error reading request: " << ec.message() << "\n";
-                std::string error_resp = "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n";
-                boost::system::error_code ignored_ec;
-                write(socket, asio::buffer(error_resp), ignored_ec);
-                return;
-            }
-
-            // Validate header size to prevent memory exhaustion
-            if (req_headers.size() > MAX_HEADER_SIZE) {
-                std::string error_resp = "HTTP/1.1 431 Request Header Fields Too Large\r\n"
-                                       "Content-Type: text/plain\r\n"
-                                       "Content-Length: 34\r\n"
-                                       "Connection: close\r\n\r\n"
-                                       "Request headers exceed size limit";
-                boost::system::error_code ignored_ec;
-                write(socket, asio::buffer(error_resp), ignored_ec);
-                socket.shutdown(tcp::socket::shutdown_both, ignored_ec);
-                socket.close(ignored_ec);
-                return;
-            }
-
-            // Parse request headers
-            Request request = parse_request(req_headers);
-
-            // Read body if Content-Length is present
-            int content_length = get_content_length(request.headers);
-
-            // Validate Content-Length to prevent memory exhaustion attack
-            if (content_length < 0) {
-                std::string error_resp = "HTTP/1.1 400 Bad Request\r\n"
-                                       "Content-Type: text/plain\r\n"
-                                       "Content-Length: 24\r\n"
-                                       "Connection: close\r\n\r\n"
-                                       "Invalid Content-Length";
-                boost::system::error_code ignored_ec;
-                write(socket, asio::buffer(error_resp), ignored_ec);
-                socket.shutdown(tcp::socket::shutdown_both, ignored_ec);
-                socket.close(ignored_ec);
-                return;
-            }
+// SIGHUP reloads the config routes; re-armed until cancelled at shutdown
+static void wait_for_reload(asio::signal_set& signals) {
+    signals.async_wait([&signals](const boost::system::error_code& ec, int) {
+        if (ec) {
+            return;
+        }
+        reload_router_config();
+        wait_for_reload(signals);
+    });
+}
 
-            if (content_length > static_cast<int>(MAX_CONTENT_LENGTH)) {
-                std::string error_resp = "HTTP/1.1 413 Payload Too Large\r\n"
-                                       "Content-Type: text/plain\r\n"
-                                       "Content-Length: 44\r\n"
-                                       "Connection: close\r\n\r\n"
-                                       "Request body exceeds maximum allowed size";
-                boost::system::error_code ignored_ec;
-                write(socket, asio::buffer(error_resp), ignored_ec);
-                socket.shutdown(tcp::socket::shutdown_both, ignored_ec);
-                socket.close(ignored_ec);
-                return;
+// Shared mode: one acceptor on one io_context, run by a pool of threads
+static void run_shared(const ServerConfig& config) {
+    // Create thread pool with hardware concurrency threads
+    unsigned int num_threads = config.threads ? config.threads : std::thread::hardware_concurrency();
+    if (num_threads == 0) num_threads = 4;  // Fallback to 4 threads
+    ThreadPool thread_pool(num_threads);
+    add_metrics_gauge("tez_thread_pool_queued_tasks", "Tasks waiting for a pool worker.",
+                      [&thread_pool]() { return static_cast<double>(thread_pool.queued()); });
+    add_metrics_gauge("tez_thread_pool_idle_workers", "Pool workers parked for lack of work.",
+                      [&thread_pool]() { return static_cast<double>(thread_pool.idle()); });
+
+    asio::io_context io;
+
+    tcp::acceptor acceptor(io, {tcp::v4(), config.port});
+    acceptor.set_option(asio::socket_base::reuse_address(true));
+
+    boost::asio::signal_set reload_signals(io, SIGHUP);
+    wait_for_reload(reload_signals);
+    boost::asio::signal_set signals(io, SIGINT, SIGTERM);
+    signals.async_wait([&](const boost::system::error_code&, int){
+        std::cout << "Shutting down...\n";
+        boost::system::error_code ignored_ec;
+        acceptor.close(ignored_ec);
+        reload_signals.cancel(ignored_ec);
+        io.stop();
+    });
+
+    std::cout << "Tez server starting on port " << config.port << " with " << num_threads << " worker threads...\n";
+
+    // Async accept loop. Each connection gets its own strand so the
+    // session's I/O chain and its timer never run concurrently.
+    std::function<void()> do_accept;
+    do_accept = [&](){
+        acceptor.async_accept(asio::make_strand(io), [&](boost::system::error_code ec, tcp::socket socket){
+            if(!ec){
+                std::make_shared<Session>(std::move(socket))->start();
             }
-
-            if (content_length > 0) {
-                std::string body_buffer;
-                body_buffer.resize(content_length);
-                boost::asio::read(socket, boost::asio::buffer(&body_buffer[0], content_length), ec);
-                if (!ec) {
-                    request.body = body_buffer;
-                }
+            if (ec != boost::asio::error::operation_aborted) {
+                do_accept();
             }
+        });
+    };
+    do_accept();
 
-            // Get client IP (for logging)
-            std::string client_ip = socket.remote_endpoint().address().to_string();
-
-            // Log the request (middleware)
-            log_request(client_ip, request.method, request.path);
+    // Sessions are fully asynchronous, so the pool threads only drive the
+    // io_context; the main thread runs it too
+    for (unsigned int i = 1; i < num_threads; ++i) {
+        thread_pool.post([&io](){ io.run(); });
+    }
+    io.run();
+    clear_metrics_gauges();
+    thread_pool.shutdown();
+}
 
-            Response response;
-            if (request.path.substr(0, 8) == "/static/") {
-                response = serve_file(request.path);
-            } else {
-                response = handle_route_with_method(request.method, request.path, request.body);
-            }
-            // Determine keep-alive semantics
-            bool keep_alive = false;
-            // Default keep-alive for HTTP/1.1 unless explicitly closed
-            if (request.version == "HTTP/1.1") keep_alive = true;
-            // Check Connection header from parsed request
-            auto conn_it = request.headers.find("connection");
-            if (conn_it != request.headers.end()) {
-                std::string conn_value = conn_it->second;
-                std::transform(conn_value.begin(), conn_value.end(), conn_value.begin(), [](unsigned char ch){
-                    return static_cast<char>(std::tolower(ch));
-                });
-                if (conn_value == "close") keep_alive = false;
-                else if (conn_value == "keep-alive") keep_alive = true;
-            }
+static void print_cache_stats(const char* name, const CacheStats& stats) {
+    std::cout << name << " cache: " << stats.hits << " hits, " << stats.misses << " misses ("
+              << static_cast<int>(stats.hit_ratio() * 100.0 + 0.5) << "% hit ratio), "
+              << stats.entries << " entries, " << stats.bytes << " bytes\n";
+}
 
-            std::time_t now = std::time(nullptr);
-            std::tm tm = *std::gmtime(&now);
-            std::ostringstream date_ss;
-            date_ss << std::put_time(&tm, "%a, %d %b %Y %H:%M:%S GMT");
-
-            // Build and send response
-            std::string resp;
-            resp.reserve(128);
-            resp += "HTTP/1.1 " + response.status + "\r\n";
-            resp += "Content-Type: " + response.content_type + "\r\n";
-            resp += "Date: " + date_ss.str() + "\r\n";
-            resp += "Server: Tez\r\n";
-            resp += std::string("Connection: ") + (keep_alive ? "keep-alive" : "close") + std::string("\r\n");
-            if (keep_alive) {
-                resp += "Keep-Alive: timeout=5, max=1000\r\n";
-            }
-            resp += "Content-Length: " + std::to_string(response.body.size()) + "\r\n";
-            resp += "\r\n";
-            resp += response.body;
-
-            // Send response
-            boost::system::error_code send_ec;
-            write(socket, asio::buffer(resp), send_ec);
-            if (send_ec) {
-                std::cerr << "Error sending response: " << send_ec.message() << "\n";
-                return;
-            }
+// Multi-reactor mode: N single-threaded io_contexts, each with its own
+// SO_REUSEPORT acceptor. The main thread only waits for signals.
+static void run_reactors(const ServerConfig& config) {
+    unsigned int num_cpus = std::thread::hardware_concurrency();
+    if (num_cpus == 0) num_cpus = 1;
 
-            // Increment request counter
-            request_count++;
+    std::vector<std::unique_ptr<Reactor>> reactors;
+    for (unsigned int i = 0; i < config.reactors; ++i) {
+        int cpu = config.pin_reactors ? static_cast<int>(i % num_cpus) : -1;
+        reactors.push_back(std::make_unique<Reactor>(config.port, cpu));
+    }
 
-            // Check if we've exceeded max keep-alive requests
-            if (request_count >= MAX_KEEPALIVE_REQUESTS) {
-                keep_alive = false;  // Force close after max requests
-            }
+    asio::io_context io;
+    boost::asio::signal_set reload_signals(io, SIGHUP);
+    wait_for_reload(reload_signals);
+    boost::asio::signal_set signals(io, SIGINT, SIGTERM);
+    signals.async_wait([&](const boost::system::error_code&, int){
+        std::cout << "Shutting down...\n";
+        boost::system::error_code ignored_ec;
+        reload_signals.cancel(ignored_ec);
+        for (auto& reactor : reactors) {
+            reactor->stop();
+        }
+    });
 
-            // Break loop if not keep-alive
-            if (!keep_alive) {
-                boost::system::error_code ignored;
-                socket.shutdown(tcp::socket::shutdown_both, ignored);
-                socket.close(ignored);
-                return;
-            }
-        };
+    std::cout << "Tez server starting on port " << config.port << " with " << config.reactors
+              << " reactors" << (config.pin_reactors ? " (pinned)" : "") << "...\n";
 
-        do_read();
-        // After handling, check if socket is still open for next request
-        if (!socket.is_open()) {
-            break;
-        }
+    for (auto& reactor : reactors) {
+        reactor->start();
+    }
+    io.run();
+    for (auto& reactor : reactors) {
+        reactor->join();
     }
 }
 
-
 int main() {
     try {
         // Initialize router configuration at startup
         init_router_config();
+        ServerConfig config = load_server_config(config_path());
+        set_sendfile_threshold(config.sendfile_threshold);
+        set_compression_options(config.compression);
+        set_cache_control_policies(config.cache_control);
+        // Without change notifications the TTL is what picks up edits
+        if (!config.watch_static && config.file_cache.ttl_seconds == 0) {
+            config.file_cache.ttl_seconds = FALLBACK_FILE_CACHE_TTL_SECONDS;
+        }
+        // The caches are built before the watchers start: their callbacks
+        // purge them from the watcher threads
+        configure_caches(config.response_cache, config.file_cache);
+        if (config.watch_static) {
+            if (start_static_watcher()) {
+                std::cout << "Watching ../static for changes\n";
+            } else if (config.file_cache.ttl_seconds == 0) {
+                // No watcher thread is running, so rebuilding is still safe
+                config.file_cache.ttl_seconds = FALLBACK_FILE_CACHE_TTL_SECONDS;
+                configure_caches(config.response_cache, config.file_cache);
+            }
+        }
+        if (config.watch_config && start_config_watcher()) {
+            std::cout << "Watching " << config_path() << " for route changes\n";
+        }
+        start_access_log(config.access_log);
 
-        // Create thread pool with hardware concurrency threads
-        unsigned int num_threads = std::thread::hardware_concurrency();
-        if (num_threads == 0) num_threads = 4;  // Fallback to 4 threads
-        ThreadPool thread_pool(num_threads);
-
-        asio::io_context io;
-
-        tcp::acceptor acceptor(io, {tcp::v4(), 8080});
-        acceptor.set_option(asio::socket_base::reuse_address(true));
-
-        boost::asio::signal_set signals(io, SIGINT, SIGTERM);
-        signals.async_wait([&](const boost::system::error_code&, int){
-            std::cout << "Shutting down...\n";
-            boost::system::error_code ignored_ec;
-            acceptor.close(ignored_ec);
-            io.stop();
-            thread_pool.shutdown();
-        });
-
-        std::cout << "Tez server starting on port 8080 with " << num_threads << " worker threads...\n";
-
-      // Async accept loop
-      std::function<void()> do_accept;
-        do_accept = [&](){
-            auto socket = std::make_shared<tcp::socket>(io);
-            acceptor.async_accept(*socket, [&, socket](boost::system::error_code ec){
-                if(!ec){
-                    // Enqueue connection handling to thread pool
-                    thread_pool.enqueue([socket](){
-                        handle_request(std::move(*socket));
-                    });
-                }
-                if (ec != boost::asio::error::operation_aborted) {
-                    do_accept();
-                }
-            });
-         };
-         do_accept();
-         io.run();
+        if (config.reactors > 0) {
+            run_reactors(config);
+        } else {
+            run_shared(config);
+        }
+        stop_config_watcher();
+        stop_static_watcher();
+        print_cache_stats("Response", response_cache_stats());
+        print_cache_stats("File", file_cache_stats());
+
+        stop_access_log();
+        AccessLogStats log_stats = access_log_stats();
+        std::cout << "Access log: " << log_stats.written << " records written, " << log_stats.dropped
+                  << " dropped, " << log_stats.rotations << " rotations\n";
     } catch (std::exception& e) {
         std::cerr << "Exception: " << e.what() << "\n";
     }
@@ -0,0 +1,282 @@
+#include "metrics.hpp"
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "access_log.hpp"
+#include "middleware.hpp"
+
+namespace {
+
+// Export bounds of the Prometheus histograms: every other power of two
+// from 2^10 ns (about 1 us) to 2^34 ns (about 17 s). They fall on bucket
+// edges, so the exported counts are exact.
+constexpr unsigned EXPORT_FIRST_BITS = 10;
+constexpr unsigned EXPORT_LAST_BITS = 34;
+constexpr unsigned EXPORT_STEP_BITS = 2;
+
+constexpr double EXPORT_QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+
+const char* const PHASE_NAMES[PHASE_COUNT] = {"read", "parse", "route", "cache_lookup", "serve_file", "write"};
+
+struct PhaseHistogram {
+    std::atomic<std::uint64_t> buckets[LATENCY_BUCKET_COUNT];
+    std::atomic<std::uint64_t> sum_ns;
+};
+
+// One thread's metrics. Only the owner writes, so a bump is a relaxed load
+// and store rather than a locked read-modify-write; a scrape may read a
+// value one increment behind.
+struct alignas(64) MetricsShard {
+    std::atomic<std::uint64_t> counters[COUNTER_COUNT];
+    PhaseHistogram phases[PHASE_COUNT];
+};
+
+inline void bump(std::atomic<std::uint64_t>& value, std::uint64_t n) {
+    value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+std::mutex g_shards_mutex;
+std::vector<std::unique_ptr<MetricsShard>> g_shards;
+
+MetricsShard* register_shard() {
+    auto shard = std::make_unique<MetricsShard>();  // Value-initialized: all zero
+    std::lock_guard<std::mutex> lock(g_shards_mutex);
+    g_shards.push_back(std::move(shard));
+    return g_shards.back().get();
+}
+
+MetricsShard& local_shard() {
+    thread_local MetricsShard* shard = register_shard();
+    return *shard;
+}
+
+struct Gauge {
+    std::string name;
+    std::string help;
+    std::function<double()> sample;
+};
+
+std::mutex g_gauges_mutex;
+std::vector<Gauge> g_gauges;
+
+void append_number(std::string& out, double value) {
+    char text[32];
+    int n = std::snprintf(text, sizeof(text), "%.9g", value);
+    out.append(text, static_cast<size_t>(n));
+}
+
+void append_number(std::string& out, std::uint64_t value) {
+    char text[24];
+    int n = std::snprintf(text, sizeof(text), "%llu", static_cast<unsigned long long>(value));
+    out.append(text, static_cast<size_t>(n));
+}
+
+void append_header(std::string& out, const char* name, const char* type, const std::string& help) {
+    out.append("# HELP ").append(name).append(" ").append(help).append("\n");
+    out.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+}
+
+template<typename T>
+void append_sample(std::string& out, const char* name, const std::string& labels, T value) {
+    out.append(name);
+    if (!labels.empty()) {
+        out.append("{").append(labels).append("}");
+    }
+    out.append(" ");
+    append_number(out, value);
+    out.append("\n");
+}
+
+template<typename T>
+void append_single(std::string& out, const char* name, const char* type, const char* help, T value) {
+    append_header(out, name, type, help);
+    append_sample(out, name, "", value);
+}
+
+double to_seconds(std::uint64_t ns) {
+    return static_cast<double>(ns) / 1e9;
+}
+
+// One family per statistic, with a sample for each cache
+void append_caches(std::string& out, const CacheStats& response, const CacheStats& file) {
+    struct Family {
+        const char* name;
+        const char* type;
+        const char* help;
+        std::uint64_t (*value)(const CacheStats&);
+    };
+    static const Family families[] = {
+        {"tez_cache_hits_total", "counter", "Cache lookups that found an entry.",
+         [](const CacheStats& s) { return s.hits; }},
+        {"tez_cache_misses_total", "counter", "Cache lookups that found nothing.",
+         [](const CacheStats& s) { return s.misses; }},
+        {"tez_cache_evictions_total", "counter", "Entries evicted to make room.",
+         [](const CacheStats& s) { return s.evictions; }},
+        {"tez_cache_rejections_total", "counter", "Entries the admission policy turned away.",
+         [](const CacheStats& s) { return s.rejections; }},
+        {"tez_cache_entries", "gauge", "Entries held.",
+         [](const CacheStats& s) { return static_cast<std::uint64_t>(s.entries); }},
+        {"tez_cache_bytes", "gauge", "Bytes held.",
+         [](const CacheStats& s) { return static_cast<std::uint64_t>(s.bytes); }},
+    };
+    for (const Family& family : families) {
+        append_header(out, family.name, family.type, family.help);
+        append_sample(out, family.name, "cache=\"response\"", family.value(response));
+        append_sample(out, family.name, "cache=\"file\"", family.value(file));
+    }
+}
+
+}  // namespace
+
+void count(Counter counter, std::uint64_t n) {
+    bump(local_shard().counters[static_cast<size_t>(counter)], n);
+}
+
+void count_response(int status, std::uint64_t body_bytes) {
+    MetricsShard& shard = local_shard();
+    bump(shard.counters[static_cast<size_t>(Counter::Requests)], 1);
+    bump(shard.counters[static_cast<size_t>(Counter::ResponseBodyBytes)], body_bytes);
+    int status_class = status / 100;
+    if (status_class >= 1 && status_class <= 5) {
+        bump(shard.counters[static_cast<size_t>(Counter::Responses1xx) + static_cast<size_t>(status_class - 1)], 1);
+    }
+}
+
+void record_phase(Phase phase, std::chrono::steady_clock::duration elapsed) {
+    std::int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    std::uint64_t value = ns > 0 ? static_cast<std::uint64_t>(ns) : 0;
+    PhaseHistogram& histogram = local_shard().phases[static_cast<size_t>(phase)];
+    bump(histogram.buckets[latency_bucket(value)], 1);
+    bump(histogram.sum_ns, value);
+}
+
+std::uint64_t latency_bucket_limit(size_t bucket) {
+    constexpr size_t sub_buckets = size_t{1} << LATENCY_SUB_BUCKET_BITS;
+    if (bucket < sub_buckets) {
+        return bucket + 1;
+    }
+    unsigned shift = static_cast<unsigned>(bucket >> LATENCY_SUB_BUCKET_BITS) - 1;
+    std::uint64_t lower = static_cast<std::uint64_t>(sub_buckets + (bucket & (sub_buckets - 1))) << shift;
+    return lower + (std::uint64_t{1} << shift);
+}
+
+std::uint64_t LatencySnapshot::quantile_ns(double q) const {
+    if (count == 0) {
+        return 0;
+    }
+    auto rank = static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(count)));
+    if (rank == 0) rank = 1;
+    std::uint64_t seen = 0;
+    for (size_t i = 0; i < LATENCY_BUCKET_COUNT; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return latency_bucket_limit(i);
+        }
+    }
+    return latency_bucket_limit(LATENCY_BUCKET_COUNT - 1);
+}
+
+std::uint64_t counter_value(Counter counter) {
+    std::uint64_t total = 0;
+    std::lock_guard<std::mutex> lock(g_shards_mutex);
+    for (const auto& shard : g_shards) {
+        total += shard->counters[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+LatencySnapshot phase_snapshot(Phase phase) {
+    LatencySnapshot snapshot;
+    std::lock_guard<std::mutex> lock(g_shards_mutex);
+    for (const auto& shard : g_shards) {
+        const PhaseHistogram& histogram = shard->phases[static_cast<size_t>(phase)];
+        for (size_t i = 0; i < LATENCY_BUCKET_COUNT; ++i) {
+            std::uint64_t n = histogram.buckets[i].load(std::memory_order_relaxed);
+            snapshot.buckets[i] += n;
+            snapshot.count += n;
+        }
+        snapshot.sum_ns += histogram.sum_ns.load(std::memory_order_relaxed);
+    }
+    return snapshot;
+}
+
+void add_metrics_gauge(const std::string& name, const std::string& help, std::function<double()> sample) {
+    std::lock_guard<std::mutex> lock(g_gauges_mutex);
+    g_gauges.push_back({name, help, std::move(sample)});
+}
+
+void clear_metrics_gauges() {
+    std::lock_guard<std::mutex> lock(g_gauges_mutex);
+    g_gauges.clear();
+}
+
+std::string render_metrics() {
+    std::string out;
+    out.reserve(16 * 1024);
+
+    std::uint64_t accepted = counter_value(Counter::ConnectionsAccepted);
+    std::uint64_t closed = counter_value(Counter::ConnectionsClosed);
+    append_single(out, "tez_connections_accepted_total", "counter", "Connections accepted.", accepted);
+    append_single(out, "tez_connections_open", "gauge", "Connections currently open.",
+                  accepted > closed ? accepted - closed : 0);
+    append_single(out, "tez_requests_total", "counter", "Requests answered.", counter_value(Counter::Requests));
+    append_single(out, "tez_response_body_bytes_total", "counter", "Response body bytes queued for sending.",
+                  counter_value(Counter::ResponseBodyBytes));
+    append_header(out, "tez_responses_total", "counter", "Responses by status class.");
+    for (int status_class = 1; status_class <= 5; ++status_class) {
+        Counter counter = static_cast<Counter>(static_cast<size_t>(Counter::Responses1xx) + (status_class - 1));
+        append_sample(out, "tez_responses_total", "code=\"" + std::to_string(status_class) + "xx\"",
+                      counter_value(counter));
+    }
+
+    LatencySnapshot snapshots[PHASE_COUNT];
+    for (size_t p = 0; p < PHASE_COUNT; ++p) {
+        snapshots[p] = phase_snapshot(static_cast<Phase>(p));
+    }
+    append_header(out, "tez_phase_duration_seconds", "histogram", "Time spent in each phase of a request.");
+    for (size_t p = 0; p < PHASE_COUNT; ++p) {
+        const LatencySnapshot& snapshot = snapshots[p];
+        std::string phase = std::string("phase=\"") + PHASE_NAMES[p] + "\"";
+        std::uint64_t cumulative = 0;
+        size_t bucket = 0;
+        for (unsigned bits = EXPORT_FIRST_BITS; bits <= EXPORT_LAST_BITS; bits += EXPORT_STEP_BITS) {
+            std::uint64_t bound = std::uint64_t{1} << bits;
+            while (bucket < LATENCY_BUCKET_COUNT && latency_bucket_limit(bucket) <= bound) {
+                cumulative += snapshot.buckets[bucket++];
+            }
+            char le[32];
+            std::snprintf(le, sizeof(le), "%.9g", to_seconds(bound));
+            append_sample(out, "tez_phase_duration_seconds_bucket", phase + ",le=\"" + le + "\"", cumulative);
+        }
+        append_sample(out, "tez_phase_duration_seconds_bucket", phase + ",le=\"+Inf\"", snapshot.count);
+        append_sample(out, "tez_phase_duration_seconds_sum", phase, to_seconds(snapshot.sum_ns));
+        append_sample(out, "tez_phase_duration_seconds_count", phase, snapshot.count);
+    }
+    append_header(out, "tez_phase_duration_quantile_seconds", "gauge",
+                  "Phase duration percentiles since start, within 12.5%.");
+    for (size_t p = 0; p < PHASE_COUNT; ++p) {
+        for (double q : EXPORT_QUANTILES) {
+            char labels[64];
+            std::snprintf(labels, sizeof(labels), "phase=\"%s\",quantile=\"%g\"", PHASE_NAMES[p], q);
+            append_sample(out, "tez_phase_duration_quantile_seconds", labels,
+                          to_seconds(snapshots[p].quantile_ns(q)));
+        }
+    }
+
+    append_caches(out, response_cache_stats(), file_cache_stats());
+
+    AccessLogStats log = access_log_stats();
+    append_single(out, "tez_access_log_records_total", "counter", "Access log records written.", log.written);
+    append_single(out, "tez_access_log_dropped_total", "counter", "Access log records lost to full buffers.",
+                  log.dropped);
+
+    std::lock_guard<std::mutex> lock(g_gauges_mutex);
+    for (const Gauge& gauge : g_gauges) {
+        append_header(out, gauge.name.c_str(), "gauge", gauge.help);
+        append_sample(out, gauge.name.c_str(), "", gauge.sample());
+    }
+    return out;
+}
@@ -0,0 +1,209 @@
+#include "radix_router.hpp"
+#include <stdexcept>
+#include <vector>
+
+struct RadixRouter::Node {
+    std::string prefix;   // Static bytes matched on entry; empty for captures
+    std::string indices;  // First byte of each static child, in children order
+    std::vector<std::unique_ptr<Node>> children;
+    std::unique_ptr<Node> param;     // {name}
+    std::unique_ptr<Node> wildcard;  // {*name}
+    std::string name;                // Capture name, for param and wildcard nodes
+    std::vector<std::pair<std::string, RouteHandler>> methods;
+    ResponsePtr method_not_allowed;  // Rebuilt as methods are added
+};
+
+namespace {
+
+using Node = RadixRouter::Node;
+
+[[noreturn]] void invalid(std::string_view pattern, const char* reason) {
+    throw std::invalid_argument("route " + std::string(pattern) + ": " + reason);
+}
+
+size_t common_prefix(std::string_view a, std::string_view b) {
+    size_t n = 0;
+    while (n < a.size() && n < b.size() && a[n] == b[n]) ++n;
+    return n;
+}
+
+// Descend along text from node, splitting edges where text diverges from
+// them, and return the node that ends exactly at text
+Node* insert_static(Node* node, std::string_view text) {
+    while (!text.empty()) {
+        size_t index = node->indices.find(text.front());
+        if (index == std::string::npos) {
+            auto child = std::make_unique<Node>();
+            child->prefix.assign(text);
+            node->indices += text.front();
+            node->children.push_back(std::move(child));
+            return node->children.back().get();
+        }
+        std::unique_ptr<Node>& child = node->children[index];
+        size_t common = common_prefix(child->prefix, text);
+        if (common < child->prefix.size()) {
+            auto split = std::make_unique<Node>();
+            split->prefix = child->prefix.substr(0, common);
+            child->prefix.erase(0, common);
+            split->indices += child->prefix.front();
+            split->children.push_back(std::move(child));
+            child = std::move(split);
+        }
+        node = child.get();
+        text.remove_prefix(common);
+    }
+    return node;
+}
+
+Node* insert_capture(std::unique_ptr<Node>& slot, std::string_view name, std::string_view pattern) {
+    if (!slot) {
+        slot = std::make_unique<Node>();
+        slot->name.assign(name);
+    } else if (slot->name != name) {
+        invalid(pattern, "conflicts with a capture of another name at the same position");
+    }
+    return slot.get();
+}
+
+const RouteHandler* find_method(const Node& node, std::string_view method) {
+    for (const auto& entry : node.methods) {
+        if (entry.first == method) return &entry.second;
+    }
+    return nullptr;
+}
+
+ResponsePtr make_method_not_allowed(const Node& node) {
+    Response resp;
+    resp.status = "405 Method Not Allowed";
+    resp.content_type = "application/json";
+    resp.body = "{\"error\":\"Method not allowed\"}\n";
+    bool implicit_head = !find_method(node, "HEAD");
+    for (const auto& entry : node.methods) {
+        if (!resp.allow.empty()) resp.allow += ", ";
+        resp.allow += entry.first;
+        if (implicit_head && entry.first == "GET") resp.allow += ", HEAD";
+    }
+    return make_response(std::move(resp));
+}
+
+}  // namespace
+
+RadixRouter::RadixRouter() : root_(std::make_unique<Node>()) {}
+RadixRouter::~RadixRouter() = default;
+RadixRouter::RadixRouter(RadixRouter&&) noexcept = default;
+RadixRouter& RadixRouter::operator=(RadixRouter&&) noexcept = default;
+
+void RadixRouter::add(std::string_view method, std::string_view pattern, RouteHandler handler) {
+    if (pattern.empty() || pattern.front() != '/') {
+        invalid(pattern, "must start with '/'");
+    }
+    if (method.empty()) {
+        invalid(pattern, "empty method");
+    }
+
+    Node* node = root_.get();
+    size_t captures = 0;
+    size_t i = 0;
+    while (i < pattern.size()) {
+        if (pattern[i] != '{') {
+            size_t open = pattern.find('{', i);
+            std::string_view text = pattern.substr(i, open == std::string_view::npos ? open : open - i);
+            if (text.find('}') != std::string_view::npos) {
+                invalid(pattern, "unmatched '}'");
+            }
+            node = insert_static(node, text);
+            i += text.size();
+            continue;
+        }
+
+        size_t close = pattern.find('}', i);
+        if (close == std::string_view::npos) {
+            invalid(pattern, "unmatched '{'");
+        }
+        if (pattern[i - 1] != '/' || (close + 1 < pattern.size() && pattern[close + 1] != '/')) {
+            invalid(pattern, "a capture must span a whole segment");
+        }
+        std::string_view name = pattern.substr(i + 1, close - i - 1);
+        bool wildcard = !name.empty() && name.front() == '*';
+        if (wildcard) {
+            name.remove_prefix(1);
+            if (close + 1 != pattern.size()) {
+                invalid(pattern, "{*name} must end the pattern");
+            }
+        }
+        if (name.empty() || name.find_first_of("{}*/") != std::string_view::npos) {
+            invalid(pattern, "bad capture name");
+        }
+        if (++captures > MAX_ROUTE_PARAMS) {
+            invalid(pattern, "too many captures");
+        }
+        node = insert_capture(wildcard ? node->wildcard : node->param, name, pattern);
+        i = close + 1;
+    }
+
+    if (find_method(*node, method)) {
+        invalid(pattern, "already routed for this method");
+    }
+    node->methods.emplace_back(std::string(method), std::move(handler));
+    node->method_not_allowed = make_method_not_allowed(*node);
+    ++routes_;
+}
+
+// The node routing path, below a node whose prefix has been consumed.
+// Captures are appended to params; a failed branch rolls its own back.
+const RadixRouter::Node* RadixRouter::match(const Node& node, std::string_view path, RouteParams& params) {
+    if (path.empty()) {
+        if (!node.methods.empty()) return &node;
+        if (node.wildcard) {
+            params.push(node.wildcard->name, path);
+            return node.wildcard.get();
+        }
+        return nullptr;
+    }
+
+    size_t index = node.indices.find(path.front());
+    if (index != std::string::npos) {
+        const Node& child = *node.children[index];
+        if (path.compare(0, child.prefix.size(), child.prefix) == 0) {
+            if (const Node* found = match(child, path.substr(child.prefix.size()), params)) {
+                return found;
+            }
+        }
+    }
+
+    if (node.param) {
+        std::string_view segment = path.substr(0, path.find('/'));
+        if (!segment.empty()) {
+            size_t mark = params.size_;
+            params.push(node.param->name, segment);
+            if (const Node* found = match(*node.param, path.substr(segment.size()), params)) {
+                return found;
+            }
+            params.size_ = mark;
+        }
+    }
+
+    if (node.wildcard) {
+        params.push(node.wildcard->name, path);
+        return node.wildcard.get();
+    }
+    return nullptr;
+}
+
+RouteMatch RadixRouter::find(std::string_view method, std::string_view path) const {
+    RouteMatch result;
+    const Node* node = match(*root_, path, result.params);
+    if (!node) {
+        return result;
+    }
+    result.handler = find_method(*node, method);
+    if (!result.handler && method == "HEAD") {
+        // HEAD is served wherever GET is; the session drops the body
+        result.handler = find_method(*node, "GET");
+    }
+    if (result.handler) {
+        return result;
+    }
+    result.method_not_allowed = &node->method_not_allowed;
+    return result;
+}
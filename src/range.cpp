@@ -0,0 +1,192 @@
+#include "range.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include "http_date.hpp"
+#include "http_parser.hpp"
+
+namespace {
+
+// Non-empty run of digits that fits in 63 bits
+bool parse_position(std::string_view text, std::uint64_t& out) {
+    if (text.empty() || text.size() > 18) return false;
+    out = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') return false;
+        out = out * 10 + static_cast<std::uint64_t>(c - '0');
+    }
+    return true;
+}
+
+std::string content_range(std::uint64_t first, std::uint64_t last, std::uint64_t size) {
+    char value[80];
+    int n = std::snprintf(value, sizeof(value), "bytes %llu-%llu/%llu", static_cast<unsigned long long>(first),
+                          static_cast<unsigned long long>(last), static_cast<unsigned long long>(size));
+    return std::string(value, static_cast<size_t>(n));
+}
+
+// Random per response, so it can't be predicted and planted in a file
+std::string make_boundary() {
+    thread_local std::mt19937_64 rng{std::random_device{}()};
+    char boundary[40];
+    int n = std::snprintf(boundary, sizeof(boundary), "tez-%016llx%016llx", static_cast<unsigned long long>(rng()),
+                          static_cast<unsigned long long>(rng()));
+    return std::string(boundary, static_cast<size_t>(n));
+}
+
+}  // namespace
+
+RangeResult parse_byte_ranges(std::string_view header, std::uint64_t size, std::vector<ByteRange>& ranges) {
+    ranges.clear();
+    header = trim(header);
+    size_t equals = header.find('=');
+    if (equals == std::string_view::npos) return RangeResult::Ignore;
+    std::string_view unit = trim(header.substr(0, equals));
+    if (unit.size() != 5 || !std::equal(unit.begin(), unit.end(), "bytes", [](char a, char b) {
+            return (a | 0x20) == b;
+        })) {
+        return RangeResult::Ignore;  // Only byte ranges exist
+    }
+
+    std::string_view list = header.substr(equals + 1);
+    size_t specs = 0;
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        std::string_view spec = trim(list.substr(0, comma));
+        list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+        if (spec.empty()) continue;  // Empty list elements are allowed
+        if (++specs > MAX_BYTE_RANGES) return RangeResult::Ignore;
+
+        size_t dash = spec.find('-');
+        if (dash == std::string_view::npos) return RangeResult::Ignore;
+        std::uint64_t first = 0;
+        std::uint64_t last = 0;
+        if (dash == 0) {
+            // Suffix range: the final N bytes
+            if (!parse_position(spec.substr(1), last)) return RangeResult::Ignore;
+            if (last == 0 || size == 0) continue;
+            ranges.push_back({size > last ? size - last : 0, size - 1});
+            continue;
+        }
+        if (!parse_position(spec.substr(0, dash), first)) return RangeResult::Ignore;
+        std::string_view last_text = spec.substr(dash + 1);
+        if (last_text.empty()) {
+            last = UINT64_MAX;
+        } else if (!parse_position(last_text, last) || last < first) {
+            return RangeResult::Ignore;
+        }
+        if (first >= size) continue;  // Starts past the end
+        ranges.push_back({first, std::min(last, size - 1)});
+    }
+    if (specs == 0) return RangeResult::Ignore;
+    if (ranges.empty()) return RangeResult::Unsatisfiable;
+
+    std::sort(ranges.begin(), ranges.end(), [](const ByteRange& a, const ByteRange& b) { return a.first < b.first; });
+    size_t merged = 0;
+    for (size_t i = 1; i < ranges.size(); ++i) {
+        if (ranges[i].first <= ranges[merged].last + 1) {
+            ranges[merged].last = std::max(ranges[merged].last, ranges[i].last);
+        } else {
+            ranges[++merged] = ranges[i];
+        }
+    }
+    ranges.resize(merged + 1);
+    return RangeResult::Satisfiable;
+}
+
+bool if_range_matches(const Response& response, const std::string* if_range) {
+    if (!if_range) return true;
+    std::string_view value = trim(*if_range);
+    if (value.substr(0, 2) == "W/") return false;  // Weak tags never match
+    if (!value.empty() && value.front() == '"') {
+        return !response.etag.empty() && value == response.etag;
+    }
+    std::time_t date = 0;
+    return response.last_modified > 0 && parse_http_date(value, date) && date == response.last_modified;
+}
+
+ResponsePtr make_range_response(const Response& full, const std::vector<ByteRange>& ranges) {
+    std::uint64_t size = full.file ? full.file->length : full.body.size();
+    std::uint64_t base = full.file ? full.file->offset : 0;
+
+    Response partial;
+    partial.status = "206 Partial Content";
+    partial.content_encoding = full.content_encoding;
+    partial.vary_accept_encoding = full.vary_accept_encoding;
+    partial.etag = full.etag;
+    partial.last_modified = full.last_modified;
+    partial.cache_control = full.cache_control;
+    partial.accept_ranges = true;
+
+    if (ranges.size() == 1) {
+        const ByteRange& range = ranges.front();
+        partial.content_type = full.content_type;
+        partial.content_range = content_range(range.first, range.last, size);
+        if (full.file) {
+            partial.file = FileBody{full.file->path, base + range.first, range.length(), {}, {}};
+        } else {
+            partial.body = full.body.substr(static_cast<size_t>(range.first), static_cast<size_t>(range.length()));
+        }
+        return make_response(std::move(partial));
+    }
+
+    // multipart/byteranges (RFC 9110 14.6): the CRLF before each delimiter
+    // belongs to the delimiter
+    std::string boundary = make_boundary();
+    partial.content_type = "multipart/byteranges; boundary=" + boundary;
+    FileBody file;
+    std::uint64_t total = 0;
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        const ByteRange& range = ranges[i];
+        std::string prefix = i == 0 ? "--" : "\r\n--";
+        prefix += boundary;
+        prefix += "\r\nContent-Type: ";
+        prefix += full.content_type;
+        prefix += "\r\nContent-Range: ";
+        prefix += content_range(range.first, range.last, size);
+        prefix += "\r\n\r\n";
+        if (full.file) {
+            total += prefix.size() + range.length();
+            file.segments.push_back({std::move(prefix), base + range.first, range.length()});
+        } else {
+            partial.body += prefix;
+            partial.body.append(full.body, static_cast<size_t>(range.first), static_cast<size_t>(range.length()));
+        }
+    }
+    std::string trailer = "\r\n--" + boundary + "--\r\n";
+    if (full.file) {
+        file.path = full.file->path;
+        file.length = total + trailer.size();
+        file.trailer = std::move(trailer);
+        partial.file = std::move(file);
+    } else {
+        partial.body += trailer;
+    }
+    return make_response(std::move(partial));
+}
+
+ResponsePtr make_unsatisfiable_response(std::uint64_t size) {
+    Response resp;
+    resp.status = "416 Range Not Satisfiable";
+    resp.content_type = "text/plain; charset=utf-8";
+    resp.body = "Requested range not satisfiable.\r\n";
+    resp.content_range = "bytes */" + std::to_string(size);
+    return make_response(std::move(resp));
+}
+
+ResponsePtr apply_range(const ResponsePtr& response, const std::string* range, const std::string* if_range) {
+    if (!range || !response->accept_ranges || !if_range_matches(*response, if_range)) {
+        return response;
+    }
+    std::uint64_t size = response->file ? response->file->length : response->body.size();
+    std::vector<ByteRange> ranges;
+    switch (parse_byte_ranges(*range, size, ranges)) {
+        case RangeResult::Satisfiable:
+            return make_range_response(*response, ranges);
+        case RangeResult::Unsatisfiable:
+            return make_unsatisfiable_response(size);
+        case RangeResult::Ignore:
+            break;
+    }
+    return response;
+}
@@ -0,0 +1,82 @@
+#include "reactor.hpp"
+#include <iostream>
+#include <memory>
+#include "session.hpp"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using boost::asio::ip::tcp;
+namespace asio = boost::asio;
+
+namespace {
+
+void pin_current_thread(int cpu) {
+#ifdef __linux__
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu, &cpuset);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) != 0) {
+        std::cerr << "Warning: could not pin reactor to core " << cpu << "\n";
+    }
+#else
+    (void)cpu;  // Affinity is not portable; run unpinned elsewhere
+#endif
+}
+
+}  // namespace
+
+// io_context concurrency hint of 1: only this reactor's thread ever runs it
+Reactor::Reactor(unsigned short port, int cpu) : io_(1), acceptor_(io_), cpu_(cpu) {
+    tcp::endpoint endpoint(tcp::v4(), port);
+    acceptor_.open(endpoint.protocol());
+    acceptor_.set_option(asio::socket_base::reuse_address(true));
+#ifdef SO_REUSEPORT
+    acceptor_.set_option(asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true));
+#endif
+    acceptor_.bind(endpoint);
+    acceptor_.listen();
+}
+
+Reactor::~Reactor() {
+    stop();
+    join();
+}
+
+void Reactor::start() {
+    do_accept();
+    thread_ = std::thread([this]() {
+        if (cpu_ >= 0) {
+            pin_current_thread(cpu_);
+        }
+        io_.run();
+    });
+}
+
+void Reactor::stop() {
+    // Close the acceptor on the reactor's own thread, then stop the loop
+    asio::post(io_, [this]() {
+        boost::system::error_code ignored_ec;
+        acceptor_.close(ignored_ec);
+        io_.stop();
+    });
+}
+
+void Reactor::join() {
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void Reactor::do_accept() {
+    acceptor_.async_accept([this](boost::system::error_code ec, tcp::socket socket) {
+        if (!ec) {
+            std::make_shared<Session>(std::move(socket))->start();
+        }
+        if (ec != asio::error::operation_aborted) {
+            do_accept();
+        }
+    });
+}
@@ -52,7 +52,7 @@ Request parse_request(const std::string& raw_request) {
                 return std::tolower(c);
             });
 
-            req.headers[key] = value;
+            req.headers.set(key, value);
         }
     }
 
@@ -63,11 +63,11 @@ Request parse_request(const std::string& raw_request) {
     return req;
 }
 
-int get_content_length(const std::unordered_map<std::string, std::string>& headers) {
-    auto it = headers.find("content-length");
-    if (it != headers.end()) {
+int get_content_length(const HeaderMap& headers) {
+    const std::string* value = headers.get(HeaderId::ContentLength);
+    if (value) {
         try {
-            return std::stoi(it->second);
+            return std::stoi(*value);
         } catch (...) {
             return 0;
         }
@@ -0,0 +1,136 @@
+#include "response.hpp"
+#include <string_view>
+#include "http_date.hpp"
+#include "http_parser.hpp"
+
+namespace {
+
+// The lines a 304 repeats from the 200 it stands for (RFC 9110 15.4.5)
+void append_validator_lines(std::string& out, const Response& response) {
+    if (response.vary_accept_encoding) {
+        out += "Vary: Accept-Encoding\r\n";
+    }
+    if (!response.etag.empty()) {
+        out += "ETag: ";
+        out += response.etag;
+        out += "\r\n";
+    }
+    if (response.last_modified > 0) {
+        char date[HTTP_DATE_LENGTH];
+        format_http_date(response.last_modified, date);
+        out += "Last-Modified: ";
+        out.append(date, HTTP_DATE_LENGTH);
+        out += "\r\n";
+    }
+    if (!response.cache_control.empty()) {
+        out += "Cache-Control: ";
+        out += response.cache_control;
+        out += "\r\n";
+    }
+}
+
+std::string_view opaque_tag(std::string_view tag) {
+    if (tag.substr(0, 2) == "W/") tag.remove_prefix(2);
+    return tag;
+}
+
+// Weak comparison of an If-None-Match list against one entity tag
+bool etag_list_matches(std::string_view list, std::string_view etag) {
+    etag = opaque_tag(etag);
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        std::string_view candidate = trim(list.substr(0, comma));
+        list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+        if (candidate == "*" || opaque_tag(candidate) == etag) return true;
+    }
+    return false;
+}
+
+class GeneratorStream : public BodyStream {
+public:
+    explicit GeneratorStream(std::function<bool(std::string&)> next) : next_(std::move(next)) {}
+
+    Status pull(std::string& out) override {
+        return next_(out) ? Status::Data : Status::Done;
+    }
+
+private:
+    std::function<bool(std::string&)> next_;
+};
+
+}  // namespace
+
+std::shared_ptr<BodyStream> make_generator_stream(std::function<bool(std::string& out)> next) {
+    return std::make_shared<GeneratorStream>(std::move(next));
+}
+
+void append_response_head(std::string& out, const Response& response) {
+    std::uint64_t body_size = response.file ? response.file->length : response.body.size();
+    out += "HTTP/1.1 ";
+    out += response.status;
+    out += "\r\nContent-Type: ";
+    out += response.content_type;
+    out += "\r\n";
+    if (!response.content_encoding.empty()) {
+        out += "Content-Encoding: ";
+        out += response.content_encoding;
+        out += "\r\n";
+    }
+    if (!response.content_range.empty()) {
+        out += "Content-Range: ";
+        out += response.content_range;
+        out += "\r\n";
+    }
+    if (response.accept_ranges) {
+        out += "Accept-Ranges: bytes\r\n";
+    }
+    if (!response.allow.empty()) {
+        out += "Allow: ";
+        out += response.allow;
+        out += "\r\n";
+    }
+    append_validator_lines(out, response);
+    out += "Server: Tez\r\n";
+    if (!response.stream) {
+        out += "Content-Length: ";
+        out += std::to_string(body_size);
+        out += "\r\n";
+    }
+}
+
+ResponsePtr make_response(std::string status, std::string content_type, std::string body) {
+    Response response;
+    response.status = std::move(status);
+    response.content_type = std::move(content_type);
+    response.body = std::move(body);
+    return make_response(std::move(response));
+}
+
+ResponsePtr make_response(Response response) {
+    // Room for a typical head, so it is built with one allocation
+    response.head.clear();
+    response.head.reserve(256);
+    append_response_head(response.head, response);
+    response.not_modified_head.clear();
+    if (!response.etag.empty() || response.last_modified > 0) {
+        response.not_modified_head = "HTTP/1.1 304 Not Modified\r\n";
+        append_validator_lines(response.not_modified_head, response);
+        response.not_modified_head += "Server: Tez\r\n";
+    }
+    return std::make_shared<const Response>(std::move(response));
+}
+
+bool is_not_modified(const Response& response, const std::string* if_none_match,
+                     const std::string* if_modified_since) {
+    if (response.not_modified_head.empty()) {
+        return false;
+    }
+    if (if_none_match) {
+        return !response.etag.empty() && etag_list_matches(*if_none_match, response.etag);
+    }
+    if (if_modified_since && response.last_modified > 0) {
+        std::time_t since = 0;
+        return parse_http_date(*if_modified_since, since) && response.last_modified <= since;
+    }
+    return false;
+}
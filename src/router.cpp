@@ -1,155 +1,339 @@
 #include "router.hpp"
+#include <atomic>
+#include <filesystem>
 #include <iostream>
+#include <iterator>
 #include <fstream>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 #include <nlohmann/json.hpp>
+#include "file_server.hpp"
+#include "file_watcher.hpp"
+#include "metrics.hpp"
 #include "middleware.hpp"
+#include "middleware_chain.hpp"
+#include "server_config.hpp"
 
-// Global configuration loaded at startup
-static nlohmann::json g_config;
-static std::mutex g_config_mutex;
-static bool g_config_loaded = false;
+// "METHOD /path" -> handler; filled before serving, read-only afterwards
+static std::unordered_map<std::string, StreamingHandler> g_streaming_routes;
+
+namespace {
+
+// Only keys that look like paths are routes ("server" holds settings).
+// Each becomes a GET route (patterns like "/docs/{*page}" work too) whose
+// response is built here, once. Throws on an entry that isn't
+// {status, content_type, body} strings or whose path isn't a valid pattern.
+std::shared_ptr<const RadixRouter> compile_routes(const nlohmann::json& config) {
+    if (!config.is_object()) {
+        throw std::runtime_error("top level is not an object");
+    }
+    auto table = std::make_shared<RadixRouter>();
+    for (const auto& [path, route] : config.items()) {
+        if (path.empty() || path[0] != '/') {
+            continue;
+        }
+        Response resp;
+        try {
+            resp.status = route.at("status").get<std::string>();
+            resp.content_type = route.at("content_type").get<std::string>();
+            resp.body = route.at("body").get<std::string>();
+        } catch (const std::exception& e) {
+            throw std::runtime_error("route " + path + ": " + e.what());
+        }
+        table->add("GET", path, [shared = make_response(std::move(resp))](const Request&, const RouteParams&) {
+            return shared;
+        });
+    }
+    return table;
+}
+
+// The published table. Replaced whole with std::atomic_store; the
+// generation is bumped after each store so readers can tell their
+// thread's copy is stale with one atomic load instead of a refcount bump.
+std::shared_ptr<const RadixRouter> g_routes = std::make_shared<const RadixRouter>();
+std::atomic<std::uint64_t> g_routes_generation{0};
+
+std::mutex g_reload_mutex;  // Serializes writers only
+bool g_config_loaded = false;
+
+FileWatcher g_config_watcher;
+
+const RadixRouter& current_routes() {
+    thread_local std::shared_ptr<const RadixRouter> table;
+    thread_local std::uint64_t seen = UINT64_MAX;
+    std::uint64_t generation = g_routes_generation.load(std::memory_order_acquire);
+    if (generation != seen) {
+        table = std::atomic_load(&g_routes);
+        seen = generation;
+    }
+    return *table;
+}
+
+void publish_routes(std::shared_ptr<const RadixRouter> table) {
+    std::atomic_store(&g_routes, std::move(table));
+    g_routes_generation.fetch_add(1, std::memory_order_release);
+    // Responses cache_middleware kept may come from the old routes
+    clear_response_cache();
+}
+
+// POST/PUT /upload: counts the body without keeping it
+class CountingSink : public BodySink {
+public:
+    Flow on_data(std::string_view data) override {
+        bytes_ += data.size();
+        return Flow::Continue;
+    }
+
+    ResponsePtr on_end() override {
+        nlohmann::json response_json;
+        response_json["bytes_received"] = bytes_;
+        return make_response("200 OK", "application/json", response_json.dump() + "\n");
+    }
+
+private:
+    std::uint64_t bytes_ = 0;
+};
+
+std::unique_ptr<BodySink> make_counting_sink(const Request&, BodyResume) {
+    return std::make_unique<CountingSink>();
+}
+
+}  // namespace
+
+void add_streaming_route(const std::string& method, const std::string& path, StreamingHandler handler) {
+    g_streaming_routes[method + " " + path] = std::move(handler);
+}
+
+const StreamingHandler* find_streaming_route(std::string_view method, std::string_view path) {
+    if (g_streaming_routes.empty()) {
+        return nullptr;
+    }
+    // Built in a per-thread buffer so the lookup doesn't allocate
+    thread_local std::string key;
+    key.assign(method).append(" ").append(path);
+    auto it = g_streaming_routes.find(key);
+    return it != g_streaming_routes.end() ? &it->second : nullptr;
+}
 
 // Initialize router configuration (called once at startup)
 void init_router_config() {
-    std::lock_guard<std::mutex> lock(g_config_mutex);
+    std::lock_guard<std::mutex> lock(g_reload_mutex);
 
     if (g_config_loaded) {
         return;  // Already loaded
     }
+    g_config_loaded = true;
 
+    add_streaming_route("POST", "/upload", make_counting_sink);
+    add_streaming_route("PUT", "/upload", make_counting_sink);
+
+    std::string path = config_path();
+    std::ifstream config_file(path);
+    if (!config_file) {
+        std::cerr << "Warning: config.json not found, using defaults\n";
+        return;
+    }
     try {
-        std::ifstream config_file("../config.json");  // From build/ directory
-        if (config_file) {
-            config_file >> g_config;
-            g_config_loaded = true;
-            std::cout << "Router configuration loaded successfully\n";
-        } else {
-            std::cerr << "Warning: config.json not found, using defaults\n";
-            g_config = nlohmann::json::object();
-            g_config_loaded = true;
-        }
+        nlohmann::json config;
+        config_file >> config;
+        publish_routes(compile_routes(config));
+        std::cout << "Router configuration loaded successfully\n";
     } catch (const std::exception& e) {
         std::cerr << "Error loading config.json: " << e.what() << "\n";
         std::cerr << "Using empty configuration\n";
-        g_config = nlohmann::json::object();
-        g_config_loaded = true;
     }
 }
 
-Response handle_route(const std::string& path) {
-    if (path == "/health") {
-        Response resp;
-        resp.status = "200 OK";
-        resp.content_type = "application/json";
-        resp.body = "{\"status\":\"ok\"}\n";
-        return resp;
+bool load_router_config(const std::string& path) {
+    std::lock_guard<std::mutex> lock(g_reload_mutex);
+    std::shared_ptr<const RadixRouter> table;
+    try {
+        std::ifstream config_file(path);
+        if (!config_file) {
+            throw std::runtime_error("cannot open file");
+        }
+        nlohmann::json config;
+        config_file >> config;
+        table = compile_routes(config);
+    } catch (const std::exception& e) {
+        std::cerr << "Error reloading " << path << ": " << e.what() << "\n";
+        std::cerr << "Keeping the current routes\n";
+        return false;
     }
+    size_t count = table->size();
+    publish_routes(std::move(table));
+    std::cout << "Router configuration reloaded (" << count << " routes)\n";
+    return true;
+}
+
+bool reload_router_config() {
+    return load_router_config(config_path());
+}
 
-    Response cached = get_cached_response(path);
-    if(!cached.body.empty()){
-        return cached;
+bool start_config_watcher() {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    fs::path path = fs::absolute(config_path(), ec);
+    if (ec) {
+        return false;
     }
+    // Watch the directory rather than the file: editors and deploys often
+    // replace the file by renaming a new one over it
+    std::string name = path.filename().string();
+    return g_config_watcher.start(
+        path.parent_path().string(),
+        [name](const std::string& changed) {
+            if (changed.empty() || changed == name) {
+                reload_router_config();
+            }
+        },
+        WatchOptions{false, true});
+}
+
+void stop_config_watcher() {
+    g_config_watcher.stop();
+}
+
+// Built once and shared by every /health response
+static ResponsePtr health_response() {
+    static const ResponsePtr resp = make_response(
+        "200 OK", "application/json", "{\"status\":\"ok\"}\n");
+    return resp;
+}
 
+// Rendered per scrape and never cached
+static ResponsePtr metrics_page(const Request&, const RouteParams&) {
     Response resp;
+    resp.status = "200 OK";
+    resp.content_type = "text/plain; version=0.0.4; charset=utf-8";
+    resp.body = render_metrics();
+    resp.cache_control = "no-store";
+    return make_response(std::move(resp));
+}
 
-    try {
-        // Thread-safe read access to global config
-        std::lock_guard<std::mutex> lock(g_config_mutex);
+static const ResponsePtr& not_found_response() {
+    static const ResponsePtr resp = make_response(
+        "404 Not Found", "text/html; charset=utf-8",
+        "<html><head><title>404</title></head><body><h1>Page Not Found</h1></body></html>");
+    return resp;
+}
 
-        if (!g_config_loaded) {
-            throw std::runtime_error("Configuration not loaded");
-        }
+static ResponsePtr echo(const Request& request, const RouteParams&) {
+    nlohmann::json response_json;
+    response_json["method"] = request.method;
+    response_json["received_body"] = request.body;
+    response_json["body_length"] = request.body.length();
+    return make_response("200 OK", "application/json", response_json.dump(2) + "\n");
+}
 
-        if (g_config.contains(path)) {
-            resp.status = g_config[path]["status"];
-            resp.content_type = g_config[path]["content_type"];
-            resp.body = g_config[path]["body"];
-        } else {
-            resp.status = "404 Not Found";
-            resp.content_type = "text/html; charset=utf-8";
-            resp.body = "<html><head><title>404</title></head><body><h1>Page Not Found</h1></body></html>";
-        }
-    } catch(const std::exception& e) {
-        std::cerr << "Error handling route: " << e.what() << "\n";
-        resp.status = "500 Internal Server Error";
-        resp.content_type = "text/plain";
-        resp.body = "Internal server error.\n";
+static ResponsePtr list_data(const Request&, const RouteParams&) {
+    static const ResponsePtr resp = make_response(
+        "200 OK", "application/json", "{\"data\":[\"item1\",\"item2\",\"item3\"]}\n");
+    return resp;
+}
+
+static ResponsePtr create_data(const Request& request, const RouteParams&) {
+    nlohmann::json response_json;
+    response_json["message"] = "Resource created";
+    response_json["received"] = request.body;
+    return make_response("201 Created", "application/json", response_json.dump(2) + "\n");
+}
+
+static ResponsePtr update_data(const Request& request, const RouteParams&) {
+    nlohmann::json response_json;
+    response_json["message"] = "Resource updated";
+    response_json["received"] = request.body;
+    return make_response("200 OK", "application/json", response_json.dump(2) + "\n");
+}
+
+static ResponsePtr delete_data(const Request&, const RouteParams& params) {
+    nlohmann::json response_json;
+    response_json["message"] = "Resource deleted";
+    if (std::string_view id = params.get("id"); !id.empty()) {
+        response_json["id"] = id;
     }
+    return make_response("200 OK", "application/json", response_json.dump() + "\n");
+}
 
-    cache_response(path, resp);
-    return resp;
+static ResponsePtr get_data_item(const Request&, const RouteParams& params) {
+    nlohmann::json response_json;
+    response_json["id"] = params.get("id");
+    return make_response("200 OK", "application/json", response_json.dump() + "\n");
 }
 
-Response handle_route_with_method(const std::string& method, const std::string& path, const std::string& body) {
+// Streamed variant of /api/data: one NDJSON line per chunk, each sent as
+// soon as it is produced
+static ResponsePtr stream_data(const Request&, const RouteParams&) {
+    static const char* const ITEMS[] = {"item1", "item2", "item3"};
     Response resp;
+    resp.status = "200 OK";
+    resp.content_type = "application/x-ndjson";
+    resp.stream = make_generator_stream([next = size_t(0)](std::string& out) mutable {
+        out += "{\"data\":\"";
+        out += ITEMS[next];
+        out += "\"}\n";
+        return ++next < std::size(ITEMS);
+    });
+    return make_response(std::move(resp));
+}
 
-    // Health endpoint - always GET
-    if (path == "/health") {
-        if (method != "GET") {
-            resp.status = "405 Method Not Allowed";
-            resp.content_type = "application/json";
-            resp.body = "{\"error\":\"Method not allowed\"}\n";
-            return resp;
-        }
-        resp.status = "200 OK";
-        resp.content_type = "application/json";
-        resp.body = "{\"status\":\"ok\"}\n";
-        return resp;
-    }
+static ResponsePtr static_file(const Request& request, const RouteParams&) {
+    const std::string* accept_encoding = request.headers.get(HeaderId::AcceptEncoding);
+    return serve_file(request.path, accept_encoding ? std::string_view(*accept_encoding) : std::string_view());
+}
 
-    // Echo endpoint for testing POST/PUT
-    if (path == "/echo" && (method == "POST" || method == "PUT")) {
-        resp.status = "200 OK";
-        resp.content_type = "application/json";
-        nlohmann::json response_json;
-        response_json["method"] = method;
-        response_json["received_body"] = body;
-        response_json["body_length"] = body.length();
-        resp.body = response_json.dump(2) + "\n";
-        return resp;
-    }
+// The routes registered in code: the built-ins, then add_route(). Filled
+// before serving and read-only afterwards; config routes live in their own
+// reloadable tree.
+static RadixRouter& handler_routes() {
+    static RadixRouter routes = []() {
+        RadixRouter r;
+        r.add("GET", "/health", [](const Request&, const RouteParams&) { return health_response(); });
+        r.add("GET", "/metrics", metrics_page);
+        r.add("POST", "/echo", echo);
+        r.add("PUT", "/echo", echo);
+        r.add("GET", "/api/data", list_data);
+        r.add("POST", "/api/data", create_data);
+        r.add("PUT", "/api/data", update_data);
+        r.add("DELETE", "/api/data", delete_data);
+        r.add("GET", "/api/data/{id}", get_data_item);
+        r.add("DELETE", "/api/data/{id}", delete_data);
+        r.add("GET", "/api/stream", stream_data);
+        r.add("GET", "/static/{*path}", static_file);
+        return r;
+    }();
+    return routes;
+}
 
-    // API endpoint for RESTful operations
-    if (path == "/api/data") {
-        if (method == "GET") {
-            resp.status = "200 OK";
-            resp.content_type = "application/json";
-            resp.body = "{\"data\":[\"item1\",\"item2\",\"item3\"]}\n";
-        } else if (method == "POST") {
-            resp.status = "201 Created";
-            resp.content_type = "application/json";
-            nlohmann::json response_json;
-            response_json["message"] = "Resource created";
-            response_json["received"] = body;
-            resp.body = response_json.dump(2) + "\n";
-        } else if (method == "PUT") {
-            resp.status = "200 OK";
-            resp.content_type = "application/json";
-            nlohmann::json response_json;
-            response_json["message"] = "Resource updated";
-            response_json["received"] = body;
-            resp.body = response_json.dump(2) + "\n";
-        } else if (method == "DELETE") {
-            resp.status = "200 OK";
-            resp.content_type = "application/json";
-            resp.body = "{\"message\":\"Resource deleted\"}\n";
-        } else {
-            resp.status = "405 Method Not Allowed";
-            resp.content_type = "application/json";
-            resp.body = "{\"error\":\"Method not allowed\"}\n";
-        }
-        return resp;
-    }
+// Outermost first; filled before serving, read-only afterwards
+static std::vector<Middleware> g_middleware;
+
+void add_route(const std::string& method, const std::string& pattern, RouteHandler handler) {
+    handler_routes().add(method, pattern, std::move(handler));
+}
+
+void add_middleware(Middleware middleware) {
+    g_middleware.push_back(middleware);
+}
 
-    // For GET requests, fall back to config-based routing
-    if (method == "GET") {
-        return handle_route(path);
+void clear_middleware() {
+    g_middleware.clear();
+}
+
+ResponsePtr route_request(const Request& request) {
+    RouteMatch match = handler_routes().find(request.method, request.path);
+    if (!match.handler && !match.method_not_allowed) {
+        match = current_routes().find(request.method, request.path);
     }
+    RouteTarget target{match.handler, &match.params,
+                       match.method_not_allowed ? match.method_not_allowed : &not_found_response()};
+    return run_chain(g_middleware, request, target);
+}
 
-    // Method not supported for this path
-    resp.status = "405 Method Not Allowed";
-    resp.content_type = "text/plain";
-    resp.body = "Method not allowed for this path\n";
-    return resp;
-}
\ No newline at end of file
+ResponsePtr handle_route(const std::string& path) {
+    Request request;
+    request.method = "GET";
+    request.path = path;
+    return route_request(request);
+}
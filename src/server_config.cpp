@@ -0,0 +1,145 @@
+#include "server_config.hpp"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+
+namespace {
+
+EvictionPolicy parse_policy(const std::string& name, bool& admission) {
+    admission = false;
+    if (name == "lru") return EvictionPolicy::Lru;
+    if (name == "clock") return EvictionPolicy::Clock;
+    if (name == "tinylfu") {
+        admission = true;
+        return EvictionPolicy::Clock;
+    }
+    throw std::invalid_argument("unknown cache policy \"" + name + "\"");
+}
+
+void load_cache_options(const nlohmann::json& json, CacheOptions& options) {
+    if (!json.is_object()) return;
+    options.max_entries = json.value("max_entries", options.max_entries);
+    options.max_bytes = json.value("max_bytes", options.max_bytes);
+    options.ttl_seconds = json.value("ttl_seconds", options.ttl_seconds);
+    options.shards = json.value("shards", options.shards);
+    if (json.contains("policy")) {
+        options.policy = parse_policy(json["policy"].get<std::string>(), options.admission);
+    }
+}
+
+void load_access_log_config(const nlohmann::json& json, AccessLogConfig& config) {
+    if (!json.is_object()) return;
+    config.enabled = json.value("enabled", config.enabled);
+    config.path = json.value("path", config.path);
+    config.flush_interval_ms = json.value("flush_interval_ms", config.flush_interval_ms);
+    config.ring_records = json.value("ring_records", config.ring_records);
+    config.max_bytes = json.value("max_bytes", config.max_bytes);
+    config.max_files = json.value("max_files", config.max_files);
+    if (json.contains("format")) {
+        std::string format = json["format"].get<std::string>();
+        if (format != "text" && format != "json") {
+            throw std::invalid_argument("unknown log format \"" + format + "\"");
+        }
+        config.json = format == "json";
+    }
+}
+
+void load_compression_options(const nlohmann::json& json, CompressionOptions& options) {
+    if (!json.is_object()) return;
+    options.enabled = json.value("enabled", options.enabled);
+    options.level = json.value("level", options.level);
+    options.min_bytes = json.value("min_bytes", options.min_bytes);
+    if (options.level < 1 || options.level > 9) {
+        throw std::invalid_argument("compression level must be between 1 and 9");
+    }
+}
+
+void load_cache_control(const nlohmann::json& json, std::unordered_map<std::string, std::string>& policies) {
+    if (!json.is_object()) return;
+    for (const auto& [key, value] : json.items()) {
+        if (key != "*" && (key.size() < 2 || key[0] != '.')) {
+            throw std::invalid_argument("cache_control keys must be extensions like \".css\" or \"*\"");
+        }
+        policies[key] = value.get<std::string>();
+    }
+}
+
+}  // namespace
+
+CacheOptions default_response_cache_options() {
+    CacheOptions options;
+    options.max_entries = 100;
+    options.max_bytes = 8 * 1024 * 1024;
+    return options;
+}
+
+CacheOptions default_file_cache_options() {
+    // Unlimited entries: the byte budget decides, and admission keeps a
+    // scan over many cold files from flushing the hot set. No TTL: the
+    // static watcher invalidates changed files.
+    CacheOptions options;
+    options.ttl_seconds = 0;
+    options.max_entries = 0;
+    options.max_bytes = 64 * 1024 * 1024;
+    options.admission = true;
+    return options;
+}
+
+std::string config_path() {
+    const char* env_path = std::getenv("TEZ_CONFIG");
+    if (env_path && *env_path) {
+        return env_path;
+    }
+    return "../config.json";  // From build/ directory
+}
+
+ServerConfig load_server_config(const std::string& path) {
+    ServerConfig config;
+
+    try {
+        std::ifstream config_file(path);
+        if (!config_file) {
+            return config;
+        }
+
+        nlohmann::json json;
+        config_file >> json;
+
+        if (json.contains("server") && json["server"].is_object()) {
+            const auto& server = json["server"];
+            config.port = server.value("port", config.port);
+            config.threads = server.value("threads", config.threads);
+            config.reactors = server.value("reactors", config.reactors);
+            config.pin_reactors = server.value("pin_reactors", config.pin_reactors);
+            config.sendfile_threshold = server.value("sendfile_threshold", config.sendfile_threshold);
+            config.watch_static = server.value("watch_static", config.watch_static);
+            config.watch_config = server.value("watch_config", config.watch_config);
+        }
+
+        if (json.contains("cache") && json["cache"].is_object()) {
+            const auto& cache = json["cache"];
+            if (cache.contains("response")) load_cache_options(cache["response"], config.response_cache);
+            if (cache.contains("file")) load_cache_options(cache["file"], config.file_cache);
+        }
+
+        if (json.contains("log")) {
+            load_access_log_config(json["log"], config.access_log);
+        }
+
+        if (json.contains("compression")) {
+            load_compression_options(json["compression"], config.compression);
+        }
+
+        if (json.contains("cache_control")) {
+            load_cache_control(json["cache_control"], config.cache_control);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error loading server settings: " << e.what() << "\n";
+        std::cerr << "Using default server settings\n";
+        return ServerConfig();
+    }
+
+    return config;
+}
@@ -0,0 +1,888 @@
+#include "session.hpp"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+#include "router.hpp"
+#include "middleware.hpp"
+#include "http_date.hpp"
+#include "access_log.hpp"
+#include "metrics.hpp"
+#include "range.hpp"
+
+using boost::asio::ip::tcp;
+namespace asio = boost::asio;
+
+namespace {
+
+const char BAD_REQUEST_RESPONSE[] = "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n";
+
+const char MALFORMED_REQUEST_RESPONSE[] = "HTTP/1.1 400 Bad Request\r\n"
+                                          "Content-Type: text/plain\r\n"
+                                          "Content-Length: 17\r\n"
+                                          "Connection: close\r\n\r\n"
+                                          "Malformed request";
+
+const char HEADERS_TOO_LARGE_RESPONSE[] = "HTTP/1.1 431 Request Header Fields Too Large\r\n"
+                                          "Content-Type: text/plain\r\n"
+                                          "Content-Length: 33\r\n"
+                                          "Connection: close\r\n\r\n"
+                                          "Request headers exceed size limit";
+
+const char INVALID_LENGTH_RESPONSE[] = "HTTP/1.1 400 Bad Request\r\n"
+                                       "Content-Type: text/plain\r\n"
+                                       "Content-Length: 22\r\n"
+                                       "Connection: close\r\n\r\n"
+                                       "Invalid Content-Length";
+
+const char PAYLOAD_TOO_LARGE_RESPONSE[] = "HTTP/1.1 413 Payload Too Large\r\n"
+                                          "Content-Type: text/plain\r\n"
+                                          "Content-Length: 41\r\n"
+                                          "Connection: close\r\n\r\n"
+                                          "Request body exceeds maximum allowed size";
+
+const char VERSION_NOT_SUPPORTED_RESPONSE[] = "HTTP/1.1 505 HTTP Version Not Supported\r\n"
+                                              "Content-Type: text/plain\r\n"
+                                              "Content-Length: 28\r\n"
+                                              "Connection: close\r\n\r\n"
+                                              "HTTP version not supported\r\n";
+
+const char MALFORMED_CHUNKED_RESPONSE[] = "HTTP/1.1 400 Bad Request\r\n"
+                                          "Content-Type: text/plain\r\n"
+                                          "Content-Length: 22\r\n"
+                                          "Connection: close\r\n\r\n"
+                                          "Malformed chunked body";
+
+const char UNSUPPORTED_TRANSFER_CODING_RESPONSE[] = "HTTP/1.1 501 Not Implemented\r\n"
+                                                    "Content-Type: text/plain\r\n"
+                                                    "Content-Length: 27\r\n"
+                                                    "Connection: close\r\n\r\n"
+                                                    "Unsupported transfer coding";
+
+const char INVALID_TRANSFER_CODING_RESPONSE[] = "HTTP/1.1 400 Bad Request\r\n"
+                                                "Content-Type: text/plain\r\n"
+                                                "Content-Length: 25\r\n"
+                                                "Connection: close\r\n\r\n"
+                                                "Invalid Transfer-Encoding";
+
+const char CONTINUE_RESPONSE[] = "HTTP/1.1 100 Continue\r\n\r\n";
+
+const char* parse_error_response(int status) {
+    switch (status) {
+        case 431: return HEADERS_TOO_LARGE_RESPONSE;
+        case 505: return VERSION_NOT_SUPPORTED_RESPONSE;
+        default: return MALFORMED_REQUEST_RESPONSE;
+    }
+}
+
+bool is_disconnect(const boost::system::error_code& ec) {
+    return ec == asio::error::eof || ec == asio::error::connection_reset ||
+           ec == asio::error::operation_aborted;
+}
+
+enum class Framing { None, Length, Chunked, BadLength, BadCoding, UnsupportedCoding };
+
+// How the body of a parsed head is delimited, judged from every
+// Content-Length and Transfer-Encoding field rather than the first of
+// each. Framing that a proxy in front could read differently (conflicting
+// lengths, a repeated coding, a length next to chunked) is refused: that
+// gap is what request smuggling exploits (RFC 9112 6.3).
+Framing body_framing(const RequestParser& parser, long long& content_length) {
+    const HeaderField* coding = nullptr;
+    bool has_length = false;
+    content_length = 0;
+    for (size_t i = 0; i < parser.header_count(); ++i) {
+        const HeaderField& field = parser.headers()[i];
+        if (field.id == HeaderId::TransferEncoding) {
+            if (coding) return Framing::BadCoding;
+            coding = &field;
+        } else if (field.id == HeaderId::ContentLength) {
+            long long value = parse_content_length(field.value);
+            if (value < 0 || (has_length && value != content_length)) return Framing::BadLength;
+            has_length = true;
+            content_length = value;
+        }
+    }
+    if (coding) {
+        // Only the chunked transfer coding is understood
+        if (!iequals(coding->value, "chunked")) return Framing::UnsupportedCoding;
+        return has_length ? Framing::BadLength : Framing::Chunked;
+    }
+    return has_length ? Framing::Length : Framing::None;
+}
+
+// The canned answer to framing that is refused, nullptr if it is accepted
+const char* framing_error_response(Framing framing) {
+    switch (framing) {
+        case Framing::BadLength: return INVALID_LENGTH_RESPONSE;
+        case Framing::BadCoding: return INVALID_TRANSFER_CODING_RESPONSE;
+        case Framing::UnsupportedCoding: return UNSUPPORTED_TRANSFER_CODING_RESPONSE;
+        default: return nullptr;
+    }
+}
+
+// A view of a session's write_iov_ to hand to async_write, which keeps a
+// copy of its buffer sequence: copying the vector would allocate per write
+struct BufferSpan {
+    const asio::const_buffer* first;
+    const asio::const_buffer* last;
+
+    explicit BufferSpan(const std::vector<asio::const_buffer>& buffers)
+        : first(buffers.data()), last(buffers.data() + buffers.size()) {}
+    const asio::const_buffer* begin() const { return first; }
+    const asio::const_buffer* end() const { return last; }
+};
+
+// Copy the parsed head into the connection's Request for the handlers.
+// Its strings keep their capacity from one request to the next, so a
+// steady stream of similar requests stops allocating.
+void fill_request(const RequestParser& parser, Request& request) {
+    request.method.assign(parser.method());
+    request.path.assign(parser.target());
+    request.version.assign(parser.version());
+    request.headers.clear();
+    request.body.clear();
+    for (size_t i = 0; i < parser.header_count(); ++i) {
+        const HeaderField& field = parser.headers()[i];
+        if (field.id != HeaderId::Unknown) {
+            request.headers.set(field.id, field.value);
+        } else {
+            request.headers.set(field.name, field.value);
+        }
+    }
+}
+
+// Give back the buffer of a large body rather than hold it for the rest
+// of the connection
+void release_large_body(Request& request) {
+    if (request.body.capacity() > MAX_RETAINED_BODY_SIZE) {
+        std::string().swap(request.body);
+    }
+}
+
+}  // namespace
+
+Session::Session(tcp::socket socket)
+    : socket_(std::move(socket)), timer_(socket_.get_executor()), parser_(MAX_HEADER_SIZE) {
+    count(Counter::ConnectionsAccepted);
+}
+
+Session::~Session() {
+    close_file();
+    count(Counter::ConnectionsClosed);
+}
+
+void Session::start() {
+    // sendfile() needs the descriptor itself to be non-blocking
+    boost::system::error_code ec;
+    socket_.native_non_blocking(true, ec);
+    // A batch is one writev of many small buffers; don't let Nagle hold
+    // back its last segment waiting for the client's delayed ACK
+    socket_.set_option(tcp::no_delay(true), ec);
+
+    // Get client IP once (for logging); the peer may already be gone
+    auto endpoint = socket_.remote_endpoint(ec);
+    if (!ec) {
+        client_ip_ = endpoint.address().to_string();
+    }
+    // Hop onto the socket's strand before touching the socket or timer
+    asio::dispatch(socket_.get_executor(), [self = shared_from_this()]() {
+        self->do_read();
+    });
+}
+
+// Drop connections that sit idle (or trickle bytes) past the timeout
+void Session::arm_timeout() {
+    timer_.expires_after(std::chrono::seconds(REQUEST_TIMEOUT_SECONDS));
+    timer_.async_wait(bind_arena(handler_arena_, [self = shared_from_this()](const boost::system::error_code& ec) {
+        // A wait that completed just before being re-armed is not a timeout
+        if (!ec && self->timer_.expiry() <= std::chrono::steady_clock::now()) {
+            self->close();
+        }
+    }));
+}
+
+void Session::do_read() {
+    arm_timeout();
+
+    // Read straight into the tail of the persistent buffer. A partially
+    // received body is fetched in one go rather than chunk by chunk.
+    size_t chunk = std::max(READ_CHUNK_SIZE, read_hint_);
+    size_t old_size = read_buffer_.size();
+    read_buffer_.resize(old_size + chunk);
+    socket_.async_read_some(asio::buffer(&read_buffer_[old_size], chunk),
+        bind_arena(handler_arena_, [self = shared_from_this(), old_size](const boost::system::error_code& ec, size_t bytes) {
+            self->read_buffer_.resize(old_size + bytes);
+            self->on_read(ec, bytes);
+        }));
+}
+
+void Session::on_read(const boost::system::error_code& ec, size_t /*bytes*/) {
+    timer_.cancel();
+    if (ec) {
+        if (is_disconnect(ec)) {
+            close();
+            return;
+        }
+        std::cerr << "Error reading request: " << ec.message() << "\n";
+        write_buffer_.assign(BAD_REQUEST_RESPONSE);
+        close_after_write_ = true;
+        do_write();
+        return;
+    }
+    process_buffer();
+}
+
+// Answer every complete request in the buffer, then write the batch
+void Session::process_buffer() {
+    write_buffer_.clear();
+    read_hint_ = 0;
+    size_t offset = 0;
+
+    // A request that was cut short by the last pass arrived back then
+    mark_ = std::chrono::steady_clock::now();
+    if (!request_partial_) {
+        arrived_ = mark_;
+    }
+    request_partial_ = false;
+
+    while (!close_after_write_) {
+        if (body_mode_ != BodyMode::None) {
+            // A body that arrives piece by piece; answered once complete
+            if (!read_body(offset)) {
+                break;
+            }
+            if (file_fd_ >= 0 || stream_) {
+                break;
+            }
+            continue;
+        }
+
+        std::string_view pending(read_buffer_.data() + offset, read_buffer_.size() - offset);
+
+        // Parse the request head; the parser resumes where it left off and
+        // enforces MAX_HEADER_SIZE to prevent memory exhaustion
+        RequestParser::Result result = parser_.parse(pending);
+        if (result == RequestParser::Result::Incomplete) {
+            request_partial_ = !pending.empty();
+            break;
+        }
+        if (result == RequestParser::Result::Error) {
+            write_buffer_ += parse_error_response(parser_.error_status());
+            close_after_write_ = true;
+            break;
+        }
+        size_t header_end = parser_.header_length();
+
+        long long content_length = 0;
+        Framing framing = body_framing(parser_, content_length);
+        if (const char* refusal = framing_error_response(framing)) {
+            write_buffer_ += refusal;
+            close_after_write_ = true;
+            break;
+        }
+        bool chunked = framing == Framing::Chunked;
+
+        // Chunked bodies and bodies for streaming routes are taken piece by
+        // piece as they arrive
+        const StreamingHandler* handler = find_streaming_route(parser_.method(), parser_.target());
+        std::uint64_t length_limit = handler ? MAX_STREAMED_BODY_LENGTH : MAX_CONTENT_LENGTH;
+        if (static_cast<std::uint64_t>(content_length) > length_limit) {
+            write_buffer_ += PAYLOAD_TOO_LARGE_RESPONSE;
+            close_after_write_ = true;
+            break;
+        }
+        if (chunked || handler) {
+            start_body(handler, chunked, static_cast<std::uint64_t>(content_length));
+            offset += header_end;
+            parser_.reset();
+            continue;
+        }
+
+        // Wait for the rest of the body
+        size_t request_size = header_end + static_cast<size_t>(content_length);
+        if (pending.size() < request_size) {
+            read_hint_ = request_size - pending.size();
+            request_partial_ = true;
+            break;
+        }
+
+        fill_request(parser_, request_);
+        request_.body.assign(pending.substr(header_end, static_cast<size_t>(content_length)));
+        offset += request_size;
+        parser_.reset();
+        auto parsed = std::chrono::steady_clock::now();
+        record_phase(Phase::Read, mark_ - arrived_);
+        record_phase(Phase::Parse, parsed - mark_);
+
+        if (!handle_request(request_, parsed)) {
+            close_after_write_ = true;
+        }
+        release_large_body(request_);
+
+        // A file or streamed body goes out after this batch, before any
+        // later response
+        if (file_fd_ >= 0 || stream_) {
+            break;
+        }
+    }
+
+    read_buffer_.erase(0, offset);
+    if (body_mode_ != BodyMode::None) {
+        request_partial_ = true;
+    }
+
+    if (!write_buffer_.empty()) {
+        do_write();
+    } else if (close_after_write_) {
+        close();
+    } else if (!sink_paused_) {
+        do_read();
+    } else {
+        // Nothing is pending while the sink is paused; the timer keeps the
+        // session alive and drops it if the sink never resumes
+        arm_timeout();
+    }
+}
+
+// Begin a body that is decoded as it arrives: buffered for a regular route,
+// or handed to the streaming route's sink
+void Session::start_body(const StreamingHandler* handler, bool chunked, std::uint64_t content_length) {
+    fill_request(parser_, request_);
+    body_started_ = std::chrono::steady_clock::now();
+    record_phase(Phase::Parse, body_started_ - mark_);
+    body_chunked_ = chunked;
+    chunked_.reset();
+    body_remaining_ = content_length;
+    body_received_ = 0;
+    sink_paused_ = false;
+    sink_.reset();
+    if (handler) {
+        sink_ = (*handler)(request_, resume_handler(&Session::resume_body));
+    }
+    body_mode_ = sink_ ? BodyMode::Streaming : BodyMode::Buffered;
+
+    // The client may hold the body back until it hears it is wanted
+    const std::string* expect = request_.headers.get(HeaderId::Expect);
+    if (expect && iequals(*expect, "100-continue") && request_.version == "HTTP/1.1" &&
+        (chunked || content_length > 0)) {
+        write_buffer_ += CONTINUE_RESPONSE;
+    }
+}
+
+// Consume the body bytes buffered from offset on. Returns true once the
+// body is complete and its response queued; false when more bytes are
+// needed, the sink paused, or the request failed.
+bool Session::read_body(size_t& offset) {
+    while (!sink_paused_) {
+        std::string_view pending(read_buffer_.data() + offset, read_buffer_.size() - offset);
+        std::string_view data;
+        bool done = false;
+        if (body_chunked_) {
+            size_t consumed = 0;
+            ChunkedDecoder::Result result = chunked_.decode(pending, consumed, data);
+            offset += consumed;
+            if (result == ChunkedDecoder::Result::NeedMore) {
+                return false;
+            }
+            if (result == ChunkedDecoder::Result::Error) {
+                fail_body(MALFORMED_CHUNKED_RESPONSE);
+                return false;
+            }
+            done = result == ChunkedDecoder::Result::Done;
+        } else {
+            size_t take = static_cast<size_t>(std::min<std::uint64_t>(body_remaining_, pending.size()));
+            data = pending.substr(0, take);
+            offset += take;
+            body_remaining_ -= take;
+            done = body_remaining_ == 0;
+            if (take == 0 && !done) {
+                return false;
+            }
+        }
+        if (!data.empty() && !deliver_body(data)) {
+            return false;
+        }
+        if (done) {
+            finish_body();
+            return true;
+        }
+    }
+    return false;
+}
+
+// Buffer a piece of the body or pass it to the sink. Returns false when the
+// request ends here (too large, or aborted by the sink).
+bool Session::deliver_body(std::string_view data) {
+    body_received_ += data.size();
+    if (body_mode_ == BodyMode::Buffered) {
+        if (body_received_ > MAX_CONTENT_LENGTH) {
+            fail_body(PAYLOAD_TOO_LARGE_RESPONSE);
+            return false;
+        }
+        request_.body.append(data);
+        return true;
+    }
+    if (body_received_ > MAX_STREAMED_BODY_LENGTH) {
+        fail_body(PAYLOAD_TOO_LARGE_RESPONSE);
+        return false;
+    }
+    switch (sink_->on_data(data)) {
+        case BodySink::Flow::Continue:
+            return true;
+        case BodySink::Flow::Pause:
+            sink_paused_ = true;
+            return true;
+        case BodySink::Flow::Abort:
+            // The unread rest of the body can't be skipped reliably
+            finish_body();
+            close_after_write_ = true;
+            return false;
+    }
+    return true;
+}
+
+void Session::finish_body() {
+    record_phase(Phase::Read, mark_ - arrived_);
+    ResponsePtr response;
+    auto routing = std::chrono::steady_clock::now();
+    if (body_mode_ == BodyMode::Streaming) {
+        response = sink_->on_end();
+        sink_.reset();
+    } else {
+        response = route_request(request_);
+    }
+    auto routed = std::chrono::steady_clock::now();
+    record_phase(Phase::Route, routed - routing);
+    body_mode_ = BodyMode::None;
+    sink_paused_ = false;
+    if (!response) {
+        response = make_response(
+            "500 Internal Server Error", "text/plain", "Internal server error.\n");
+    }
+    if (!queue_response(request_, std::move(response), body_started_, routed)) {
+        close_after_write_ = true;
+    }
+    release_large_body(request_);
+}
+
+void Session::fail_body(const char* canned_response) {
+    write_buffer_ += canned_response;
+    close_after_write_ = true;
+    body_mode_ = BodyMode::None;
+    sink_paused_ = false;
+    if (sink_) {
+        sink_->on_error();
+        sink_.reset();
+    }
+}
+
+// Resume function handed to a sink or stream: hops onto the strand, and
+// does nothing once the session is gone
+BodyResume Session::resume_handler(void (Session::*resume)()) {
+    return [weak = weak_from_this(), resume]() {
+        if (auto self = weak.lock()) {
+            asio::post(self->socket_.get_executor(), [self, resume]() { ((*self).*resume)(); });
+        }
+    };
+}
+
+// A paused sink wants more: carry on, unless a write is still in flight
+// (its completion continues with the buffer anyway)
+void Session::resume_body() {
+    if (!sink_paused_ || !socket_.is_open()) {
+        return;
+    }
+    sink_paused_ = false;
+    timer_.cancel();
+    if (!output_pending_) {
+        process_buffer();
+    }
+}
+
+// Dispatch one request and append its response to the batch.
+// Returns whether the connection stays open afterwards.
+bool Session::handle_request(const Request& request, std::chrono::steady_clock::time_point parsed) {
+    ResponsePtr response = route_request(request);
+    auto routed = std::chrono::steady_clock::now();
+    record_phase(Phase::Route, routed - parsed);
+    return queue_response(request, std::move(response), parsed, routed);
+}
+
+// Append a response to the batch, routed at `routed` (saving a clock read).
+// Returns whether the connection stays open afterwards.
+bool Session::queue_response(const Request& request, ResponsePtr response,
+                             std::chrono::steady_clock::time_point started,
+                             std::chrono::steady_clock::time_point routed) {
+    // Conditional GET/HEAD on a cached file: answer with its prebuilt 304
+    bool not_modified = (request.method == "GET" || request.method == "HEAD") &&
+                        is_not_modified(*response, request.headers.get(HeaderId::IfNoneMatch),
+                                        request.headers.get(HeaderId::IfModifiedSince));
+
+    // A HEAD response carries the GET's headers, Content-Length included,
+    // but never its body
+    bool head_only = request.method == "HEAD";
+
+    // Range on a GET of a static file: a 206 (or 416) built for this request
+    if (!not_modified && request.method == "GET" && response->accept_ranges) {
+        response = apply_range(response, request.headers.get(HeaderId::Range), request.headers.get(HeaderId::IfRange));
+    }
+
+    // Open a file body now so a vanished file can still get a proper 404
+    if (response->file && !not_modified && !head_only) {
+        file_fd_ = ::open(response->file->path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file_fd_ < 0) {
+            response = make_response(
+                "404 Not Found", "text/plain; charset=utf-8", "File not found.\r\n");
+        } else if (!response->file->segments.empty()) {
+            // Multipart ranges: parts are sent one by one after the batch
+            file_response_ = response;
+            file_segment_ = 0;
+            file_remaining_ = 0;
+        } else {
+            file_offset_ = response->file->offset;
+            file_remaining_ = response->file->length;
+        }
+    }
+
+    // Determine keep-alive semantics
+    bool keep_alive = false;
+    // Default keep-alive for HTTP/1.1 unless explicitly closed
+    if (request.version == "HTTP/1.1") keep_alive = true;
+    // Check Connection header from parsed request
+    if (const std::string* conn_value = request.headers.get(HeaderId::Connection)) {
+        if (iequals(*conn_value, "close")) keep_alive = false;
+        else if (iequals(*conn_value, "keep-alive")) keep_alive = true;
+    }
+
+    // Increment request counter and force close after max requests
+    request_count_++;
+    if (request_count_ >= MAX_KEEPALIVE_REQUESTS) {
+        keep_alive = false;
+    }
+
+    // A streamed body is chunked; without chunked (HTTP/1.0) only closing
+    // the connection can mark its end
+    bool chunked = response->stream && request.version == "HTTP/1.1";
+    if (response->stream && !head_only) {
+        stream_ = response->stream;
+        stream_chunked_ = chunked;
+        if (!stream_chunked_) {
+            keep_alive = false;
+        }
+    }
+
+    size_t tail_start = write_buffer_.size();
+
+    // The shared head carries the status line and fixed headers; only the
+    // per-request lines are formatted here. Heads and bodies are referenced,
+    // not copied.
+    std::string& resp = write_buffer_;
+    if (response->head.empty()) {
+        append_response_head(resp, *response);
+    }
+    if (chunked) {
+        resp += "Transfer-Encoding: chunked\r\n";
+    }
+    resp += "Date: ";
+    resp += http_date();
+    resp += "\r\n";
+    resp += keep_alive ? "Connection: keep-alive\r\nKeep-Alive: timeout=5, max=1000\r\n\r\n"
+                       : "Connection: close\r\n\r\n";
+
+    // Queue the access log record (handler latency; the write is still pending)
+    std::uint64_t body_size = not_modified || head_only ? 0 : (response->file ? response->file->length : response->body.size());
+    int status = not_modified ? 304 : std::atoi(response->status.c_str());
+    auto latency = std::chrono::duration_cast<std::chrono::microseconds>(routed - started);
+    log_access(client_ip_, request.method, request.path, status, body_size, static_cast<std::uint32_t>(latency.count()));
+    count_response(status, body_size);
+
+    // The next request in the buffer arrived with this one; its parse phase
+    // also covers queuing this response
+    mark_ = routed;
+    arrived_ = routed;
+
+    batch_.push_back({tail_start, write_buffer_.size(), std::move(response), not_modified, head_only});
+    return keep_alive;
+}
+
+// Gather the batch into one writev: per response, its shared head, its
+// per-request lines from write_buffer_ and its shared body
+void Session::do_write() {
+    output_pending_ = true;
+    write_started_ = std::chrono::steady_clock::now();
+    write_iov_.clear();
+    size_t written_end = 0;
+    for (const BatchEntry& entry : batch_) {
+        const Response& response = *entry.response;
+        const std::string& head = entry.not_modified ? response.not_modified_head : response.head;
+        if (!head.empty()) {
+            // Anything before the tail (canned error responses) goes first
+            if (written_end < entry.tail_start) {
+                write_iov_.push_back(asio::buffer(write_buffer_.data() + written_end, entry.tail_start - written_end));
+            }
+            write_iov_.push_back(asio::buffer(head));
+            write_iov_.push_back(asio::buffer(write_buffer_.data() + entry.tail_start, entry.tail_end - entry.tail_start));
+        } else {
+            // The head was serialized in place, just before the tail
+            write_iov_.push_back(asio::buffer(write_buffer_.data() + written_end, entry.tail_end - written_end));
+        }
+        written_end = entry.tail_end;
+        if (!entry.not_modified && !entry.head_only && !response.file && !response.body.empty()) {
+            write_iov_.push_back(asio::buffer(response.body));
+        }
+    }
+    if (written_end < write_buffer_.size()) {
+        write_iov_.push_back(asio::buffer(write_buffer_.data() + written_end, write_buffer_.size() - written_end));
+    }
+
+    asio::async_write(socket_, BufferSpan(write_iov_),
+        bind_arena(handler_arena_, [self = shared_from_this()](const boost::system::error_code& ec, size_t bytes) {
+            self->on_write(ec, bytes);
+        }));
+}
+
+void Session::on_write(const boost::system::error_code& ec, size_t /*bytes*/) {
+    record_phase(Phase::Write, std::chrono::steady_clock::now() - write_started_);
+    // Release the batch's bodies
+    batch_.clear();
+    write_iov_.clear();
+
+    if (ec) {
+        if (!is_disconnect(ec)) {
+            std::cerr << "Error sending response: " << ec.message() << "\n";
+        }
+        close();
+        return;
+    }
+
+    if (file_fd_ >= 0) {
+        do_send_file();
+        return;
+    }
+    if (stream_) {
+        stream_->start(resume_handler(&Session::resume_stream));
+        do_stream();
+        return;
+    }
+    on_response_sent();
+}
+
+// Pull the next piece of the streamed body and write it as one chunk. The
+// pull after it waits for that write, so the stream goes at the socket's
+// pace.
+void Session::do_stream() {
+    stream_piece_.clear();
+    BodyStream::Status status = stream_->pull(stream_piece_);
+    if (status == BodyStream::Status::Pending) {
+        stream_waiting_ = true;
+        arm_timeout();  // Keeps the session alive while the producer works
+        return;
+    }
+    bool done = status == BodyStream::Status::Done;
+    if (stream_piece_.empty() && !done) {
+        // An empty chunk would end the body; ask again on the next turn
+        asio::post(socket_.get_executor(), [self = shared_from_this()]() { self->do_stream(); });
+        return;
+    }
+
+    static const char CRLF[] = "\r\n";
+    static const char LAST_CHUNK[] = "0\r\n\r\n";
+    write_iov_.clear();
+    if (!stream_piece_.empty()) {
+        if (stream_chunked_) {
+            char size_line[24];
+            int n = std::snprintf(size_line, sizeof(size_line), "%zx\r\n", stream_piece_.size());
+            stream_size_line_.assign(size_line, static_cast<size_t>(n));
+            write_iov_.push_back(asio::buffer(stream_size_line_));
+        }
+        write_iov_.push_back(asio::buffer(stream_piece_));
+        if (stream_chunked_) {
+            write_iov_.push_back(asio::buffer(CRLF, 2));
+        }
+    }
+    if (done && stream_chunked_) {
+        write_iov_.push_back(asio::buffer(LAST_CHUNK, 5));
+    }
+    if (write_iov_.empty()) {
+        finish_stream();
+        return;
+    }
+
+    asio::async_write(socket_, BufferSpan(write_iov_),
+        bind_arena(handler_arena_, [self = shared_from_this(), done](const boost::system::error_code& ec, size_t /*bytes*/) {
+            if (ec) {
+                if (!is_disconnect(ec)) {
+                    std::cerr << "Error sending response: " << ec.message() << "\n";
+                }
+                self->close();
+                return;
+            }
+            if (done) {
+                self->finish_stream();
+            } else {
+                self->do_stream();
+            }
+        }));
+}
+
+void Session::finish_stream() {
+    stream_.reset();
+    write_iov_.clear();
+    on_response_sent();
+}
+
+void Session::resume_stream() {
+    if (!stream_waiting_ || !socket_.is_open()) {
+        return;
+    }
+    stream_waiting_ = false;
+    timer_.cancel();
+    do_stream();
+}
+
+// Stream the pending file body with sendfile(2). The socket is non-blocking:
+// when it is full, wait for writability instead of blocking the thread, and
+// after each slice yield so one download cannot monopolize the loop.
+void Session::do_send_file() {
+    size_t sent_this_turn = 0;
+    while (file_remaining_ > 0) {
+        if (sent_this_turn >= FILE_SLICE_SIZE) {
+            asio::post(socket_.get_executor(), [self = shared_from_this()]() {
+                self->do_send_file();
+            });
+            return;
+        }
+
+        size_t want = static_cast<size_t>(std::min<std::uint64_t>(file_remaining_, FILE_SLICE_SIZE));
+#ifdef __linux__
+        off_t offset = static_cast<off_t>(file_offset_);
+        ssize_t n = ::sendfile(socket_.native_handle(), file_fd_, &offset, want);
+#else
+        // No Linux-style sendfile: pread a bounded chunk and write it
+        file_chunk_.resize(want);
+        ssize_t n = ::pread(file_fd_, &file_chunk_[0], want, static_cast<off_t>(file_offset_));
+        if (n > 0) {
+            file_chunk_.resize(static_cast<size_t>(n));
+            asio::async_write(socket_, asio::buffer(file_chunk_),
+                bind_arena(handler_arena_, [self = shared_from_this()](const boost::system::error_code& ec, size_t bytes) {
+                    if (ec) {
+                        self->close();
+                        return;
+                    }
+                    self->file_offset_ += bytes;
+                    self->file_remaining_ -= bytes;
+                    self->do_send_file();
+                }));
+            return;
+        }
+#endif
+        if (n > 0) {
+            file_offset_ += static_cast<std::uint64_t>(n);
+            file_remaining_ -= static_cast<std::uint64_t>(n);
+            sent_this_turn += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            socket_.async_wait(tcp::socket::wait_write,
+                bind_arena(handler_arena_, [self = shared_from_this()](const boost::system::error_code& ec) {
+                    if (ec) {
+                        self->close();
+                        return;
+                    }
+                    self->do_send_file();
+                }));
+            return;
+        }
+
+        // n == 0 (file shrank) or a hard error: the promised length can no
+        // longer be delivered, so the connection cannot be reused
+        if (n < 0 && errno != EPIPE && errno != ECONNRESET) {
+            std::cerr << "Error sending file: " << std::strerror(errno) << "\n";
+        }
+        close();
+        return;
+    }
+
+    if (file_response_) {
+        send_next_segment();
+        return;
+    }
+    close_file();
+    on_response_sent();
+}
+
+// Multipart file body: write the next part's header and stream its range,
+// or, after the last part, the closing delimiter
+void Session::send_next_segment() {
+    const FileBody& body = *file_response_->file;
+    if (file_segment_ > body.segments.size()) {
+        close_file();
+        on_response_sent();
+        return;
+    }
+    const std::string* text = &body.trailer;
+    if (file_segment_ < body.segments.size()) {
+        const FileSegment& segment = body.segments[file_segment_];
+        text = &segment.prefix;
+        file_offset_ = segment.offset;
+        file_remaining_ = segment.length;
+    }
+    ++file_segment_;
+    asio::async_write(socket_, asio::buffer(*text),
+        bind_arena(handler_arena_, [self = shared_from_this()](const boost::system::error_code& ec, size_t /*bytes*/) {
+            if (ec) {
+                self->close();
+                return;
+            }
+            self->do_send_file();
+        }));
+}
+
+// Close if not keep-alive, otherwise carry on with any pipelined requests
+// still buffered, reading more when none is complete
+void Session::on_response_sent() {
+    output_pending_ = false;
+    if (close_after_write_) {
+        close();
+        return;
+    }
+    process_buffer();
+}
+
+void Session::close_file() {
+    if (file_fd_ >= 0) {
+        ::close(file_fd_);
+        file_fd_ = -1;
+    }
+    file_remaining_ = 0;
+    file_response_.reset();
+}
+
+void Session::close() {
+    boost::system::error_code ignored;
+    close_file();
+    if (sink_) {
+        sink_->on_error();
+        sink_.reset();
+    }
+    if (stream_) {
+        stream_->on_error();
+        stream_.reset();
+    }
+    timer_.cancel();
+    socket_.shutdown(tcp::socket::shutdown_both, ignored);
+    socket_.close(ignored);
+}
@@ -0,0 +1,246 @@
+#include "simd_scan.hpp"
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(_M_X64)) && !defined(TEZ_DISABLE_SIMD)
+#define TEZ_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Byte classes used by the scalar paths (and the vector tails)
+struct ByteClasses {
+    bool token[256] = {};
+    bool target[256] = {};
+    bool field_value[256] = {};
+
+    ByteClasses() {
+        for (int c = '0'; c <= '9'; ++c) token[c] = true;
+        for (int c = 'a'; c <= 'z'; ++c) token[c] = true;
+        for (int c = 'A'; c <= 'Z'; ++c) token[c] = true;
+        for (const char* p = "!#$%&'*+-.^_`|~"; *p; ++p) token[static_cast<unsigned char>(*p)] = true;
+
+        for (int c = 0; c < 256; ++c) {
+            target[c] = c > 0x20 && c != 0x7f;
+            field_value[c] = (c >= 0x20 || c == '\t') && c != 0x7f;
+        }
+    }
+};
+
+const ByteClasses BYTE_CLASSES;
+
+const char* scalar_find(const char* p, const char* end, const bool* allowed) {
+    for (; p < end; ++p) {
+        if (!allowed[static_cast<unsigned char>(*p)]) return p;
+    }
+    return end;
+}
+
+const char* scalar_for_byte(const char* p, const char* end, char c) {
+    const void* hit = p < end ? std::memchr(p, c, static_cast<size_t>(end - p)) : nullptr;
+    return hit ? static_cast<const char*>(hit) : end;
+}
+
+const char* scalar_non_token(const char* p, const char* end) {
+    return scalar_find(p, end, BYTE_CLASSES.token);
+}
+
+const char* scalar_non_target(const char* p, const char* end) {
+    return scalar_find(p, end, BYTE_CLASSES.target);
+}
+
+const char* scalar_non_field_value(const char* p, const char* end) {
+    return scalar_find(p, end, BYTE_CLASSES.field_value);
+}
+
+#ifdef TEZ_SCAN_X86
+
+// ---- SSE2 (baseline on x86-64) ----
+
+// Bytes of x in [lo, hi] (unsigned): x - lo <= hi - lo
+inline __m128i in_range_128(__m128i x, char lo, char hi) {
+    __m128i d = _mm_sub_epi8(x, _mm_set1_epi8(lo));
+    __m128i span = _mm_set1_epi8(static_cast<char>(hi - lo));
+    return _mm_cmpeq_epi8(_mm_min_epu8(d, span), d);
+}
+
+inline __m128i token_mask_128(__m128i x) {
+    __m128i lower = _mm_or_si128(x, _mm_set1_epi8(0x20));
+    __m128i ok = in_range_128(lower, 'a', 'z');
+    ok = _mm_or_si128(ok, in_range_128(x, '0', '9'));
+    ok = _mm_or_si128(ok, _mm_cmpeq_epi8(x, _mm_set1_epi8('!')));
+    ok = _mm_or_si128(ok, in_range_128(x, '#', '\''));
+    ok = _mm_or_si128(ok, in_range_128(x, '*', '+'));
+    ok = _mm_or_si128(ok, in_range_128(x, '-', '.'));
+    ok = _mm_or_si128(ok, in_range_128(x, '^', '`'));
+    ok = _mm_or_si128(ok, _mm_cmpeq_epi8(x, _mm_set1_epi8('|')));
+    ok = _mm_or_si128(ok, _mm_cmpeq_epi8(x, _mm_set1_epi8('~')));
+    return ok;
+}
+
+// Controls are 0x00-0x1f; DEL is 0x7f
+inline __m128i control_mask_128(__m128i x) {
+    __m128i low = _mm_cmpeq_epi8(_mm_min_epu8(x, _mm_set1_epi8(0x1f)), x);
+    return _mm_or_si128(low, _mm_cmpeq_epi8(x, _mm_set1_epi8(0x7f)));
+}
+
+template<typename BadMask>
+inline const char* sse2_find(const char* p, const char* end, BadMask bad_mask) {
+    while (end - p >= 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        unsigned bits = static_cast<unsigned>(_mm_movemask_epi8(bad_mask(x)));
+        if (bits) return p + __builtin_ctz(bits);
+        p += 16;
+    }
+    return p;  // Caller finishes the tail
+}
+
+const char* sse2_for_byte(const char* p, const char* end, char c) {
+    __m128i needle = _mm_set1_epi8(c);
+    p = sse2_find(p, end, [needle](__m128i x) { return _mm_cmpeq_epi8(x, needle); });
+    return p < end ? scalar_for_byte(p, end, c) : end;
+}
+
+const char* sse2_non_token(const char* p, const char* end) {
+    p = sse2_find(p, end, [](__m128i x) {
+        return _mm_xor_si128(token_mask_128(x), _mm_set1_epi8(-1));
+    });
+    return scalar_non_token(p, end);
+}
+
+const char* sse2_non_target(const char* p, const char* end) {
+    p = sse2_find(p, end, [](__m128i x) {
+        return _mm_or_si128(control_mask_128(x), _mm_cmpeq_epi8(x, _mm_set1_epi8(' ')));
+    });
+    return scalar_non_target(p, end);
+}
+
+const char* sse2_non_field_value(const char* p, const char* end) {
+    p = sse2_find(p, end, [](__m128i x) {
+        return _mm_andnot_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('\t')), control_mask_128(x));
+    });
+    return scalar_non_field_value(p, end);
+}
+
+// ---- AVX2 (selected at runtime) ----
+
+#define TEZ_AVX2 __attribute__((target("avx2")))
+
+TEZ_AVX2 inline __m256i in_range_256(__m256i x, char lo, char hi) {
+    __m256i d = _mm256_sub_epi8(x, _mm256_set1_epi8(lo));
+    __m256i span = _mm256_set1_epi8(static_cast<char>(hi - lo));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(d, span), d);
+}
+
+TEZ_AVX2 inline __m256i token_mask_256(__m256i x) {
+    __m256i lower = _mm256_or_si256(x, _mm256_set1_epi8(0x20));
+    __m256i ok = in_range_256(lower, 'a', 'z');
+    ok = _mm256_or_si256(ok, in_range_256(x, '0', '9'));
+    ok = _mm256_or_si256(ok, _mm256_cmpeq_epi8(x, _mm256_set1_epi8('!')));
+    ok = _mm256_or_si256(ok, in_range_256(x, '#', '\''));
+    ok = _mm256_or_si256(ok, in_range_256(x, '*', '+'));
+    ok = _mm256_or_si256(ok, in_range_256(x, '-', '.'));
+    ok = _mm256_or_si256(ok, in_range_256(x, '^', '`'));
+    ok = _mm256_or_si256(ok, _mm256_cmpeq_epi8(x, _mm256_set1_epi8('|')));
+    ok = _mm256_or_si256(ok, _mm256_cmpeq_epi8(x, _mm256_set1_epi8('~')));
+    return ok;
+}
+
+TEZ_AVX2 inline __m256i control_mask_256(__m256i x) {
+    __m256i low = _mm256_cmpeq_epi8(_mm256_min_epu8(x, _mm256_set1_epi8(0x1f)), x);
+    return _mm256_or_si256(low, _mm256_cmpeq_epi8(x, _mm256_set1_epi8(0x7f)));
+}
+
+TEZ_AVX2 const char* avx2_for_byte(const char* p, const char* end, char c) {
+    __m256i needle = _mm256_set1_epi8(c);
+    while (end - p >= 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        unsigned bits = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, needle)));
+        if (bits) return p + __builtin_ctz(bits);
+        p += 32;
+    }
+    return sse2_for_byte(p, end, c);
+}
+
+TEZ_AVX2 const char* avx2_non_token(const char* p, const char* end) {
+    while (end - p >= 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        unsigned bits = ~static_cast<unsigned>(_mm256_movemask_epi8(token_mask_256(x)));
+        if (bits) return p + __builtin_ctz(bits);
+        p += 32;
+    }
+    return sse2_non_token(p, end);
+}
+
+TEZ_AVX2 const char* avx2_non_target(const char* p, const char* end) {
+    while (end - p >= 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i bad = _mm256_or_si256(control_mask_256(x), _mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')));
+        unsigned bits = static_cast<unsigned>(_mm256_movemask_epi8(bad));
+        if (bits) return p + __builtin_ctz(bits);
+        p += 32;
+    }
+    return sse2_non_target(p, end);
+}
+
+TEZ_AVX2 const char* avx2_non_field_value(const char* p, const char* end) {
+    while (end - p >= 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i bad = _mm256_andnot_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('\t')), control_mask_256(x));
+        unsigned bits = static_cast<unsigned>(_mm256_movemask_epi8(bad));
+        if (bits) return p + __builtin_ctz(bits);
+        p += 32;
+    }
+    return sse2_non_field_value(p, end);
+}
+
+#undef TEZ_AVX2
+
+#endif  // TEZ_SCAN_X86
+
+struct ScanOps {
+    const char* (*for_byte)(const char*, const char*, char);
+    const char* (*non_token)(const char*, const char*);
+    const char* (*non_target)(const char*, const char*);
+    const char* (*non_field_value)(const char*, const char*);
+    const char* name;
+};
+
+ScanOps select_ops() {
+#ifdef TEZ_SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {avx2_for_byte, avx2_non_token, avx2_non_target, avx2_non_field_value, "avx2"};
+    }
+    return {sse2_for_byte, sse2_non_token, sse2_non_target, sse2_non_field_value, "sse2"};
+#else
+    return {scalar_for_byte, scalar_non_token, scalar_non_target, scalar_non_field_value, "scalar"};
+#endif
+}
+
+const ScanOps& ops() {
+    static const ScanOps selected = select_ops();
+    return selected;
+}
+
+}  // namespace
+
+const char* scan_for_byte(const char* begin, const char* end, char c) {
+    return ops().for_byte(begin, end, c);
+}
+
+const char* scan_non_token(const char* begin, const char* end) {
+    return ops().non_token(begin, end);
+}
+
+const char* scan_non_target(const char* begin, const char* end) {
+    return ops().non_target(begin, end);
+}
+
+const char* scan_non_field_value(const char* begin, const char* end) {
+    return ops().non_field_value(begin, end);
+}
+
+const char* scan_isa_name() {
+    return ops().name;
+}
@@ -1,28 +1,174 @@
 #include "thread_pool.hpp"
+#include <chrono>
+#include <exception>
+#include <iostream>
 
-ThreadPool::ThreadPool(size_t num_threads) : stop(false) {
-    for (size_t i = 0; i < num_threads; ++i) {
-        workers.emplace_back([this] {
-            while (true) {
-                std::function<void()> task;
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
-                {
-                    std::unique_lock<std::mutex> lock(this->queue_mutex);
-                    this->condition.wait(lock, [this] {
-                        return this->stop || !this->tasks.empty();
-                    });
+namespace {
 
-                    if (this->stop && this->tasks.empty()) {
-                        return;
-                    }
+// Victim-search rounds an idle worker makes before parking. Spinning only
+// pays off when another core can post work meanwhile.
+constexpr unsigned SPIN_ROUNDS = 64;
+constexpr size_t INITIAL_DEQUE_CAPACITY = 256;
+constexpr size_t TASK_WORDS = sizeof(Task) / sizeof(std::uint64_t);
 
-                    task = std::move(this->tasks.front());
-                    this->tasks.pop();
-                }
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#else
+    std::this_thread::yield();
+#endif
+}
 
-                task();
-            }
-        });
+// Ring of task slots. A thief may read a slot while the owner overwrites
+// it after a wrap-around; its CAS on top then fails and the torn copy is
+// thrown away, so slots are stored as relaxed atomic words to keep that
+// race well defined.
+struct TaskArray {
+    explicit TaskArray(size_t capacity) : mask(capacity - 1), slots(capacity * TASK_WORDS) {}
+
+    size_t capacity() const { return mask + 1; }
+
+    void put(int64_t index, const Task& task) {
+        std::uint64_t words[TASK_WORDS];
+        std::memcpy(words, &task, sizeof(Task));
+        std::atomic<std::uint64_t>* slot = &slots[(static_cast<size_t>(index) & mask) * TASK_WORDS];
+        for (size_t i = 0; i < TASK_WORDS; ++i) slot[i].store(words[i], std::memory_order_relaxed);
+    }
+
+    Task get(int64_t index) const {
+        std::uint64_t words[TASK_WORDS];
+        const std::atomic<std::uint64_t>* slot = &slots[(static_cast<size_t>(index) & mask) * TASK_WORDS];
+        for (size_t i = 0; i < TASK_WORDS; ++i) words[i] = slot[i].load(std::memory_order_relaxed);
+        Task task;
+        std::memcpy(&task, words, sizeof(Task));
+        return task;
+    }
+
+    size_t mask;
+    std::vector<std::atomic<std::uint64_t>> slots;
+};
+
+// Chase-Lev work-stealing deque (Lê et al., "Correct and Efficient
+// Work-Stealing for Weak Memory Models"). Only the owner pushes and takes
+// at the bottom; any thread may steal from the top.
+class WorkDeque {
+public:
+    WorkDeque() {
+        arrays_.push_back(std::make_unique<TaskArray>(INITIAL_DEQUE_CAPACITY));
+        array_.store(arrays_.back().get(), std::memory_order_relaxed);
+    }
+
+    void push(const Task& task) {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        TaskArray* array = array_.load(std::memory_order_relaxed);
+        if (b - t > static_cast<int64_t>(array->capacity()) - 1) {
+            array = grow(array, t, b);
+        }
+        array->put(b, task);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+
+    bool take(Task& task) {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        TaskArray* array = array_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        task = array->get(b);
+        if (t == b) {
+            // Last task: race the thieves for it
+            bool won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                    std::memory_order_relaxed);
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    bool steal(Task& task) {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) return false;
+        TaskArray* array = array_.load(std::memory_order_acquire);
+        task = array->get(t);
+        return top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                            std::memory_order_relaxed);
+    }
+
+    bool empty() const {
+        int64_t t = top_.load(std::memory_order_relaxed);
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        return t >= b;
+    }
+
+    // Approximate while the owner and thieves are active
+    size_t size() const {
+        int64_t t = top_.load(std::memory_order_relaxed);
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        return b > t ? static_cast<size_t>(b - t) : 0;
+    }
+
+private:
+    // Old arrays stay alive until the deque is destroyed, because a thief
+    // may still be reading from one
+    TaskArray* grow(TaskArray* old, int64_t t, int64_t b) {
+        arrays_.push_back(std::make_unique<TaskArray>(old->capacity() * 2));
+        TaskArray* array = arrays_.back().get();
+        for (int64_t i = t; i < b; ++i) array->put(i, old->get(i));
+        array_.store(array, std::memory_order_release);
+        return array;
+    }
+
+    alignas(64) std::atomic<int64_t> top_{0};
+    alignas(64) std::atomic<int64_t> bottom_{0};
+    alignas(64) std::atomic<TaskArray*> array_{nullptr};
+    std::vector<std::unique_ptr<TaskArray>> arrays_;
+};
+
+// Which pool (if any) the current thread works for, so post() from inside
+// a task can use the worker's own deque
+thread_local const void* tls_pool = nullptr;
+thread_local size_t tls_index = 0;
+
+void run_task(Task& task) {
+    try {
+        task.run();
+    } catch (const std::exception& e) {
+        std::cerr << "Exception in pool task: " << e.what() << "\n";
+    } catch (...) {
+        std::cerr << "Unknown exception in pool task\n";
+    }
+}
+
+}  // namespace
+
+struct ThreadPool::Worker {
+    WorkDeque deque;
+    std::uint32_t rng;  // xorshift state for picking steal victims
+};
+
+ThreadPool::ThreadPool(size_t num_threads)
+    : spin_rounds_(std::thread::hardware_concurrency() > 1 ? SPIN_ROUNDS : 0) {
+    if (num_threads == 0) num_threads = 1;
+    for (size_t i = 0; i < num_threads; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+        workers_.back()->rng = static_cast<std::uint32_t>(i * 2654435761u + 1);
+    }
+    for (size_t i = 0; i < num_threads; ++i) {
+        threads_.emplace_back([this, i] { worker_loop(i); });
     }
 }
 
@@ -32,13 +178,137 @@ ThreadPool::~ThreadPool() {
 
 void ThreadPool::shutdown() {
     {
-        std::unique_lock<std::mutex> lock(queue_mutex);
-        stop = true;
+        std::lock_guard<std::mutex> lock(park_mutex_);
+        stop_.store(true);
+    }
+    park_cv_.notify_all();
+    for (std::thread& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    // Release anything that raced in with shutdown after the workers left
+    Task task;
+    for (auto& worker : workers_) {
+        while (worker->deque.steal(task)) task.discard();
+    }
+    std::lock_guard<std::mutex> lock(inject_mutex_);
+    for (Task& leftover : injected_) leftover.discard();
+    injected_.clear();
+    injected_count_.store(0);
+}
+
+void ThreadPool::submit(Task task) {
+    if (stop_.load(std::memory_order_relaxed)) {
+        task.discard();
+        throw std::runtime_error("post on stopped ThreadPool");
+    }
+    if (tls_pool == this) {
+        workers_[tls_index]->deque.push(task);
+    } else {
+        std::lock_guard<std::mutex> lock(inject_mutex_);
+        injected_.push_back(task);
+        injected_count_.fetch_add(1, std::memory_order_relaxed);
     }
-    condition.notify_all();
-    for (std::thread& worker : workers) {
-        if (worker.joinable()) {
-            worker.join();
+    // Pairs with the fence in park(): either the parking worker sees this
+    // task, or we see it counted in sleepers_ and wake it
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_relaxed) > 0) {
+        wake_one();
+    }
+}
+
+void ThreadPool::wake_one() {
+    std::lock_guard<std::mutex> lock(park_mutex_);
+    park_cv_.notify_one();
+}
+
+void ThreadPool::worker_loop(size_t index) {
+    tls_pool = this;
+    tls_index = index;
+    Task task;
+    while (true) {
+        if (find_task(index, task)) {
+            run_task(task);
+            continue;
+        }
+        bool found = false;
+        for (unsigned spin = 0; spin < spin_rounds_ && !found; ++spin) {
+            cpu_relax();
+            found = find_task(index, task);
+        }
+        if (found) {
+            run_task(task);
+            continue;
+        }
+        if (!park()) {
+            break;
+        }
+    }
+    tls_pool = nullptr;
+}
+
+// Own deque first, then the injection queue, then steal from a random victim
+bool ThreadPool::find_task(size_t index, Task& task) {
+    Worker& self = *workers_[index];
+    if (self.deque.take(task)) {
+        return true;
+    }
+    if (injected_count_.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(inject_mutex_);
+        if (!injected_.empty()) {
+            task = injected_.front();
+            injected_.pop_front();
+            injected_count_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    size_t count = workers_.size();
+    if (count > 1) {
+        self.rng ^= self.rng << 13;
+        self.rng ^= self.rng >> 17;
+        self.rng ^= self.rng << 5;
+        size_t start = self.rng % count;
+        for (size_t i = 0; i < count; ++i) {
+            size_t victim = (start + i) % count;
+            if (victim != index && workers_[victim]->deque.steal(task)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::has_work() const {
+    if (injected_count_.load(std::memory_order_relaxed) > 0) return true;
+    for (const auto& worker : workers_) {
+        if (!worker->deque.empty()) return true;
+    }
+    return false;
+}
+
+size_t ThreadPool::queued() const {
+    size_t total = injected_count_.load(std::memory_order_relaxed);
+    for (const auto& worker : workers_) {
+        total += worker->deque.size();
+    }
+    return total;
+}
+
+// Sleep until there may be work. Returns false once the pool is stopping
+// and every queue is empty.
+bool ThreadPool::park() {
+    std::unique_lock<std::mutex> lock(park_mutex_);
+    sleepers_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    while (!has_work()) {
+        if (stop_.load(std::memory_order_relaxed)) {
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+            return false;
         }
+        // Timed, so a parked worker re-checks the queues at least once a second
+        park_cv_.wait_for(lock, std::chrono::seconds(1));
     }
+    sleepers_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
 }
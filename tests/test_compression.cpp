@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include "../include/compression.hpp"
+#include <zlib.h>
+#include <string>
+
+namespace {
+
+// Inflate a gzip (windowBits 15 + 16) or zlib (15) stream
+std::string inflate_body(const std::string& input, int window_bits) {
+    z_stream stream{};
+    EXPECT_EQ(inflateInit2(&stream, window_bits), Z_OK);
+    std::string out(1 << 20, '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream.avail_in = static_cast<uInt>(input.size());
+    stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = static_cast<uInt>(out.size());
+    EXPECT_EQ(inflate(&stream, Z_FINISH), Z_STREAM_END);
+    out.resize(stream.total_out);
+    inflateEnd(&stream);
+    return out;
+}
+
+}  // namespace
+
+TEST(CompressionTest, NegotiatesPreferredCoding) {
+    EXPECT_EQ(negotiate_coding(""), ContentCoding::Identity);
+    EXPECT_EQ(negotiate_coding("gzip"), ContentCoding::Gzip);
+    EXPECT_EQ(negotiate_coding("deflate"), ContentCoding::Deflate);
+    EXPECT_EQ(negotiate_coding("gzip, deflate, br"), ContentCoding::Gzip);
+    EXPECT_EQ(negotiate_coding("deflate, gzip"), ContentCoding::Gzip);
+    EXPECT_EQ(negotiate_coding("br, zstd"), ContentCoding::Identity);
+    EXPECT_EQ(negotiate_coding("GZIP"), ContentCoding::Gzip);
+    EXPECT_EQ(negotiate_coding("x-gzip"), ContentCoding::Gzip);
+}
+
+TEST(CompressionTest, HonoursQualityValues) {
+    EXPECT_EQ(negotiate_coding("gzip;q=0, deflate"), ContentCoding::Deflate);
+    EXPECT_EQ(negotiate_coding("gzip; q=0.0, deflate;q=0"), ContentCoding::Identity);
+    EXPECT_EQ(negotiate_coding("gzip;q=0.5, deflate;q=0.8"), ContentCoding::Deflate);
+    EXPECT_EQ(negotiate_coding("*"), ContentCoding::Gzip);
+    EXPECT_EQ(negotiate_coding("*;q=0, identity"), ContentCoding::Identity);
+    EXPECT_EQ(negotiate_coding("deflate, *;q=0.1"), ContentCoding::Deflate);
+}
+
+TEST(CompressionTest, MalformedQualityMakesCodingUnacceptable) {
+    // Above 1, too many digits, or not a qvalue at all: the coding is refused
+    EXPECT_EQ(negotiate_coding("gzip;q=5, deflate;q=0.5"), ContentCoding::Deflate);
+    EXPECT_EQ(negotiate_coding("gzip;q=1.5, deflate;q=0.5"), ContentCoding::Deflate);
+    EXPECT_EQ(negotiate_coding("gzip;q=0.0001, deflate;q=0.001"), ContentCoding::Deflate);
+    EXPECT_EQ(negotiate_coding("gzip;q=0x1p3, deflate;q=0.5"), ContentCoding::Deflate);
+    EXPECT_EQ(negotiate_coding("gzip;q=inf, deflate;q=nan"), ContentCoding::Identity);
+    EXPECT_EQ(negotiate_coding("gzip;q=0,5"), ContentCoding::Identity);
+    // Three decimals are enough to tell codings apart
+    EXPECT_EQ(negotiate_coding("gzip;q=0.999, deflate;q=1.000"), ContentCoding::Deflate);
+    EXPECT_EQ(negotiate_coding("gzip;q=1., deflate;q=0.9"), ContentCoding::Gzip);
+}
+
+TEST(CompressionTest, CompressibleTypes) {
+    EXPECT_TRUE(is_compressible("text/html; charset=utf-8"));
+    EXPECT_TRUE(is_compressible("text/css"));
+    EXPECT_TRUE(is_compressible("application/javascript; charset=utf-8"));
+    EXPECT_TRUE(is_compressible("application/json"));
+    EXPECT_TRUE(is_compressible("image/svg+xml"));
+    EXPECT_FALSE(is_compressible("image/png"));
+    EXPECT_FALSE(is_compressible("application/gzip"));
+    EXPECT_FALSE(is_compressible("font/woff2"));
+}
+
+TEST(CompressionTest, GzipAndDeflateRoundTrip) {
+    std::string input;
+    for (int i = 0; i < 200; ++i) input += "body { color: #333; margin: 0 auto; }\n";
+
+    std::string gzip;
+    ASSERT_TRUE(compress_body(input, ContentCoding::Gzip, 6, gzip));
+    ASSERT_GE(gzip.size(), 2u);
+    EXPECT_EQ(static_cast<unsigned char>(gzip[0]), 0x1f);  // gzip magic
+    EXPECT_EQ(static_cast<unsigned char>(gzip[1]), 0x8b);
+    EXPECT_LT(gzip.size(), input.size() / 10);
+    EXPECT_EQ(inflate_body(gzip, 15 + 16), input);
+
+    std::string deflate;
+    ASSERT_TRUE(compress_body(input, ContentCoding::Deflate, 6, deflate));
+    EXPECT_EQ(inflate_body(deflate, 15), input);
+
+    std::string unused;
+    EXPECT_FALSE(compress_body(input, ContentCoding::Identity, 6, unused));
+    EXPECT_EQ(coding_name(ContentCoding::Gzip), "gzip");
+    EXPECT_EQ(coding_name(ContentCoding::Identity), "");
+}
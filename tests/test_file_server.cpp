@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 #include "../include/file_server.hpp"
+#include <chrono>
 #include <fstream>
+#include <thread>
 #include <sys/stat.h>
 
 class FileServerTest : public ::testing::Test {
@@ -28,32 +30,185 @@ protected:
 TEST_F(FileServerTest, ServesExistingFile) {
     // Note: serve_file looks for ../static/ relative to build dir
     // For testing, we'd need to adapt the path or mock the file reading
-    Response resp = serve_file("/static/style.css");
+    ResponsePtr resp = serve_file("/static/style.css");
     // This test depends on the actual static/style.css file existing
-    EXPECT_TRUE(resp.status == "200 OK" || resp.status == "404 Not Found");
+    EXPECT_TRUE(resp->status == "200 OK" || resp->status == "404 Not Found");
 }
 
 TEST_F(FileServerTest, ReturnsNotFoundForMissingFile) {
-    Response resp = serve_file("/static/nonexistent.txt");
-    EXPECT_EQ(resp.status, "404 Not Found");
-    EXPECT_EQ(resp.content_type, "text/plain; charset=utf-8");
+    ResponsePtr resp = serve_file("/static/nonexistent.txt");
+    EXPECT_EQ(resp->status, "404 Not Found");
+    EXPECT_EQ(resp->content_type, "text/plain; charset=utf-8");
 }
 
 TEST_F(FileServerTest, CorrectMimeTypesForCSS) {
-    Response resp = serve_file("/static/test.css");
-    if (resp.status == "200 OK") {
-        EXPECT_EQ(resp.content_type, "text/css");
+    ResponsePtr resp = serve_file("/static/test.css");
+    if (resp->status == "200 OK") {
+        EXPECT_EQ(resp->content_type, "text/css");
     }
 }
 
 TEST_F(FileServerTest, CorrectMimeTypesForHTML) {
-    Response resp = serve_file("/static/test.html");
-    if (resp.status == "200 OK") {
-        EXPECT_EQ(resp.content_type, "text/html");
+    ResponsePtr resp = serve_file("/static/test.html");
+    if (resp->status == "200 OK") {
+        EXPECT_EQ(resp->content_type, "text/html");
     }
 }
 
 TEST_F(FileServerTest, RejectNonStaticPaths) {
-    Response resp = serve_file("/not-static/file.txt");
-    EXPECT_EQ(resp.status, "400 Bad Request");
+    ResponsePtr resp = serve_file("/not-static/file.txt");
+    EXPECT_EQ(resp->status, "400 Bad Request");
 }
+
+// Compressible files written into the real static directory (../static from
+// the build directory), under names no other test uses
+class FileCompressionTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        for (int i = 0; i < 100; ++i) css_ += ".item-" + std::to_string(i) + " { color: #333; margin: 0 auto; }\n";
+        std::ofstream("../static/tez_test_compress.css") << css_;
+        std::ofstream("../static/tez_test_compress.png") << css_;
+        std::ofstream("../static/tez_test_tiny.css") << "a{}";
+        std::ofstream("../static/tez_test_sibling.css") << css_;
+        std::ofstream("../static/tez_test_sibling.css.gz") << "precompressed";
+    }
+
+    void TearDown() override {
+        for (const char* name : {"tez_test_compress.css", "tez_test_compress.png", "tez_test_tiny.css",
+                                 "tez_test_sibling.css", "tez_test_sibling.css.gz"}) {
+            std::remove((std::string("../static/") + name).c_str());
+        }
+    }
+
+    std::string css_;
+};
+
+TEST_F(FileCompressionTest, ServesGzipVariantWithVary) {
+    ResponsePtr identity = serve_file("/static/tez_test_compress.css");
+    ASSERT_EQ(identity->status, "200 OK");
+    EXPECT_EQ(identity->body, css_);
+    EXPECT_TRUE(identity->content_encoding.empty());
+    EXPECT_NE(identity->head.find("Vary: Accept-Encoding\r\n"), std::string::npos);
+
+    ResponsePtr gzip = serve_file("/static/tez_test_compress.css", "gzip, deflate, br");
+    EXPECT_EQ(gzip->content_encoding, "gzip");
+    EXPECT_LT(gzip->body.size(), css_.size() / 3);
+    EXPECT_NE(gzip->head.find("Content-Encoding: gzip\r\n"), std::string::npos);
+    EXPECT_NE(gzip->head.find("Vary: Accept-Encoding\r\n"), std::string::npos);
+    EXPECT_NE(gzip->head.find("Content-Length: " + std::to_string(gzip->body.size()) + "\r\n"), std::string::npos);
+
+    ResponsePtr deflate = serve_file("/static/tez_test_compress.css", "deflate");
+    EXPECT_EQ(deflate->content_encoding, "deflate");
+
+    // The variant is produced once and then served from the file cache
+    EXPECT_EQ(serve_file("/static/tez_test_compress.css", "gzip").get(), gzip.get());
+    EXPECT_EQ(serve_file("/static/tez_test_compress.css", "").get(), identity.get());
+}
+
+TEST_F(FileCompressionTest, LeavesIncompressibleAndTinyFilesAlone) {
+    ResponsePtr png = serve_file("/static/tez_test_compress.png", "gzip");
+    EXPECT_TRUE(png->content_encoding.empty());
+    EXPECT_EQ(png->head.find("Vary:"), std::string::npos);
+
+    ResponsePtr tiny = serve_file("/static/tez_test_tiny.css", "gzip");
+    EXPECT_TRUE(tiny->content_encoding.empty());
+    EXPECT_EQ(tiny->body, "a{}");
+}
+
+TEST_F(FileCompressionTest, PrefersPrecompressedSibling) {
+    ResponsePtr gzip = serve_file("/static/tez_test_sibling.css", "gzip");
+    EXPECT_EQ(gzip->content_encoding, "gzip");
+    EXPECT_EQ(gzip->body, "precompressed");
+
+    // Siblings only stand in for gzip
+    ResponsePtr deflate = serve_file("/static/tez_test_sibling.css", "deflate");
+    EXPECT_EQ(deflate->content_encoding, "deflate");
+    EXPECT_NE(deflate->body, "precompressed");
+}
+
+TEST_F(FileCompressionTest, SendsValidatorsAndCacheControl) {
+    // Policies apply when a file is loaded, so use files no other test cached
+    std::ofstream("../static/tez_test_policy.css") << css_;
+    std::ofstream("../static/tez_test_policy.png") << css_;
+    set_cache_control_policies({{".css", "public, max-age=31536000"}, {"*", "no-cache"}});
+    ResponsePtr css = serve_file("/static/tez_test_policy.css");
+    ResponsePtr png = serve_file("/static/tez_test_policy.png");
+    ResponsePtr gzip = serve_file("/static/tez_test_policy.css", "gzip");
+    ResponsePtr deflate = serve_file("/static/tez_test_policy.css", "deflate");
+    set_cache_control_policies({});
+    std::remove("../static/tez_test_policy.css");
+    std::remove("../static/tez_test_policy.png");
+
+    ASSERT_EQ(css->status, "200 OK");
+    EXPECT_EQ(css->etag.front(), '"');
+    EXPECT_EQ(css->etag.back(), '"');
+    EXPECT_GT(css->last_modified, 0);
+    EXPECT_EQ(css->cache_control, "public, max-age=31536000");
+    EXPECT_NE(css->head.find("ETag: " + css->etag + "\r\n"), std::string::npos);
+    EXPECT_NE(css->not_modified_head.find("ETag: " + css->etag + "\r\n"), std::string::npos);
+    EXPECT_EQ(png->cache_control, "no-cache");
+
+    // Every representation has its own strong tag
+    EXPECT_NE(gzip->etag, css->etag);
+    EXPECT_NE(deflate->etag, css->etag);
+    EXPECT_NE(deflate->etag, gzip->etag);
+    EXPECT_EQ(deflate->last_modified, css->last_modified);
+
+    ResponsePtr missing = serve_file("/static/tez_test_missing.css");
+    EXPECT_TRUE(missing->etag.empty());
+    EXPECT_TRUE(missing->not_modified_head.empty());
+}
+
+#ifdef __linux__
+
+class StaticWatcherTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(start_static_watcher());
+    }
+
+    void TearDown() override {
+        stop_static_watcher();
+        std::remove("../static/tez_test_watch.css");
+        std::remove("../static/tez_test_watch.css.gz");
+        std::remove("../static/tez_test_watch_new.css");
+    }
+
+    // Poll until serve_file returns a body, giving the watcher up to two seconds
+    static bool serves(const std::string& path, const std::string& body, std::string_view coding = {}) {
+        for (int i = 0; i < 200; ++i) {
+            if (serve_file(path, coding)->body == body) return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return false;
+    }
+};
+
+TEST_F(StaticWatcherTest, EditedFileIsServedFreshWithoutTtl) {
+    std::ofstream("../static/tez_test_watch.css") << "a{}";
+    ASSERT_TRUE(serves("/static/tez_test_watch.css", "a{}"));
+    ResponsePtr first = serve_file("/static/tez_test_watch.css");
+    EXPECT_EQ(serve_file("/static/tez_test_watch.css").get(), first.get());  // Cached
+
+    std::ofstream("../static/tez_test_watch.css") << "b{}";
+    EXPECT_TRUE(serves("/static/tez_test_watch.css", "b{}"));
+    EXPECT_NE(serve_file("/static/tez_test_watch.css")->etag, first->etag);
+
+    // A new precompressed sibling replaces the cached gzip variant
+    std::ofstream("../static/tez_test_watch.css.gz") << "precompressed";
+    EXPECT_TRUE(serves("/static/tez_test_watch.css", "precompressed", "gzip"));
+}
+
+TEST_F(StaticWatcherTest, CreatedFileReplacesCachedNotFound) {
+    EXPECT_EQ(serve_file("/static/tez_test_watch_new.css")->status, "404 Not Found");
+    std::ofstream("../static/tez_test_watch_new.css") << "new{}";
+    EXPECT_TRUE(serves("/static/tez_test_watch_new.css", "new{}"));
+
+    // Non-canonical names resolve to the same file but are never cached,
+    // since the watcher only reports canonical paths
+    ResponsePtr dotted = serve_file("/static/./tez_test_watch_new.css");
+    EXPECT_EQ(dotted->body, "new{}");
+    EXPECT_NE(serve_file("/static/./tez_test_watch_new.css").get(), dotted.get());
+}
+
+#endif
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include "../include/file_watcher.hpp"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+class FileWatcherTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        root_ = fs::temp_directory_path() / ("tez_watch_" + std::to_string(::getpid()));
+        fs::remove_all(root_);
+        fs::create_directories(root_ / "css");
+        std::ofstream(root_ / "css" / "site.css") << "a{}";
+    }
+
+    void TearDown() override {
+        watcher_.stop();
+        fs::remove_all(root_);
+    }
+
+    bool start() {
+        return watcher_.start(root_.string(), [this](const std::string& path) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            events_.push_back(path);
+        });
+    }
+
+    // Wait up to two seconds for the watcher to report path
+    bool saw(const std::string& path) {
+        for (int i = 0; i < 200; ++i) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (const auto& event : events_) {
+                    if (event == path) return true;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return false;
+    }
+
+    fs::path root_;
+    FileWatcher watcher_;
+    std::mutex mutex_;
+    std::vector<std::string> events_;
+};
+
+#ifdef __linux__
+
+TEST_F(FileWatcherTest, ReportsChangedFileRelativeToRoot) {
+    ASSERT_TRUE(start());
+    EXPECT_TRUE(watcher_.running());
+    std::ofstream(root_ / "css" / "site.css") << "b{}";
+    EXPECT_TRUE(saw("css/site.css"));
+}
+
+TEST_F(FileWatcherTest, ReportsDeletionAndRename) {
+    ASSERT_TRUE(start());
+    fs::rename(root_ / "css" / "site.css", root_ / "css" / "old.css");
+    EXPECT_TRUE(saw("css/site.css"));
+    EXPECT_TRUE(saw("css/old.css"));
+    fs::remove(root_ / "css" / "old.css");
+    EXPECT_TRUE(saw("css/old.css"));
+}
+
+TEST_F(FileWatcherTest, WatchesDirectoriesCreatedLater) {
+    ASSERT_TRUE(start());
+    fs::create_directories(root_ / "js");
+    EXPECT_TRUE(saw(""));  // New directory: everything under it is new
+    std::ofstream(root_ / "js" / "app.js") << "1";
+    EXPECT_TRUE(saw("js/app.js"));
+}
+
+TEST_F(FileWatcherTest, StopsCleanly) {
+    ASSERT_TRUE(start());
+    watcher_.stop();
+    EXPECT_FALSE(watcher_.running());
+    std::ofstream(root_ / "css" / "site.css") << "c{}";
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    std::lock_guard<std::mutex> lock(mutex_);
+    EXPECT_TRUE(events_.empty());
+}
+
+TEST_F(FileWatcherTest, CompletedWritesOnlyAtTopLevel) {
+    ASSERT_TRUE(watcher_.start(
+        root_.string(),
+        [this](const std::string& path) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            events_.push_back(path);
+        },
+        WatchOptions{false, true}));
+    {
+        std::ofstream out(root_ / "config.json.tmp");
+        out << "{";
+        out.flush();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        std::lock_guard<std::mutex> lock(mutex_);
+        EXPECT_TRUE(events_.empty());  // Still open: not reported yet
+    }
+    EXPECT_TRUE(saw("config.json.tmp"));
+    fs::rename(root_ / "config.json.tmp", root_ / "config.json");
+    EXPECT_TRUE(saw("config.json"));
+
+    std::ofstream(root_ / "css" / "site.css") << "b{}";
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& event : events_) {
+        EXPECT_NE(event, "css/site.css");  // Subdirectories aren't watched
+    }
+}
+
+#endif
+
+TEST_F(FileWatcherTest, MissingRootFailsToStart) {
+    EXPECT_FALSE(watcher_.start((root_ / "missing").string(), [](const std::string&) {}));
+    EXPECT_FALSE(watcher_.running());
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include "../include/headers.hpp"
+#include "../include/http_parser.hpp"
+#include "../include/request.hpp"
+#include <map>
+#include <string>
+
+TEST(HeadersTest, InternsWellKnownNamesCaseInsensitively) {
+    EXPECT_EQ(lookup_header_id("Content-Length"), HeaderId::ContentLength);
+    EXPECT_EQ(lookup_header_id("CONNECTION"), HeaderId::Connection);
+    EXPECT_EQ(lookup_header_id("if-none-match"), HeaderId::IfNoneMatch);
+    EXPECT_EQ(lookup_header_id("X-Request-Id"), HeaderId::Unknown);
+    EXPECT_EQ(header_name(HeaderId::AcceptEncoding), "accept-encoding");
+}
+
+TEST(HeadersTest, StoresKnownAndOtherHeaders) {
+    HeaderMap headers;
+    headers.set("Host", "example.com");
+    headers.set("X-Trace", "abc");
+    ASSERT_NE(headers.get(HeaderId::Host), nullptr);
+    EXPECT_EQ(*headers.get(HeaderId::Host), "example.com");
+    EXPECT_EQ(*headers.get("host"), "example.com");
+    EXPECT_EQ(*headers.get("x-trace"), "abc");
+    EXPECT_EQ(*headers.get("X-TRACE"), "abc");
+    EXPECT_EQ(headers.get(HeaderId::Range), nullptr);
+    EXPECT_FALSE(headers.contains("x-missing"));
+    EXPECT_EQ(headers.size(), 2u);
+}
+
+TEST(HeadersTest, LaterValueReplacesEarlier) {
+    HeaderMap headers;
+    headers.set("Connection", "keep-alive");
+    headers.set("connection", "close");
+    headers.set("X-A", "1");
+    headers.set("x-a", "2");
+    EXPECT_EQ(*headers.get(HeaderId::Connection), "close");
+    EXPECT_EQ(*headers.get("x-a"), "2");
+    EXPECT_EQ(headers.size(), 2u);
+}
+
+TEST(HeadersTest, ClearEmptiesTheMap) {
+    HeaderMap headers;
+    headers.set("Host", "a");
+    headers.set("X-B", "b");
+    headers.clear();
+    EXPECT_TRUE(headers.empty());
+    EXPECT_EQ(headers.get(HeaderId::Host), nullptr);
+}
+
+TEST(HeadersTest, RefillAfterClearShowsOnlyNewHeaders) {
+    HeaderMap headers;
+    headers.set("X-Old", "1");
+    headers.set("X-Older", "2");
+    headers.clear();
+    headers.set("X-New", "3");
+    EXPECT_EQ(headers.size(), 1u);
+    EXPECT_EQ(headers.get("x-old"), nullptr);
+    EXPECT_EQ(headers.get("x-older"), nullptr);
+    EXPECT_EQ(*headers.get("x-new"), "3");
+    size_t visited = 0;
+    headers.for_each([&visited](std::string_view, std::string_view) { ++visited; });
+    EXPECT_EQ(visited, 1u);
+}
+
+TEST(HeadersTest, ForEachVisitsLowercaseNames) {
+    HeaderMap headers;
+    headers.set("Content-Type", "text/plain");
+    headers.set("X-Custom", "1");
+    std::map<std::string, std::string> seen;
+    headers.for_each([&seen](std::string_view name, std::string_view value) {
+        seen[std::string(name)] = std::string(value);
+    });
+    EXPECT_EQ(seen.size(), 2u);
+    EXPECT_EQ(seen["content-type"], "text/plain");
+    EXPECT_EQ(seen["x-custom"], "1");
+}
+
+TEST(HeadersTest, ParserTagsWellKnownHeaders) {
+    RequestParser parser;
+    ASSERT_EQ(parser.parse("GET / HTTP/1.1\r\nX-A: 1\r\nContent-Length: 5\r\n\r\n"), RequestParser::Result::Complete);
+    EXPECT_EQ(parser.headers()[0].id, HeaderId::Unknown);
+    EXPECT_EQ(parser.headers()[1].id, HeaderId::ContentLength);
+    ASSERT_NE(parser.find_header(HeaderId::ContentLength), nullptr);
+    EXPECT_EQ(parser.find_header(HeaderId::ContentLength)->value, "5");
+    EXPECT_EQ(parser.find_header(HeaderId::Host), nullptr);
+}
+
+TEST(HeadersTest, ContentLengthFromHeaderMap) {
+    Request req = parse_request("POST / HTTP/1.1\r\nContent-Length: 42\r\n\r\n");
+    EXPECT_EQ(get_content_length(req.headers), 42);
+    EXPECT_EQ(*req.headers.get(HeaderId::ContentLength), "42");
+}
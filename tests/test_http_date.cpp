@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include "../include/http_date.hpp"
+#include <string>
+#include <thread>
+
+TEST(HttpDateTest, FormatsImfFixdate) {
+    char out[HTTP_DATE_LENGTH];
+    format_http_date(784111777, out);  // RFC 9110's example
+    EXPECT_EQ(std::string(out, HTTP_DATE_LENGTH), "Sun, 06 Nov 1994 08:49:37 GMT");
+
+    format_http_date(0, out);
+    EXPECT_EQ(std::string(out, HTTP_DATE_LENGTH), "Thu, 01 Jan 1970 00:00:00 GMT");
+
+    format_http_date(1709251199, out);  // Leap day, end of day
+    EXPECT_EQ(std::string(out, HTTP_DATE_LENGTH), "Thu, 29 Feb 2024 23:59:59 GMT");
+}
+
+TEST(HttpDateTest, ParsesImfFixdate) {
+    std::time_t time = 0;
+    ASSERT_TRUE(parse_http_date("Sun, 06 Nov 1994 08:49:37 GMT", time));
+    EXPECT_EQ(time, 784111777);
+    ASSERT_TRUE(parse_http_date("Thu, 29 Feb 2024 23:59:59 GMT", time));
+    EXPECT_EQ(time, 1709251199);
+
+    char out[HTTP_DATE_LENGTH];
+    format_http_date(1800000000, out);
+    ASSERT_TRUE(parse_http_date(std::string_view(out, HTTP_DATE_LENGTH), time));
+    EXPECT_EQ(time, 1800000000);
+
+    EXPECT_FALSE(parse_http_date("Sunday, 06-Nov-94 08:49:37 GMT", time));  // RFC 850
+    EXPECT_FALSE(parse_http_date("Sun Nov  6 08:49:37 1994", time));        // asctime
+    EXPECT_FALSE(parse_http_date("Sun, 06 Foo 1994 08:49:37 GMT", time));
+    EXPECT_FALSE(parse_http_date("Sun, 06 Nov 1994 08:49:37 UTC", time));
+    EXPECT_FALSE(parse_http_date("", time));
+}
+
+TEST(HttpDateTest, CurrentDateMatchesClock) {
+    std::time_t before = std::time(nullptr);
+    std::string date(http_date());
+    std::time_t after = std::time(nullptr);
+
+    char expected_before[HTTP_DATE_LENGTH];
+    char expected_after[HTTP_DATE_LENGTH];
+    format_http_date(before, expected_before);
+    format_http_date(after, expected_after);
+    EXPECT_TRUE(date == std::string(expected_before, HTTP_DATE_LENGTH) ||
+                date == std::string(expected_after, HTTP_DATE_LENGTH));
+}
+
+TEST(HttpDateTest, EachThreadGetsItsOwnCopy) {
+    std::string_view main_date = http_date();
+    std::string other;
+    std::thread([&other]() { other = std::string(http_date()); }).join();
+
+    EXPECT_NE(main_date.data(), nullptr);
+    EXPECT_EQ(other.size(), HTTP_DATE_LENGTH);
+    EXPECT_EQ(other.substr(other.size() - 4), " GMT");
+}
@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+#include "../include/http_parser.hpp"
+#include <algorithm>
+#include <string>
+
+TEST(HttpParserTest, ParsesRequestLineAndHeaders) {
+    std::string raw = "GET /index.html HTTP/1.1\r\nHost: example.com\r\nAccept:  text/html \r\n\r\n";
+    RequestParser parser;
+    ASSERT_EQ(parser.parse(raw), RequestParser::Result::Complete);
+    EXPECT_EQ(parser.method(), "GET");
+    EXPECT_EQ(parser.target(), "/index.html");
+    EXPECT_EQ(parser.version(), "HTTP/1.1");
+    ASSERT_EQ(parser.header_count(), 2u);
+    EXPECT_EQ(parser.headers()[0].name, "Host");
+    EXPECT_EQ(parser.headers()[1].value, "text/html");
+    EXPECT_EQ(parser.header_length(), raw.size());
+}
+
+TEST(HttpParserTest, ViewsPointIntoInput) {
+    std::string raw = "POST /echo HTTP/1.1\r\nContent-Length: 4\r\n\r\nbody";
+    RequestParser parser;
+    ASSERT_EQ(parser.parse(raw), RequestParser::Result::Complete);
+    EXPECT_EQ(parser.method().data(), raw.data());
+    EXPECT_EQ(parser.header_length(), raw.size() - 4);
+}
+
+TEST(HttpParserTest, HeaderLookupIsCaseInsensitive) {
+    RequestParser parser;
+    ASSERT_EQ(parser.parse("GET / HTTP/1.1\r\nCONTENT-length: 12\r\n\r\n"), RequestParser::Result::Complete);
+    EXPECT_EQ(parser.header("content-length"), "12");
+    EXPECT_EQ(parser.find_header("connection"), nullptr);
+}
+
+TEST(HttpParserTest, ResumesAcrossPartialInput) {
+    std::string raw = "GET /a HTTP/1.1\r\nHost: x\r\nConnection: close\r\n\r\n";
+    RequestParser parser;
+    for (size_t i = 1; i < raw.size(); ++i) {
+        // Each call sees a longer prefix in a freshly allocated buffer
+        std::string prefix = raw.substr(0, i);
+        ASSERT_EQ(parser.parse(prefix), RequestParser::Result::Incomplete) << "at " << i;
+    }
+    ASSERT_EQ(parser.parse(raw), RequestParser::Result::Complete);
+    EXPECT_EQ(parser.target(), "/a");
+    EXPECT_EQ(parser.header("connection"), "close");
+}
+
+TEST(HttpParserTest, AcceptsBareLineFeeds) {
+    RequestParser parser;
+    ASSERT_EQ(parser.parse("GET / HTTP/1.0\nHost: x\n\n"), RequestParser::Result::Complete);
+    EXPECT_EQ(parser.version(), "HTTP/1.0");
+    EXPECT_EQ(parser.header("host"), "x");
+}
+
+TEST(HttpParserTest, SkipsEmptyLinesBeforeRequestLine) {
+    // Nothing but empty lines: wait for more rather than spin on them
+    for (const char* blank : {"\r\n", "\n", "\r\n\r\n"}) {
+        RequestParser parser;
+        EXPECT_EQ(parser.parse(blank), RequestParser::Result::Incomplete) << blank;
+    }
+    RequestParser parser;
+    ASSERT_EQ(parser.parse("\r\n"), RequestParser::Result::Incomplete);
+    ASSERT_EQ(parser.parse("\r\nGET /a HTTP/1.1\r\n\r\n"), RequestParser::Result::Complete);
+    EXPECT_EQ(parser.target(), "/a");
+}
+
+TEST(HttpParserTest, ResetParsesNextRequest) {
+    RequestParser parser;
+    ASSERT_EQ(parser.parse("GET /first HTTP/1.1\r\n\r\n"), RequestParser::Result::Complete);
+    parser.reset();
+    ASSERT_EQ(parser.parse("GET /second HTTP/1.1\r\n\r\n"), RequestParser::Result::Complete);
+    EXPECT_EQ(parser.target(), "/second");
+}
+
+TEST(HttpParserTest, RejectsMalformedRequestLine) {
+    for (const char* raw : {"GET\r\n\r\n", "GET /\r\n\r\n", "G(T / HTTP/1.1\r\n\r\n",
+                            "GET / FTP/1.1\r\n\r\n", "GET /a b HTTP/1.1\r\n\r\n"}) {
+        RequestParser parser;
+        EXPECT_EQ(parser.parse(raw), RequestParser::Result::Error) << raw;
+        EXPECT_EQ(parser.error_status(), 400) << raw;
+    }
+}
+
+TEST(HttpParserTest, RejectsUnsupportedVersion) {
+    RequestParser parser;
+    EXPECT_EQ(parser.parse("GET / HTTP/2.0\r\n\r\n"), RequestParser::Result::Error);
+    EXPECT_EQ(parser.error_status(), 505);
+}
+
+TEST(HttpParserTest, RejectsMalformedHeaders) {
+    for (const char* raw : {"GET / HTTP/1.1\r\nNoColon\r\n\r\n",
+                            "GET / HTTP/1.1\r\nBad Name: x\r\n\r\n",
+                            "GET / HTTP/1.1\r\nHost : x\r\n\r\n",
+                            "GET / HTTP/1.1\r\nHost: x\r\n folded\r\n\r\n",
+                            "GET / HTTP/1.1\r\nHost: a\x01" "b\r\n\r\n"}) {
+        RequestParser parser;
+        EXPECT_EQ(parser.parse(raw), RequestParser::Result::Error) << raw;
+        EXPECT_EQ(parser.error_status(), 400) << raw;
+    }
+}
+
+TEST(HttpParserTest, RejectsOversizedHead) {
+    RequestParser parser(64);
+    std::string raw = "GET / HTTP/1.1\r\nX-Filler: " + std::string(100, 'a');
+    EXPECT_EQ(parser.parse(raw), RequestParser::Result::Error);
+    EXPECT_EQ(parser.error_status(), 431);
+}
+
+TEST(HttpParserTest, RejectsTooManyHeaders) {
+    std::string raw = "GET / HTTP/1.1\r\n";
+    for (size_t i = 0; i <= MAX_HEADER_COUNT; ++i) {
+        raw += "X-H: v\r\n";
+    }
+    raw += "\r\n";
+    RequestParser parser(64 * 1024);
+    EXPECT_EQ(parser.parse(raw), RequestParser::Result::Error);
+    EXPECT_EQ(parser.error_status(), 431);
+}
+
+TEST(HttpParserTest, ContentLengthIsStrict) {
+    EXPECT_EQ(parse_content_length("0"), 0);
+    EXPECT_EQ(parse_content_length("1024"), 1024);
+    EXPECT_EQ(parse_content_length(""), -1);
+    EXPECT_EQ(parse_content_length("-5"), -1);
+    EXPECT_EQ(parse_content_length("12abc"), -1);
+    EXPECT_EQ(parse_content_length("99999999999999999999"), -1);
+}
+
+namespace {
+
+// Decode a whole chunked body fed in pieces of at most step bytes, the way
+// the session does: unconsumed bytes stay in front of the next piece
+ChunkedDecoder::Result decode_all(const std::string& raw, size_t step, std::string& body, size_t& rest) {
+    ChunkedDecoder decoder;
+    std::string buffer;
+    size_t fed = 0;
+    body.clear();
+    while (true) {
+        size_t take = std::min(step, raw.size() - fed);
+        buffer.append(raw, fed, take);
+        fed += take;
+        size_t consumed = 0;
+        std::string_view data;
+        ChunkedDecoder::Result result = decoder.decode(buffer, consumed, data);
+        if (result == ChunkedDecoder::Result::Data) body.append(data);
+        buffer.erase(0, consumed);
+        if (result == ChunkedDecoder::Result::Done || result == ChunkedDecoder::Result::Error) {
+            rest = buffer.size() + (raw.size() - fed);
+            return result;
+        }
+        if (result == ChunkedDecoder::Result::NeedMore && fed == raw.size()) {
+            return result;
+        }
+    }
+}
+
+}  // namespace
+
+TEST(ChunkedDecoderTest, DecodesChunksAcrossAnySplit) {
+    std::string raw = "5\r\nhello\r\n7;name=value\r\n, world\r\nA\r\n0123456789\r\n0\r\nX-Checksum: 1\r\n\r\nGET /next";
+    for (size_t step : {size_t(1), size_t(3), size_t(16), raw.size()}) {
+        std::string body;
+        size_t rest = 0;
+        ASSERT_EQ(decode_all(raw, step, body, rest), ChunkedDecoder::Result::Done) << "step " << step;
+        EXPECT_EQ(body, "hello, world0123456789");
+        EXPECT_EQ(rest, 9u);  // The pipelined request after the body is left alone
+    }
+}
+
+TEST(ChunkedDecoderTest, DataIsAViewIntoTheInput) {
+    std::string raw = "4\r\nabcd\r\n0\r\n\r\n";
+    ChunkedDecoder decoder;
+    size_t consumed = 0;
+    std::string_view data;
+    ASSERT_EQ(decoder.decode(raw, consumed, data), ChunkedDecoder::Result::Data);
+    EXPECT_EQ(data, "abcd");
+    EXPECT_EQ(data.data(), raw.data() + 3);
+    ASSERT_EQ(decoder.decode(std::string_view(raw).substr(consumed), consumed, data), ChunkedDecoder::Result::Done);
+}
+
+TEST(ChunkedDecoderTest, AcceptsBareLineFeeds) {
+    std::string body;
+    size_t rest = 0;
+    EXPECT_EQ(decode_all("3\nabc\n0\n\n", 4, body, rest), ChunkedDecoder::Result::Done);
+    EXPECT_EQ(body, "abc");
+}
+
+TEST(ChunkedDecoderTest, RejectsMalformedFraming) {
+    std::string body;
+    size_t rest = 0;
+    EXPECT_EQ(decode_all("\r\nabc\r\n0\r\n\r\n", 64, body, rest), ChunkedDecoder::Result::Error);    // No size
+    EXPECT_EQ(decode_all("z\r\n", 64, body, rest), ChunkedDecoder::Result::Error);                   // Not hex
+    EXPECT_EQ(decode_all("3\r\nabcd\r\n0\r\n\r\n", 64, body, rest), ChunkedDecoder::Result::Error);  // Size lied
+    EXPECT_EQ(decode_all("3\rabc\r\n", 64, body, rest), ChunkedDecoder::Result::Error);             // Bare CR
+    EXPECT_EQ(decode_all("1000000000000000\r\n", 64, body, rest), ChunkedDecoder::Result::Error);   // Too large
+    std::string long_extension = "1;" + std::string(9000, 'x') + "\r\na\r\n0\r\n\r\n";
+    EXPECT_EQ(decode_all(long_extension, 64, body, rest), ChunkedDecoder::Result::Error);
+    std::string long_trailers = "0\r\n" + std::string(9000, 'x') + "\r\n\r\n";
+    EXPECT_EQ(decode_all(long_trailers, 64, body, rest), ChunkedDecoder::Result::Error);
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include "../include/metrics.hpp"
+#include "../include/router.hpp"
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::chrono::nanoseconds;
+
+TEST(MetricsTest, LatencyBucketsAreLogLinear) {
+    for (std::uint64_t ns = 0; ns < 8; ++ns) {
+        EXPECT_EQ(latency_bucket(ns), ns);
+    }
+    EXPECT_EQ(latency_bucket(8), 8u);
+    EXPECT_EQ(latency_bucket(15), 15u);
+    EXPECT_EQ(latency_bucket(16), 16u);
+    EXPECT_EQ(latency_bucket(17), 16u);  // Buckets two wide from 16
+    EXPECT_EQ(latency_bucket(~std::uint64_t{0}), LATENCY_BUCKET_COUNT - 1);
+
+    // Every value lies inside its bucket, and a bucket is at most 1/8 of
+    // its lower bound wide
+    for (std::uint64_t ns = 1; ns < (std::uint64_t{1} << 36); ns = ns * 5 / 4 + 1) {
+        size_t bucket = latency_bucket(ns);
+        std::uint64_t limit = latency_bucket_limit(bucket);
+        std::uint64_t lower = bucket ? latency_bucket_limit(bucket - 1) : 0;
+        ASSERT_LT(ns, limit) << ns;
+        ASSERT_GE(ns, lower) << ns;
+        ASSERT_LE((limit - lower) * 8, std::max<std::uint64_t>(lower, 8)) << ns;
+    }
+}
+
+TEST(MetricsTest, SumsCountersAcrossThreads) {
+    std::uint64_t before = counter_value(Counter::ConnectionsAccepted);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([]() {
+            for (int i = 0; i < 1000; ++i) count(Counter::ConnectionsAccepted);
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+    // Shards outlive their threads
+    EXPECT_EQ(counter_value(Counter::ConnectionsAccepted) - before, 4000u);
+}
+
+TEST(MetricsTest, CountsResponsesByStatusClass) {
+    std::uint64_t requests = counter_value(Counter::Requests);
+    std::uint64_t ok = counter_value(Counter::Responses2xx);
+    std::uint64_t missing = counter_value(Counter::Responses4xx);
+    std::uint64_t bytes = counter_value(Counter::ResponseBodyBytes);
+    count_response(200, 10);
+    count_response(204, 0);
+    count_response(404, 5);
+    EXPECT_EQ(counter_value(Counter::Requests) - requests, 3u);
+    EXPECT_EQ(counter_value(Counter::Responses2xx) - ok, 2u);
+    EXPECT_EQ(counter_value(Counter::Responses4xx) - missing, 1u);
+    EXPECT_EQ(counter_value(Counter::ResponseBodyBytes) - bytes, 15u);
+}
+
+TEST(MetricsTest, PercentilesAreWithinABucket) {
+    // Sessions in other tests record writes too: compare with a baseline
+    LatencySnapshot before = phase_snapshot(Phase::Write);
+    std::thread recorder([]() {
+        for (int i = 1; i <= 1000; ++i) {
+            record_phase(Phase::Write, nanoseconds(i * 1000));  // 1 us .. 1 ms
+        }
+    });
+    recorder.join();
+    LatencySnapshot after = phase_snapshot(Phase::Write);
+
+    LatencySnapshot delta;
+    for (size_t i = 0; i < LATENCY_BUCKET_COUNT; ++i) {
+        delta.buckets[i] = after.buckets[i] - before.buckets[i];
+    }
+    delta.count = after.count - before.count;
+    delta.sum_ns = after.sum_ns - before.sum_ns;
+    ASSERT_EQ(delta.count, 1000u);
+    EXPECT_EQ(delta.sum_ns, 500500u * 1000u);
+
+    std::uint64_t p50 = delta.quantile_ns(0.5);
+    std::uint64_t p99 = delta.quantile_ns(0.99);
+    EXPECT_GE(p50, 500000u);
+    EXPECT_LE(p50, 500000u * 9 / 8 + 1);
+    EXPECT_GE(p99, 990000u);
+    EXPECT_LE(p99, 990000u * 9 / 8 + 1);
+    EXPECT_EQ(LatencySnapshot().quantile_ns(0.5), 0u);
+}
+
+TEST(MetricsTest, SampledTimerRecordsOneScopeInPeriod) {
+    std::uint64_t before = phase_snapshot(Phase::CacheLookup).count;
+    std::thread sampler([]() {
+        for (unsigned i = 0; i < 2 * PHASE_SAMPLE_PERIOD; ++i) {
+            SampledPhaseTimer timer(Phase::CacheLookup);
+        }
+    });
+    sampler.join();
+    EXPECT_EQ(phase_snapshot(Phase::CacheLookup).count - before, 2u);
+}
+
+TEST(MetricsTest, ServesPrometheusText) {
+    record_phase(Phase::Parse, nanoseconds(700));
+    add_metrics_gauge("tez_test_gauge", "A gauge from the test.", []() { return 42.0; });
+
+    Request request;
+    request.method = "GET";
+    request.path = "/metrics";
+    ResponsePtr response = route_request(request);
+    clear_metrics_gauges();
+
+    EXPECT_EQ(response->status, "200 OK");
+    EXPECT_EQ(response->content_type, "text/plain; version=0.0.4; charset=utf-8");
+    EXPECT_EQ(response->cache_control, "no-store");
+    const std::string& body = response->body;
+    EXPECT_NE(body.find("# TYPE tez_requests_total counter\n"), std::string::npos);
+    EXPECT_NE(body.find("# TYPE tez_connections_open gauge\n"), std::string::npos);
+    EXPECT_NE(body.find("tez_responses_total{code=\"2xx\"} "), std::string::npos);
+    EXPECT_NE(body.find("# TYPE tez_phase_duration_seconds histogram\n"), std::string::npos);
+    EXPECT_NE(body.find("tez_phase_duration_seconds_bucket{phase=\"parse\",le=\"1.024e-06\"} "), std::string::npos);
+    EXPECT_NE(body.find("tez_phase_duration_seconds_bucket{phase=\"parse\",le=\"+Inf\"} "), std::string::npos);
+    EXPECT_NE(body.find("tez_phase_duration_quantile_seconds{phase=\"route\",quantile=\"0.99\"} "),
+              std::string::npos);
+    EXPECT_NE(body.find("tez_cache_hits_total{cache=\"response\"} "), std::string::npos);
+    EXPECT_NE(body.find("tez_cache_hits_total{cache=\"file\"} "), std::string::npos);
+    EXPECT_NE(body.find("tez_test_gauge 42\n"), std::string::npos);
+
+    // Each family is declared once, before its samples
+    size_t declared = body.find("# TYPE tez_cache_misses_total");
+    EXPECT_EQ(body.find("# TYPE tez_cache_misses_total", declared + 1), std::string::npos);
+    EXPECT_LT(declared, body.find("tez_cache_misses_total{"));
+}
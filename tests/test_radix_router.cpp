@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include "../include/radix_router.hpp"
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// A handler whose response body names the route it was registered for
+RouteHandler named(const std::string& name) {
+    ResponsePtr resp = make_response("200 OK", "text/plain", name);
+    return [resp](const Request&, const RouteParams&) { return resp; };
+}
+
+std::string route_of(const RadixRouter& router, std::string_view method, std::string_view path) {
+    RouteMatch match = router.find(method, path);
+    return match.handler ? (*match.handler)(Request{}, match.params)->body : "";
+}
+
+}  // namespace
+
+TEST(RadixRouterTest, MatchesStaticRoutesExactly) {
+    RadixRouter router;
+    router.add("GET", "/", named("root"));
+    router.add("GET", "/api", named("api"));
+    router.add("GET", "/api/data", named("data"));
+    router.add("GET", "/about", named("about"));
+    EXPECT_EQ(router.size(), 4u);
+
+    EXPECT_EQ(route_of(router, "GET", "/"), "root");
+    EXPECT_EQ(route_of(router, "GET", "/api"), "api");
+    EXPECT_EQ(route_of(router, "GET", "/api/data"), "data");
+    EXPECT_EQ(route_of(router, "GET", "/about"), "about");
+    EXPECT_EQ(route_of(router, "GET", "/ap"), "");
+    EXPECT_EQ(route_of(router, "GET", "/api/"), "");
+    EXPECT_EQ(route_of(router, "GET", "/api/data/x"), "");
+    EXPECT_EQ(route_of(router, "GET", ""), "");
+}
+
+TEST(RadixRouterTest, CapturesParamsAndWildcards) {
+    RadixRouter router;
+    router.add("GET", "/users/{id}", named("user"));
+    router.add("GET", "/users/{id}/posts/{post}", named("post"));
+    router.add("GET", "/static/{*path}", named("static"));
+
+    RouteMatch match = router.find("GET", "/users/42/posts/7");
+    ASSERT_TRUE(match.handler);
+    ASSERT_EQ(match.params.size(), 2u);
+    EXPECT_EQ(match.params.name(0), "id");
+    EXPECT_EQ(match.params.value(1), "7");
+    EXPECT_EQ(match.params.get("id"), "42");
+    EXPECT_EQ(match.params.get("post"), "7");
+    EXPECT_EQ(match.params.get("missing"), "");
+
+    EXPECT_EQ(route_of(router, "GET", "/users/42"), "user");
+    EXPECT_EQ(route_of(router, "GET", "/users/"), "");  // Captures are never empty
+    EXPECT_EQ(route_of(router, "GET", "/users/42/posts"), "");
+
+    match = router.find("GET", "/static/css/site.css");
+    ASSERT_TRUE(match.handler);
+    EXPECT_EQ(match.params.get("path"), "css/site.css");
+    match = router.find("GET", "/static/");
+    ASSERT_TRUE(match.handler);
+    EXPECT_EQ(match.params.get("path"), "");
+    EXPECT_EQ(route_of(router, "GET", "/static"), "");
+}
+
+TEST(RadixRouterTest, StaticBeatsParamBeatsWildcard) {
+    RadixRouter router;
+    router.add("GET", "/files/export", named("export"));
+    router.add("GET", "/files/{name}", named("file"));
+    router.add("GET", "/files/{name}/meta", named("meta"));
+    router.add("GET", "/files/{*rest}", named("rest"));
+
+    EXPECT_EQ(route_of(router, "GET", "/files/export"), "export");
+    EXPECT_EQ(route_of(router, "GET", "/files/exports"), "file");  // Static branch dead-ends
+    EXPECT_EQ(route_of(router, "GET", "/files/export/meta"), "meta");
+    EXPECT_EQ(route_of(router, "GET", "/files/a/b/c"), "rest");
+    EXPECT_EQ(route_of(router, "GET", "/files/"), "rest");
+}
+
+TEST(RadixRouterTest, UnroutedMethodGetsPrebuilt405WithAllow) {
+    RadixRouter router;
+    router.add("GET", "/api/data", named("list"));
+    router.add("POST", "/api/data", named("create"));
+    router.add("DELETE", "/api/data/{id}", named("delete"));
+
+    EXPECT_EQ(route_of(router, "POST", "/api/data"), "create");
+
+    RouteMatch match = router.find("PATCH", "/api/data");
+    EXPECT_FALSE(match.handler);
+    ASSERT_TRUE(match.method_not_allowed);
+    const Response& resp = **match.method_not_allowed;
+    EXPECT_EQ(resp.status, "405 Method Not Allowed");
+    EXPECT_EQ(resp.allow, "GET, HEAD, POST");
+    EXPECT_NE(resp.head.find("\r\nAllow: GET, HEAD, POST\r\n"), std::string::npos);
+    EXPECT_EQ(router.find("PATCH", "/api/data").method_not_allowed, match.method_not_allowed);
+
+    EXPECT_EQ((*router.find("GET", "/api/data/9").method_not_allowed)->allow, "DELETE");
+
+    match = router.find("GET", "/nowhere");
+    EXPECT_FALSE(match.handler);
+    EXPECT_FALSE(match.method_not_allowed);
+}
+
+TEST(RadixRouterTest, HeadFallsBackToGet) {
+    RadixRouter router;
+    router.add("GET", "/api/data/{id}", named("get"));
+    router.add("GET", "/explicit", named("get explicit"));
+    router.add("HEAD", "/explicit", named("head explicit"));
+    router.add("POST", "/upload", named("upload"));
+
+    RouteMatch match = router.find("HEAD", "/api/data/7");
+    ASSERT_TRUE(match.handler);
+    EXPECT_EQ(match.params.get("id"), "7");
+    EXPECT_EQ(route_of(router, "HEAD", "/explicit"), "head explicit");
+
+    // No GET, no HEAD
+    match = router.find("HEAD", "/upload");
+    EXPECT_FALSE(match.handler);
+    ASSERT_TRUE(match.method_not_allowed);
+    EXPECT_EQ((*match.method_not_allowed)->allow, "POST");
+    EXPECT_EQ((*router.find("DELETE", "/explicit").method_not_allowed)->allow, "GET, HEAD");
+}
+
+TEST(RadixRouterTest, RejectsBadPatterns) {
+    RadixRouter router;
+    router.add("GET", "/a/{id}", named("a"));
+    EXPECT_THROW(router.add("GET", "a", named("x")), std::invalid_argument);
+    EXPECT_THROW(router.add("GET", "/a/{id}", named("x")), std::invalid_argument);     // Already routed
+    EXPECT_THROW(router.add("GET", "/a/{name}/b", named("x")), std::invalid_argument); // Other name
+    EXPECT_THROW(router.add("GET", "/b/x{id}", named("x")), std::invalid_argument);
+    EXPECT_THROW(router.add("GET", "/b/{id}x", named("x")), std::invalid_argument);
+    EXPECT_THROW(router.add("GET", "/b/{id", named("x")), std::invalid_argument);
+    EXPECT_THROW(router.add("GET", "/b/id}", named("x")), std::invalid_argument);
+    EXPECT_THROW(router.add("GET", "/b/{}", named("x")), std::invalid_argument);
+    EXPECT_THROW(router.add("GET", "/b/{*rest}/c", named("x")), std::invalid_argument);
+    EXPECT_THROW(router.add("GET", "/{a}/{b}/{c}/{d}/{e}/{f}/{g}/{h}/{i}", named("x")), std::invalid_argument);
+
+    router.add("POST", "/a/{id}", named("b"));  // Same pattern, new method
+    EXPECT_EQ(router.size(), 2u);
+}
+
+TEST(RadixRouterTest, SplitsEdgesInAnyInsertionOrder) {
+    RadixRouter forward;
+    RadixRouter backward;
+    const char* paths[] = {"/contact", "/con", "/co", "/contact/{id}", "/cart", "/c"};
+    for (const char* path : paths) forward.add("GET", path, named(path));
+    for (size_t i = std::size(paths); i-- > 0;) backward.add("GET", paths[i], named(paths[i]));
+
+    for (const RadixRouter* router : {&forward, &backward}) {
+        for (const char* path : {"/contact", "/con", "/co", "/cart", "/c"}) {
+            EXPECT_EQ(route_of(*router, "GET", path), path);
+        }
+        EXPECT_EQ(route_of(*router, "GET", "/contact/5"), "/contact/{id}");
+        EXPECT_EQ(route_of(*router, "GET", "/cont"), "");
+    }
+}
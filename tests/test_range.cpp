@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include "../include/range.hpp"
+#include <string>
+#include <vector>
+
+namespace {
+
+Response text_response(const std::string& body) {
+    Response resp;
+    resp.status = "200 OK";
+    resp.content_type = "text/plain; charset=utf-8";
+    resp.body = body;
+    resp.etag = "\"abc-1a\"";
+    resp.last_modified = 784111777;  // Sun, 06 Nov 1994 08:49:37 GMT
+    resp.accept_ranges = true;
+    return resp;
+}
+
+}  // namespace
+
+TEST(RangeTest, ParsesSingleAndSuffixRanges) {
+    std::vector<ByteRange> ranges;
+    ASSERT_EQ(parse_byte_ranges("bytes=0-99", 1000, ranges), RangeResult::Satisfiable);
+    ASSERT_EQ(ranges.size(), 1u);
+    EXPECT_EQ(ranges[0].first, 0u);
+    EXPECT_EQ(ranges[0].last, 99u);
+
+    ASSERT_EQ(parse_byte_ranges("bytes=900-", 1000, ranges), RangeResult::Satisfiable);
+    EXPECT_EQ(ranges[0].first, 900u);
+    EXPECT_EQ(ranges[0].last, 999u);
+
+    // Past the end is clamped, a suffix longer than the file is all of it
+    ASSERT_EQ(parse_byte_ranges("Bytes = 990-5000", 1000, ranges), RangeResult::Satisfiable);
+    EXPECT_EQ(ranges[0].last, 999u);
+    ASSERT_EQ(parse_byte_ranges("bytes=-5000", 1000, ranges), RangeResult::Satisfiable);
+    EXPECT_EQ(ranges[0].first, 0u);
+    EXPECT_EQ(ranges[0].length(), 1000u);
+}
+
+TEST(RangeTest, SortsAndMergesMultipleRanges) {
+    std::vector<ByteRange> ranges;
+    ASSERT_EQ(parse_byte_ranges("bytes=500-599, 0-9, 10-19, ,-100", 1000, ranges), RangeResult::Satisfiable);
+    ASSERT_EQ(ranges.size(), 3u);
+    EXPECT_EQ(ranges[0].first, 0u);
+    EXPECT_EQ(ranges[0].last, 19u);  // Adjacent ranges merge
+    EXPECT_EQ(ranges[1].first, 500u);
+    EXPECT_EQ(ranges[2].first, 900u);
+}
+
+TEST(RangeTest, RejectsInvalidAndUnsatisfiableRanges) {
+    std::vector<ByteRange> ranges;
+    EXPECT_EQ(parse_byte_ranges("items=0-5", 1000, ranges), RangeResult::Ignore);
+    EXPECT_EQ(parse_byte_ranges("bytes=5-1", 1000, ranges), RangeResult::Ignore);
+    EXPECT_EQ(parse_byte_ranges("bytes=abc", 1000, ranges), RangeResult::Ignore);
+    EXPECT_EQ(parse_byte_ranges("bytes=", 1000, ranges), RangeResult::Ignore);
+    EXPECT_EQ(parse_byte_ranges("bytes=1000-", 1000, ranges), RangeResult::Unsatisfiable);
+    EXPECT_EQ(parse_byte_ranges("bytes=-0", 1000, ranges), RangeResult::Unsatisfiable);
+    EXPECT_EQ(parse_byte_ranges("bytes=0-", 0, ranges), RangeResult::Unsatisfiable);
+
+    std::string many = "bytes=0-0";
+    for (size_t i = 1; i <= MAX_BYTE_RANGES; ++i) many += "," + std::to_string(i * 2) + "-" + std::to_string(i * 2);
+    EXPECT_EQ(parse_byte_ranges(many, 1000, ranges), RangeResult::Ignore);
+}
+
+TEST(RangeTest, IfRangeNeedsAnExactValidator) {
+    Response resp = text_response("x");
+    std::string tag = "\"abc-1a\"";
+    std::string weak = "W/\"abc-1a\"";
+    std::string other = "\"other\"";
+    std::string date = "Sun, 06 Nov 1994 08:49:37 GMT";
+    std::string later = "Mon, 07 Nov 1994 08:49:37 GMT";
+    EXPECT_TRUE(if_range_matches(resp, nullptr));
+    EXPECT_TRUE(if_range_matches(resp, &tag));
+    EXPECT_FALSE(if_range_matches(resp, &weak));
+    EXPECT_FALSE(if_range_matches(resp, &other));
+    EXPECT_TRUE(if_range_matches(resp, &date));
+    EXPECT_FALSE(if_range_matches(resp, &later));
+}
+
+TEST(RangeTest, SlicesInMemoryBodies) {
+    ResponsePtr full = make_response(text_response("0123456789"));
+    std::string single = "bytes=2-4";
+    ResponsePtr partial = apply_range(full, &single, nullptr);
+    EXPECT_EQ(partial->status, "206 Partial Content");
+    EXPECT_EQ(partial->body, "234");
+    EXPECT_EQ(partial->content_range, "bytes 2-4/10");
+    EXPECT_EQ(partial->etag, full->etag);
+    EXPECT_NE(partial->head.find("Content-Range: bytes 2-4/10\r\nAccept-Ranges: bytes\r\n"), std::string::npos);
+    EXPECT_NE(partial->head.find("Content-Length: 3\r\n"), std::string::npos);
+
+    std::string multi = "bytes=0-0,-1";
+    ResponsePtr parts = apply_range(full, &multi, nullptr);
+    ASSERT_EQ(parts->content_type.rfind("multipart/byteranges; boundary=", 0), 0u);
+    std::string boundary = parts->content_type.substr(31);
+    EXPECT_EQ(parts->body, "--" + boundary + "\r\nContent-Type: text/plain; charset=utf-8\r\nContent-Range: bytes 0-0/10\r\n\r\n0"
+                           "\r\n--" + boundary + "\r\nContent-Type: text/plain; charset=utf-8\r\nContent-Range: bytes 9-9/10\r\n\r\n9"
+                           "\r\n--" + boundary + "--\r\n");
+
+    std::string past = "bytes=10-";
+    EXPECT_EQ(apply_range(full, &past, nullptr)->status, "416 Range Not Satisfiable");
+    EXPECT_EQ(apply_range(full, &past, nullptr)->content_range, "bytes */10");
+
+    // Stale If-Range, no Range, or a response without ranges: unchanged
+    std::string stale = "\"old\"";
+    EXPECT_EQ(apply_range(full, &single, &stale).get(), full.get());
+    EXPECT_EQ(apply_range(full, nullptr, nullptr).get(), full.get());
+    ResponsePtr route = make_response("200 OK", "text/plain", "0123456789");
+    EXPECT_EQ(apply_range(route, &single, nullptr).get(), route.get());
+}
+
+TEST(RangeTest, KeepsFileBodiesOnDisk) {
+    Response resp = text_response("");
+    resp.file = FileBody{"/srv/movie.mp4", 0, 1000, {}, {}};
+    ResponsePtr full = make_response(std::move(resp));
+
+    std::string single = "bytes=100-199";
+    ResponsePtr partial = apply_range(full, &single, nullptr);
+    ASSERT_TRUE(partial->file);
+    EXPECT_EQ(partial->file->offset, 100u);
+    EXPECT_EQ(partial->file->length, 100u);
+    EXPECT_TRUE(partial->body.empty());
+
+    std::string multi = "bytes=0-9,500-509";
+    ResponsePtr parts = apply_range(full, &multi, nullptr);
+    ASSERT_TRUE(parts->file);
+    ASSERT_EQ(parts->file->segments.size(), 2u);
+    EXPECT_EQ(parts->file->segments[1].offset, 500u);
+    EXPECT_EQ(parts->file->segments[1].length, 10u);
+    std::uint64_t total = parts->file->trailer.size();
+    for (const FileSegment& segment : parts->file->segments) total += segment.prefix.size() + segment.length;
+    EXPECT_EQ(parts->file->length, total);
+    EXPECT_NE(parts->head.find("Content-Length: " + std::to_string(total) + "\r\n"), std::string::npos);
+}
@@ -30,3 +30,110 @@ TEST(ResponseTest, CopyResponse) {
     EXPECT_EQ(resp2.content_type, resp1.content_type);
     EXPECT_EQ(resp2.body, resp1.body);
 }
+
+TEST(ResponseTest, MakeResponseSerializesHeadOnce) {
+    ResponsePtr resp = make_response("200 OK", "text/plain", "hello");
+    EXPECT_EQ(resp->head,
+              "HTTP/1.1 200 OK\r\n"
+              "Content-Type: text/plain\r\n"
+              "Server: Tez\r\n"
+              "Content-Length: 5\r\n");
+    EXPECT_EQ(resp->body, "hello");
+}
+
+TEST(ResponseTest, FileBodyHeadUsesFileLength) {
+    Response resp;
+    resp.status = "200 OK";
+    resp.content_type = "video/mp4";
+    resp.file = FileBody{"static/movie.mp4", 0, 4096, {}, {}};
+    std::string head;
+    append_response_head(head, resp);
+    EXPECT_NE(head.find("Content-Length: 4096\r\n"), std::string::npos);
+}
+
+TEST(ResponseTest, ValidatorsGoInBothHeads) {
+    Response resp;
+    resp.status = "200 OK";
+    resp.content_type = "text/css";
+    resp.body = "a{}";
+    resp.etag = "\"5f3-3\"";
+    resp.last_modified = 784111777;
+    resp.cache_control = "public, max-age=60";
+    resp.vary_accept_encoding = true;
+    ResponsePtr shared = make_response(resp);
+
+    EXPECT_EQ(shared->head,
+              "HTTP/1.1 200 OK\r\n"
+              "Content-Type: text/css\r\n"
+              "Vary: Accept-Encoding\r\n"
+              "ETag: \"5f3-3\"\r\n"
+              "Last-Modified: Sun, 06 Nov 1994 08:49:37 GMT\r\n"
+              "Cache-Control: public, max-age=60\r\n"
+              "Server: Tez\r\n"
+              "Content-Length: 3\r\n");
+    EXPECT_EQ(shared->not_modified_head,
+              "HTTP/1.1 304 Not Modified\r\n"
+              "Vary: Accept-Encoding\r\n"
+              "ETag: \"5f3-3\"\r\n"
+              "Last-Modified: Sun, 06 Nov 1994 08:49:37 GMT\r\n"
+              "Cache-Control: public, max-age=60\r\n"
+              "Server: Tez\r\n");
+
+    // No validators, no 304
+    EXPECT_TRUE(make_response("200 OK", "text/plain", "x")->not_modified_head.empty());
+}
+
+TEST(ResponseTest, EvaluatesConditionalHeaders) {
+    Response resp;
+    resp.status = "200 OK";
+    resp.content_type = "text/css";
+    resp.body = "a{}";
+    resp.etag = "\"abc-3\"";
+    resp.last_modified = 784111777;
+    ResponsePtr shared = make_response(resp);
+
+    std::string match = "\"abc-3\"";
+    std::string list = "\"other\", W/\"abc-3\"";
+    std::string star = "*";
+    std::string stale = "\"abc-2\"";
+    EXPECT_TRUE(is_not_modified(*shared, &match, nullptr));
+    EXPECT_TRUE(is_not_modified(*shared, &list, nullptr));
+    EXPECT_TRUE(is_not_modified(*shared, &star, nullptr));
+    EXPECT_FALSE(is_not_modified(*shared, &stale, nullptr));
+    EXPECT_FALSE(is_not_modified(*shared, nullptr, nullptr));
+
+    std::string same = "Sun, 06 Nov 1994 08:49:37 GMT";
+    std::string later = "Mon, 07 Nov 1994 08:49:37 GMT";
+    std::string earlier = "Sat, 05 Nov 1994 08:49:37 GMT";
+    std::string garbage = "yesterday";
+    EXPECT_TRUE(is_not_modified(*shared, nullptr, &same));
+    EXPECT_TRUE(is_not_modified(*shared, nullptr, &later));
+    EXPECT_FALSE(is_not_modified(*shared, nullptr, &earlier));
+    EXPECT_FALSE(is_not_modified(*shared, nullptr, &garbage));
+
+    // If-None-Match takes precedence over If-Modified-Since
+    EXPECT_FALSE(is_not_modified(*shared, &stale, &later));
+}
+
+TEST(ResponseTest, StreamHeadLeavesFramingToTheSession) {
+    Response resp;
+    resp.status = "200 OK";
+    resp.content_type = "text/plain";
+    resp.stream = make_generator_stream([](std::string&) { return false; });
+    ResponsePtr shared = make_response(std::move(resp));
+    EXPECT_EQ(shared->head.find("Content-Length"), std::string::npos);
+    EXPECT_EQ(shared->head.substr(shared->head.size() - 13), "Server: Tez\r\n");
+}
+
+TEST(ResponseTest, GeneratorStreamPullsUntilLastPiece) {
+    int calls = 0;
+    std::shared_ptr<BodyStream> stream = make_generator_stream([&calls](std::string& out) {
+        out += std::to_string(++calls);
+        return calls < 3;
+    });
+    std::string out;
+    EXPECT_EQ(stream->pull(out), BodyStream::Status::Data);
+    EXPECT_EQ(stream->pull(out), BodyStream::Status::Data);
+    EXPECT_EQ(stream->pull(out), BodyStream::Status::Done);
+    EXPECT_EQ(out, "123");
+}
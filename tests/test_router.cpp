@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 #include "../include/router.hpp"
+#include <atomic>
 #include <fstream>
+#include <thread>
+#include <vector>
 #include <nlohmann/json.hpp>
 
 class RouterTest : public ::testing::Test {
@@ -29,30 +32,150 @@ protected:
 
     void TearDown() override {
         std::remove("test_config.json");
+        reload_router_config();  // Back to the real config.json
+    }
+
+    static void write_config(const std::string& text) {
+        std::ofstream("test_config.json") << text;
     }
 };
 
 TEST_F(RouterTest, HealthEndpoint) {
-    Response resp = handle_route("/health");
-    EXPECT_EQ(resp.status, "200 OK");
-    EXPECT_EQ(resp.content_type, "application/json");
-    EXPECT_EQ(resp.body, "{\"status\":\"ok\"}\n");
+    ResponsePtr resp = handle_route("/health");
+    EXPECT_EQ(resp->status, "200 OK");
+    EXPECT_EQ(resp->content_type, "application/json");
+    EXPECT_EQ(resp->body, "{\"status\":\"ok\"}\n");
 }
 
 TEST_F(RouterTest, NotFoundRoute) {
-    Response resp = handle_route("/nonexistent");
-    EXPECT_EQ(resp.status, "404 Not Found");
-    EXPECT_EQ(resp.content_type, "text/html; charset=utf-8");
-    EXPECT_NE(resp.body.find("Page Not Found"), std::string::npos);
+    ResponsePtr resp = handle_route("/nonexistent");
+    EXPECT_EQ(resp->status, "404 Not Found");
+    EXPECT_EQ(resp->content_type, "text/html; charset=utf-8");
+    EXPECT_NE(resp->body.find("Page Not Found"), std::string::npos);
 }
 
 TEST_F(RouterTest, CachingWorks) {
     // First call - should load from config
-    Response resp1 = handle_route("/health");
+    ResponsePtr resp1 = handle_route("/health");
 
     // Second call - should come from cache
-    Response resp2 = handle_route("/health");
+    ResponsePtr resp2 = handle_route("/health");
+
+    EXPECT_EQ(resp1->body, resp2->body);
+    EXPECT_EQ(resp1->status, resp2->status);
+}
+
+TEST_F(RouterTest, ConfigRoutesAreBuiltOnce) {
+    ASSERT_TRUE(load_router_config("test_config.json"));
+    ResponsePtr resp = handle_route("/test");
+    EXPECT_EQ(resp->status, "200 OK");
+    EXPECT_EQ(resp->content_type, "text/plain");
+    EXPECT_EQ(resp->body, "Test response");
+    EXPECT_EQ(handle_route("/test"), resp);  // Same prebuilt response
+    EXPECT_EQ(handle_route("/json")->body, "{\"test\":true}");
+    EXPECT_EQ(handle_route("/about")->status, "404 Not Found");
+}
+
+TEST_F(RouterTest, ReloadReplacesRoutes) {
+    ASSERT_TRUE(load_router_config("test_config.json"));
+    ResponsePtr before = handle_route("/test");
+
+    write_config("{\"/test\": {\"status\": \"200 OK\", \"content_type\": \"text/plain\", \"body\": \"v2\"}}");
+    ASSERT_TRUE(load_router_config("test_config.json"));
+    EXPECT_EQ(handle_route("/test")->body, "v2");
+    EXPECT_EQ(handle_route("/json")->status, "404 Not Found");
+    EXPECT_EQ(before->body, "Test response");  // In-flight responses are untouched
+}
+
+TEST_F(RouterTest, FailedReloadKeepsCurrentRoutes) {
+    ASSERT_TRUE(load_router_config("test_config.json"));
+
+    write_config("{\"/test\": {\"status\": \"200 OK\"");  // Truncated
+    EXPECT_FALSE(load_router_config("test_config.json"));
+    write_config("{\"/test\": {\"status\": \"200 OK\"}}");  // Missing fields
+    EXPECT_FALSE(load_router_config("test_config.json"));
+    EXPECT_FALSE(load_router_config("does_not_exist.json"));
+
+    EXPECT_EQ(handle_route("/test")->body, "Test response");
+}
+
+TEST_F(RouterTest, ReadersNeverSeeAHalfBuiltTable) {
+    std::ofstream("test_config_b.json")
+        << "{\"/test\": {\"status\": \"200 OK\", \"content_type\": \"text/plain\", \"body\": \"B\"}}";
+    ASSERT_TRUE(load_router_config("test_config.json"));
+
+    std::atomic<bool> done{false};
+    std::atomic<int> bad{0};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&]() {
+            while (!done.load()) {
+                ResponsePtr resp = handle_route("/test");
+                if (resp->body != "Test response" && resp->body != "B") ++bad;
+            }
+        });
+    }
+    for (int i = 0; i < 50; ++i) {
+        ASSERT_TRUE(load_router_config(i % 2 ? "test_config.json" : "test_config_b.json"));
+    }
+    done = true;
+    for (auto& reader : readers) reader.join();
+    std::remove("test_config_b.json");
+    EXPECT_EQ(bad.load(), 0);
+}
+
+TEST_F(RouterTest, RoutesMethodsAndCaptures) {
+    Request request;
+    request.method = "GET";
+    request.path = "/api/data/42";
+    ResponsePtr resp = route_request(request);
+    EXPECT_EQ(resp->status, "200 OK");
+    EXPECT_EQ(resp->body, "{\"id\":\"42\"}\n");
+
+    request.method = "PATCH";
+    request.path = "/api/data";
+    resp = route_request(request);
+    EXPECT_EQ(resp->status, "405 Method Not Allowed");
+    EXPECT_EQ(resp->allow, "GET, HEAD, POST, PUT, DELETE");
+
+    // HEAD goes to the GET handler
+    request.method = "HEAD";
+    request.path = "/health";
+    EXPECT_EQ(route_request(request)->status, "200 OK");
+
+    // Config routes are GET (and so HEAD) only
+    ASSERT_TRUE(load_router_config("test_config.json"));
+    request.method = "POST";
+    request.path = "/test";
+    resp = route_request(request);
+    EXPECT_EQ(resp->status, "405 Method Not Allowed");
+    EXPECT_EQ(resp->allow, "GET, HEAD");
+
+    request.path = "/nonexistent";
+    EXPECT_EQ(route_request(request)->status, "404 Not Found");
+}
+
+namespace {
+
+ResponsePtr tag_teapot(const Request& request, Next next) {
+    if (request.path == "/teapot") {
+        return make_response("418 I'm a teapot", "text/plain", "short and stout\n");
+    }
+    return next(request);
+}
+
+}  // namespace
+
+TEST_F(RouterTest, EmbeddersAddRoutesAndMiddleware) {
+    add_route("GET", "/embedded/{name}", [](const Request&, const RouteParams& params) {
+        return make_response("200 OK", "text/plain", "hello " + std::string(params.get("name")));
+    });
+    EXPECT_THROW(add_route("GET", "/health", nullptr), std::invalid_argument);
+    EXPECT_EQ(handle_route("/embedded/tez")->body, "hello tez");
 
-    EXPECT_EQ(resp1.body, resp2.body);
-    EXPECT_EQ(resp1.status, resp2.status);
+    add_middleware(tag_teapot);
+    EXPECT_EQ(handle_route("/teapot")->status, "418 I'm a teapot");  // Would be a 404
+    EXPECT_EQ(handle_route("/embedded/tez")->body, "hello tez");
+    clear_middleware();
+    EXPECT_EQ(handle_route("/teapot")->status, "404 Not Found");
 }
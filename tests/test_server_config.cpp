@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include "../include/server_config.hpp"
+#include <cstdio>
+#include <fstream>
+
+class ServerConfigTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        std::remove("test_server_config.json");
+    }
+
+    void write_config(const std::string& contents) {
+        std::ofstream config_file("test_server_config.json");
+        config_file << contents;
+    }
+};
+
+TEST_F(ServerConfigTest, DefaultsWhenFileMissing) {
+    ServerConfig config = load_server_config("does_not_exist.json");
+    EXPECT_EQ(config.port, 8080);
+    EXPECT_EQ(config.reactors, 0u);
+    EXPECT_FALSE(config.pin_reactors);
+}
+
+TEST_F(ServerConfigTest, DefaultsWithoutServerSection) {
+    write_config("{\"/\": {\"status\": \"200 OK\", \"content_type\": \"text/plain\", \"body\": \"hi\"}}");
+    ServerConfig config = load_server_config("test_server_config.json");
+    EXPECT_EQ(config.port, 8080);
+    EXPECT_EQ(config.reactors, 0u);
+}
+
+TEST_F(ServerConfigTest, ReadsServerSection) {
+    write_config("{\"server\": {\"port\": 9090, \"threads\": 2, \"reactors\": 4, \"pin_reactors\": true}}");
+    ServerConfig config = load_server_config("test_server_config.json");
+    EXPECT_EQ(config.port, 9090);
+    EXPECT_EQ(config.threads, 2u);
+    EXPECT_EQ(config.reactors, 4u);
+    EXPECT_TRUE(config.pin_reactors);
+    EXPECT_TRUE(config.watch_static);
+}
+
+TEST_F(ServerConfigTest, WatchedStaticFilesNeverExpire) {
+    ServerConfig config = load_server_config("does_not_exist.json");
+    EXPECT_TRUE(config.watch_static);
+    EXPECT_EQ(config.file_cache.ttl_seconds, 0);
+
+    write_config("{\"server\": {\"watch_static\": false}}");
+    EXPECT_FALSE(load_server_config("test_server_config.json").watch_static);
+}
+
+TEST_F(ServerConfigTest, ConfigWatchCanBeDisabled) {
+    EXPECT_TRUE(load_server_config("does_not_exist.json").watch_config);
+    write_config("{\"server\": {\"watch_config\": false}}");
+    EXPECT_FALSE(load_server_config("test_server_config.json").watch_config);
+}
+
+TEST_F(ServerConfigTest, MalformedFileFallsBackToDefaults) {
+    write_config("{\"server\": {\"reactors\": \"many\"}}");
+    ServerConfig config = load_server_config("test_server_config.json");
+    EXPECT_EQ(config.reactors, 0u);
+}
+
+TEST_F(ServerConfigTest, CacheDefaults) {
+    ServerConfig config = load_server_config("does_not_exist.json");
+    EXPECT_EQ(config.response_cache.max_entries, 100u);
+    EXPECT_GT(config.response_cache.max_bytes, 0u);
+    EXPECT_FALSE(config.response_cache.admission);
+    EXPECT_GT(config.file_cache.max_bytes, 0u);
+    EXPECT_TRUE(config.file_cache.admission);
+}
+
+TEST_F(ServerConfigTest, ReadsCacheSection) {
+    write_config("{\"cache\": {\"response\": {\"max_entries\": 10, \"max_bytes\": 4096, \"policy\": \"lru\"},"
+                 " \"file\": {\"max_bytes\": 1048576, \"ttl_seconds\": 5, \"policy\": \"tinylfu\"}}}");
+    ServerConfig config = load_server_config("test_server_config.json");
+    EXPECT_EQ(config.response_cache.max_entries, 10u);
+    EXPECT_EQ(config.response_cache.max_bytes, 4096u);
+    EXPECT_EQ(config.response_cache.policy, EvictionPolicy::Lru);
+    EXPECT_FALSE(config.response_cache.admission);
+    EXPECT_EQ(config.file_cache.max_bytes, 1048576u);
+    EXPECT_EQ(config.file_cache.ttl_seconds, 5);
+    EXPECT_EQ(config.file_cache.policy, EvictionPolicy::Clock);
+    EXPECT_TRUE(config.file_cache.admission);
+}
+
+TEST_F(ServerConfigTest, UnknownCachePolicyFallsBackToDefaults) {
+    write_config("{\"server\": {\"port\": 9090}, \"cache\": {\"file\": {\"policy\": \"random\"}}}");
+    ServerConfig config = load_server_config("test_server_config.json");
+    EXPECT_EQ(config.port, 8080);
+    EXPECT_TRUE(config.file_cache.admission);
+}
+
+TEST_F(ServerConfigTest, ReadsLogSection) {
+    write_config("{\"log\": {\"path\": \"access.log\", \"format\": \"json\", \"flush_interval_ms\": 250,"
+                 " \"max_bytes\": 1000000, \"max_files\": 3}}");
+    ServerConfig config = load_server_config("test_server_config.json");
+    EXPECT_TRUE(config.access_log.enabled);
+    EXPECT_EQ(config.access_log.path, "access.log");
+    EXPECT_TRUE(config.access_log.json);
+    EXPECT_EQ(config.access_log.flush_interval_ms, 250u);
+    EXPECT_EQ(config.access_log.max_bytes, 1000000u);
+    EXPECT_EQ(config.access_log.max_files, 3u);
+}
+
+TEST_F(ServerConfigTest, ReadsCompressionSection) {
+    write_config("{\"compression\": {\"level\": 9, \"min_bytes\": 1024}}");
+    ServerConfig config = load_server_config("test_server_config.json");
+    EXPECT_TRUE(config.compression.enabled);
+    EXPECT_EQ(config.compression.level, 9);
+    EXPECT_EQ(config.compression.min_bytes, 1024u);
+
+    // An out-of-range level falls back to the defaults
+    write_config("{\"compression\": {\"level\": 12}}");
+    EXPECT_EQ(load_server_config("test_server_config.json").compression.level, 6);
+}
+
+TEST_F(ServerConfigTest, ReadsCacheControlPolicies) {
+    write_config("{\"cache_control\": {\".css\": \"public, max-age=86400\", \"*\": \"no-cache\"}}");
+    ServerConfig config = load_server_config("test_server_config.json");
+    ASSERT_EQ(config.cache_control.size(), 2u);
+    EXPECT_EQ(config.cache_control[".css"], "public, max-age=86400");
+    EXPECT_EQ(config.cache_control["*"], "no-cache");
+
+    // Keys must be extensions
+    write_config("{\"cache_control\": {\"css\": \"no-store\"}}");
+    EXPECT_TRUE(load_server_config("test_server_config.json").cache_control.empty());
+}
@@ -0,0 +1,607 @@
+#include <gtest/gtest.h>
+#include "../include/session.hpp"
+#include "../include/file_server.hpp"
+#include "../include/metrics.hpp"
+#include "../include/middleware.hpp"
+#include "../include/router.hpp"
+#include <boost/asio.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+using boost::asio::ip::tcp;
+namespace asio = boost::asio;
+
+// Runs a real acceptor + Session on a loopback port for the duration of a test
+class SessionTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        acceptor = std::make_unique<tcp::acceptor>(io, tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+        port = acceptor->local_endpoint().port();
+        do_accept = [this]() {
+            acceptor->async_accept(asio::make_strand(io), [this](boost::system::error_code ec, tcp::socket socket) {
+                if (!ec) {
+                    std::make_shared<Session>(std::move(socket))->start();
+                    do_accept();
+                }
+            });
+        };
+        do_accept();
+        server_thread = std::thread([this]() { io.run(); });
+    }
+
+    void TearDown() override {
+        io.stop();
+        server_thread.join();
+        std::remove("server.log");
+    }
+
+    tcp::socket connect() {
+        tcp::socket socket(client_io);
+        socket.connect({asio::ip::address_v4::loopback(), port});
+        return socket;
+    }
+
+    // Read exactly one response (headers + Content-Length body)
+    static std::string read_response(tcp::socket& socket, std::string& buffer) {
+        size_t header_end = asio::read_until(socket, asio::dynamic_buffer(buffer), "\r\n\r\n");
+        std::string headers = buffer.substr(0, header_end);
+        size_t length = 0;
+        size_t pos = headers.find("Content-Length: ");
+        if (pos != std::string::npos) {
+            length = std::stoul(headers.substr(pos + 16));
+        }
+        if (buffer.size() < header_end + length) {
+            asio::read(socket, asio::dynamic_buffer(buffer), asio::transfer_exactly(header_end + length - buffer.size()));
+        }
+        std::string response = buffer.substr(0, header_end + length);
+        buffer.erase(0, header_end + length);
+        return response;
+    }
+
+    asio::io_context io;
+    asio::io_context client_io;
+    std::unique_ptr<tcp::acceptor> acceptor;
+    std::function<void()> do_accept;
+    std::thread server_thread;
+    unsigned short port = 0;
+};
+
+TEST_F(SessionTest, ServesKeepAliveRequests) {
+    tcp::socket socket = connect();
+    std::string buffer;
+    for (int i = 0; i < 3; ++i) {
+        asio::write(socket, asio::buffer(std::string("GET /health HTTP/1.1\r\nHost: localhost\r\n\r\n")));
+        std::string resp = read_response(socket, buffer);
+        EXPECT_EQ(resp.rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+        EXPECT_NE(resp.find("Connection: keep-alive"), std::string::npos);
+        EXPECT_NE(resp.find("{\"status\":\"ok\"}"), std::string::npos);
+    }
+}
+
+TEST_F(SessionTest, ClosesWhenRequested) {
+    tcp::socket socket = connect();
+    std::string buffer;
+    asio::write(socket, asio::buffer(std::string("GET /health HTTP/1.1\r\nConnection: close\r\n\r\n")));
+    std::string resp = read_response(socket, buffer);
+    EXPECT_NE(resp.find("Connection: close"), std::string::npos);
+
+    boost::system::error_code ec;
+    char byte;
+    socket.read_some(asio::buffer(&byte, 1), ec);
+    EXPECT_EQ(ec, asio::error::eof);
+}
+
+TEST_F(SessionTest, ReadsRequestBody) {
+    tcp::socket socket = connect();
+    std::string buffer;
+    asio::write(socket, asio::buffer(std::string("POST /echo HTTP/1.1\r\nContent-Length: 5\r\n\r\nhello")));
+    std::string resp = read_response(socket, buffer);
+    EXPECT_EQ(resp.rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+    EXPECT_NE(resp.find("\"received_body\": \"hello\""), std::string::npos);
+}
+
+TEST_F(SessionTest, RejectsOversizedBody) {
+    tcp::socket socket = connect();
+    std::string buffer;
+    asio::write(socket, asio::buffer(std::string("POST /echo HTTP/1.1\r\nContent-Length: 99999999\r\n\r\n")));
+    std::string resp = read_response(socket, buffer);
+    EXPECT_EQ(resp.rfind("HTTP/1.1 413 Payload Too Large\r\n", 0), 0u);
+}
+
+TEST_F(SessionTest, RejectsOversizedHeaders) {
+    tcp::socket socket = connect();
+    std::string buffer;
+    std::string req = "GET /health HTTP/1.1\r\nX-Filler: " + std::string(MAX_HEADER_SIZE, 'a') + "\r\n\r\n";
+    boost::system::error_code ec;
+    asio::write(socket, asio::buffer(req), ec);
+    std::string resp = read_response(socket, buffer);
+    EXPECT_EQ(resp.rfind("HTTP/1.1 431 Request Header Fields Too Large\r\n", 0), 0u);
+}
+
+TEST_F(SessionTest, AnswersPipelinedRequestsInOrder) {
+    tcp::socket socket = connect();
+    std::string buffer;
+    asio::write(socket, asio::buffer(std::string(
+        "GET /health HTTP/1.1\r\n\r\n"
+        "POST /echo HTTP/1.1\r\nContent-Length: 3\r\n\r\nabc"
+        "GET /api/data HTTP/1.1\r\n\r\n")));
+
+    std::string first = read_response(socket, buffer);
+    std::string second = read_response(socket, buffer);
+    std::string third = read_response(socket, buffer);
+    EXPECT_NE(first.find("{\"status\":\"ok\"}"), std::string::npos);
+    EXPECT_NE(second.find("\"received_body\": \"abc\""), std::string::npos);
+    EXPECT_NE(third.find("item1"), std::string::npos);
+}
+
+TEST_F(SessionTest, IgnoresStrayLineEndsAfterRequests) {
+    // A CRLF after a request (RFC 9112 2.2), alone in its read and then
+    // ahead of the next request
+    tcp::socket socket = connect();
+    std::string buffer;
+    asio::write(socket, asio::buffer(std::string("GET /health HTTP/1.1\r\nHost: x\r\n\r\n\r\n")));
+    std::string first = read_response(socket, buffer);
+    asio::write(socket, asio::buffer(std::string("\r\nGET /api/data HTTP/1.1\r\n\r\n")));
+    std::string second = read_response(socket, buffer);
+    EXPECT_NE(first.find("{\"status\":\"ok\"}"), std::string::npos);
+    EXPECT_NE(second.find("item1"), std::string::npos);
+}
+
+TEST_F(SessionTest, NothingCarriesOverBetweenRequests) {
+    tcp::socket socket = connect();
+    std::string buffer;
+    asio::write(socket, asio::buffer(std::string(
+        "POST /echo HTTP/1.1\r\nX-Trace: 1\r\nContent-Length: 3\r\n\r\nabc"
+        "POST /echo HTTP/1.1\r\nContent-Length: 0\r\n\r\n"
+        "PUT /echo HTTP/1.1\r\nContent-Length: 2\r\n\r\nde")));
+
+    std::string first = read_response(socket, buffer);
+    std::string second = read_response(socket, buffer);
+    std::string third = read_response(socket, buffer);
+    EXPECT_NE(first.find("\"received_body\": \"abc\""), std::string::npos);
+    EXPECT_NE(second.find("\"received_body\": \"\""), std::string::npos);
+    EXPECT_NE(third.find("\"method\": \"PUT\""), std::string::npos);
+    EXPECT_NE(third.find("\"received_body\": \"de\""), std::string::npos);
+}
+
+TEST_F(SessionTest, RecordsRequestMetrics) {
+    std::uint64_t requests = counter_value(Counter::Requests);
+    std::uint64_t parsed = phase_snapshot(Phase::Parse).count;
+    std::uint64_t routed = phase_snapshot(Phase::Route).count;
+    {
+        tcp::socket socket = connect();
+        std::string buffer;
+        asio::write(socket, asio::buffer(std::string("GET /health HTTP/1.1\r\n\r\nGET /nowhere HTTP/1.1\r\n\r\n")));
+        read_response(socket, buffer);
+        read_response(socket, buffer);
+    }
+    EXPECT_EQ(counter_value(Counter::Requests) - requests, 2u);
+    EXPECT_EQ(phase_snapshot(Phase::Parse).count - parsed, 2u);
+    EXPECT_EQ(phase_snapshot(Phase::Route).count - routed, 2u);
+}
+
+TEST_F(SessionTest, ReassemblesRequestsSplitAcrossReads) {
+    tcp::socket socket = connect();
+    std::string buffer;
+    std::string req = "POST /echo HTTP/1.1\r\nContent-Length: 5\r\n\r\nhelloGET /health HTTP/1.1\r\n\r\n";
+    for (char c : req) {
+        asio::write(socket, asio::buffer(&c, 1));
+    }
+    std::string first = read_response(socket, buffer);
+    std::string second = read_response(socket, buffer);
+    EXPECT_NE(first.find("\"received_body\": \"hello\""), std::string::npos);
+    EXPECT_NE(second.find("{\"status\":\"ok\"}"), std::string::npos);
+}
+
+TEST_F(SessionTest, StopsPipelineAtConnectionClose) {
+    tcp::socket socket = connect();
+    std::string buffer;
+    asio::write(socket, asio::buffer(std::string(
+        "GET /health HTTP/1.1\r\nConnection: close\r\n\r\n"
+        "GET /health HTTP/1.1\r\n\r\n")));
+    std::string first = read_response(socket, buffer);
+    EXPECT_NE(first.find("Connection: close"), std::string::npos);
+
+    boost::system::error_code ec;
+    asio::read(socket, asio::dynamic_buffer(buffer), ec);
+    EXPECT_EQ(ec, asio::error::eof);
+    EXPECT_TRUE(buffer.empty());
+}
+
+TEST_F(SessionTest, StreamsLargeFilesFromDisk) {
+    // 3 MB spans several send slices; the pipelined request after it must
+    // still be answered once the file is done
+    std::string content(3 * 1024 * 1024, '\0');
+    for (size_t i = 0; i < content.size(); ++i) {
+        content[i] = static_cast<char>('a' + i % 26);
+    }
+    {
+        std::ofstream file("../static/test_large.bin", std::ios::binary);
+        file << content;
+    }
+    set_sendfile_threshold(1024);
+
+    tcp::socket socket = connect();
+    std::string buffer;
+    asio::write(socket, asio::buffer(std::string(
+        "GET /static/test_large.bin HTTP/1.1\r\n\r\n"
+        "GET /health HTTP/1.1\r\n\r\n")));
+    std::string first = read_response(socket, buffer);
+    std::string second = read_response(socket, buffer);
+
+    set_sendfile_threshold(DEFAULT_SENDFILE_THRESHOLD);
+    std::remove("../static/test_large.bin");
+
+    EXPECT_EQ(first.rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+    EXPECT_NE(first.find("Content-Length: 3145728\r\n"), std::string::npos);
+    ASSERT_GE(first.size(), content.size());
+    EXPECT_EQ(first.compare(first.size() - content.size(), content.size(), content), 0);
+    EXPECT_NE(second.find("{\"status\":\"ok\"}"), std::string::npos);
+}
+
+TEST_F(SessionTest, AnswersHeadWithoutBody) {
+    // Small enough for writev, then large enough for sendfile: either way
+    // the pipelined GET's response must follow the HEAD's head directly
+    std::string content(4096, 'x');
+    {
+        std::ofstream file("../static/test_head.txt", std::ios::binary);
+        file << content;
+    }
+    for (size_t threshold : {DEFAULT_SENDFILE_THRESHOLD, size_t{1024}}) {
+        set_sendfile_threshold(threshold);
+        clear_file_cache();
+        tcp::socket socket = connect();
+        std::string buffer;
+        asio::write(socket, asio::buffer(std::string(
+            "HEAD /static/test_head.txt HTTP/1.1\r\n\r\n"
+            "GET /health HTTP/1.1\r\n\r\n")));
+        size_t head_end = asio::read_until(socket, asio::dynamic_buffer(buffer), "\r\n\r\n");
+        std::string head = buffer.substr(0, head_end);
+        buffer.erase(0, head_end);
+        std::string next = read_response(socket, buffer);
+
+        EXPECT_EQ(head.rfind("HTTP/1.1 200 OK\r\n", 0), 0u) << threshold;
+        EXPECT_NE(head.find("Content-Length: 4096\r\n"), std::string::npos) << threshold;
+        EXPECT_EQ(next.rfind("HTTP/1.1 200 OK\r\n", 0), 0u) << threshold;
+        EXPECT_NE(next.find("{\"status\":\"ok\"}"), std::string::npos) << threshold;
+    }
+    set_sendfile_threshold(DEFAULT_SENDFILE_THRESHOLD);
+    clear_file_cache();
+    std::remove("../static/test_head.txt");
+}
+
+TEST_F(SessionTest, AnswersConditionalGetWithNotModified) {
+    {
+        std::ofstream file("../static/test_conditional.css");
+        file << "body { color: red; }";
+    }
+    tcp::socket socket = connect();
+    std::string buffer;
+    asio::write(socket, asio::buffer(std::string("GET /static/test_conditional.css HTTP/1.1\r\n\r\n")));
+    std::string full = read_response(socket, buffer);
+    size_t etag_pos = full.find("ETag: ");
+    ASSERT_NE(etag_pos, std::string::npos);
+    std::string etag = full.substr(etag_pos + 6, full.find("\r\n", etag_pos) - etag_pos - 6);
+    size_t modified_pos = full.find("Last-Modified: ");
+    ASSERT_NE(modified_pos, std::string::npos);
+    std::string modified = full.substr(modified_pos + 15, full.find("\r\n", modified_pos) - modified_pos - 15);
+
+    // Both validators, pipelined, then a stale tag that gets the full body
+    asio::write(socket, asio::buffer(
+        "GET /static/test_conditional.css HTTP/1.1\r\nIf-None-Match: " + etag + "\r\n\r\n"
+        "GET /static/test_conditional.css HTTP/1.1\r\nIf-Modified-Since: " + modified + "\r\n\r\n"
+        "GET /static/test_conditional.css HTTP/1.1\r\nIf-None-Match: \"stale\"\r\n\r\n"));
+    std::string by_etag = read_response(socket, buffer);
+    std::string by_date = read_response(socket, buffer);
+    std::string stale = read_response(socket, buffer);
+    std::remove("../static/test_conditional.css");
+
+    EXPECT_EQ(by_etag.rfind("HTTP/1.1 304 Not Modified\r\n", 0), 0u);
+    EXPECT_NE(by_etag.find("ETag: " + etag + "\r\n"), std::string::npos);
+    EXPECT_EQ(by_etag.find("Content-Length"), std::string::npos);
+    EXPECT_EQ(by_etag.substr(by_etag.size() - 4), "\r\n\r\n");
+    EXPECT_EQ(by_date.rfind("HTTP/1.1 304 Not Modified\r\n", 0), 0u);
+    EXPECT_EQ(stale.rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+    EXPECT_NE(stale.find("body { color: red; }"), std::string::npos);
+}
+
+TEST_F(SessionTest, ServesRangesFromDisk) {
+    std::string content(64 * 1024, '\0');
+    for (size_t i = 0; i < content.size(); ++i) {
+        content[i] = static_cast<char>('a' + i % 26);
+    }
+    {
+        std::ofstream file("../static/test_range.mp4", std::ios::binary);
+        file << content;
+    }
+    set_sendfile_threshold(1024);
+
+    // Single range, two ranges, a stale If-Range, an unsatisfiable range,
+    // then a plain request: all pipelined behind sendfile bodies
+    tcp::socket socket = connect();
+    std::string buffer;
+    asio::write(socket, asio::buffer(std::string(
+        "GET /static/test_range.mp4 HTTP/1.1\r\nRange: bytes=100-199\r\n\r\n"
+        "GET /static/test_range.mp4 HTTP/1.1\r\nRange: bytes=0-9, -5\r\n\r\n"
+        "GET /static/test_range.mp4 HTTP/1.1\r\nRange: bytes=0-9\r\nIf-Range: \"stale\"\r\n\r\n"
+        "GET /static/test_range.mp4 HTTP/1.1\r\nRange: bytes=70000-\r\n\r\n"
+        "GET /health HTTP/1.1\r\n\r\n")));
+    std::string single = read_response(socket, buffer);
+    std::string multi = read_response(socket, buffer);
+    std::string stale = read_response(socket, buffer);
+    std::string unsatisfiable = read_response(socket, buffer);
+    std::string health = read_response(socket, buffer);
+
+    set_sendfile_threshold(DEFAULT_SENDFILE_THRESHOLD);
+    std::remove("../static/test_range.mp4");
+
+    EXPECT_EQ(single.rfind("HTTP/1.1 206 Partial Content\r\n", 0), 0u);
+    EXPECT_NE(single.find("Content-Range: bytes 100-199/65536\r\n"), std::string::npos);
+    EXPECT_NE(single.find("Content-Type: video/mp4\r\n"), std::string::npos);
+    EXPECT_EQ(single.substr(single.size() - 100), content.substr(100, 100));
+
+    EXPECT_EQ(multi.rfind("HTTP/1.1 206 Partial Content\r\n", 0), 0u);
+    size_t boundary_pos = multi.find("multipart/byteranges; boundary=");
+    ASSERT_NE(boundary_pos, std::string::npos);
+    std::string boundary = multi.substr(boundary_pos + 31, multi.find("\r\n", boundary_pos) - boundary_pos - 31);
+    std::string body = multi.substr(multi.find("\r\n\r\n") + 4);
+    EXPECT_EQ(body,
+              "--" + boundary + "\r\nContent-Type: video/mp4\r\nContent-Range: bytes 0-9/65536\r\n\r\n" +
+              content.substr(0, 10) + "\r\n--" + boundary +
+              "\r\nContent-Type: video/mp4\r\nContent-Range: bytes 65531-65535/65536\r\n\r\n" +
+              content.substr(65531) + "\r\n--" + boundary + "--\r\n");
+
+    EXPECT_EQ(stale.rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+    EXPECT_NE(stale.find("Accept-Ranges: bytes\r\n"), std::string::npos);
+    EXPECT_EQ(unsatisfiable.rfind("HTTP/1.1 416 Range Not Satisfiable\r\n", 0), 0u);
+    EXPECT_NE(unsatisfiable.find("Content-Range: bytes */65536\r\n"), std::string::npos);
+    EXPECT_NE(health.find("{\"status\":\"ok\"}"), std::string::npos);
+}
+
+TEST_F(SessionTest, DecodesChunkedBodiesForBufferedRoutes) {
+    tcp::socket socket = connect();
+    std::string buffer;
+    asio::write(socket, asio::buffer(std::string(
+        "POST /echo HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+        "3\r\nhel\r\n2;ext=1\r\nlo\r\n0\r\nX-Trailer: 1\r\n\r\n"
+        "GET /health HTTP/1.1\r\n\r\n")));
+    std::string echo = read_response(socket, buffer);
+    std::string health = read_response(socket, buffer);
+    EXPECT_EQ(echo.rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+    EXPECT_NE(echo.find("\"received_body\": \"hello\""), std::string::npos);
+    EXPECT_NE(health.find("{\"status\":\"ok\"}"), std::string::npos);
+}
+
+TEST_F(SessionTest, RejectsBadTransferCodings) {
+    auto answer = [this](const std::string& request) {
+        tcp::socket socket = connect();
+        std::string buffer;
+        asio::write(socket, asio::buffer(request));
+        return read_response(socket, buffer);
+    };
+    EXPECT_EQ(answer("POST /echo HTTP/1.1\r\nTransfer-Encoding: gzip, chunked\r\n\r\n").rfind("HTTP/1.1 501 ", 0), 0u);
+    EXPECT_EQ(answer("POST /echo HTTP/1.1\r\nTransfer-Encoding: chunked\r\nContent-Length: 3\r\n\r\nabc")
+                  .rfind("HTTP/1.1 400 ", 0), 0u);
+    // Framing read from every field, not just the first of each
+    EXPECT_EQ(answer("POST /echo HTTP/1.1\r\nTransfer-Encoding: chunked\r\nTransfer-Encoding: chunked\r\n\r\n")
+                  .rfind("HTTP/1.1 400 ", 0), 0u);
+    EXPECT_EQ(answer("POST /echo HTTP/1.1\r\nTransfer-Encoding: chunked\r\nTransfer-Encoding: gzip\r\n\r\n")
+                  .rfind("HTTP/1.1 400 ", 0), 0u);
+    EXPECT_EQ(answer("POST /echo HTTP/1.1\r\nContent-Length: 3\r\nContent-Length: 5\r\n\r\nabcde")
+                  .rfind("HTTP/1.1 400 ", 0), 0u);
+    std::string repeated = answer("POST /echo HTTP/1.1\r\nContent-Length: 3\r\nContent-Length: 3\r\n\r\nabc");
+    EXPECT_EQ(repeated.rfind("HTTP/1.1 200 ", 0), 0u);
+    EXPECT_NE(repeated.find("\"received_body\": \"abc\""), std::string::npos);
+    std::string malformed = answer("POST /echo HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabcdef\r\n");
+    EXPECT_EQ(malformed.rfind("HTTP/1.1 400 ", 0), 0u);
+    EXPECT_NE(malformed.find("Malformed chunked body"), std::string::npos);
+}
+
+namespace {
+
+// Records how the body arrived; pauses after every piece when resume_after
+// is set, resuming from another thread
+struct RecordingSink : BodySink {
+    RecordingSink(BodyResume resume, bool pause) : resume(std::move(resume)), pause(pause) {}
+
+    Flow on_data(std::string_view data) override {
+        bytes += data.size();
+        largest_piece = std::max(largest_piece, data.size());
+        ++pieces;
+        if (!pause) return Flow::Continue;
+        std::thread([resume = resume]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            resume();
+        }).detach();
+        return Flow::Pause;
+    }
+
+    ResponsePtr on_end() override {
+        std::string body = std::to_string(bytes) + " " + std::to_string(largest_piece) + " " + std::to_string(pieces);
+        return make_response("200 OK", "text/plain", body);
+    }
+
+    BodyResume resume;
+    bool pause;
+    size_t bytes = 0;
+    size_t largest_piece = 0;
+    size_t pieces = 0;
+};
+
+std::string response_body(const std::string& response) {
+    return response.substr(response.find("\r\n\r\n") + 4);
+}
+
+}  // namespace
+
+TEST_F(SessionTest, StreamsLargeBodiesToSinksInBoundedPieces) {
+    add_streaming_route("POST", "/test/stream", [](const Request&, BodyResume resume) {
+        return std::make_unique<RecordingSink>(std::move(resume), false);
+    });
+
+    // Larger than MAX_CONTENT_LENGTH, which only limits buffered bodies
+    const size_t size = MAX_CONTENT_LENGTH + 1024 * 1024;
+    tcp::socket socket = connect();
+    std::string buffer;
+    asio::write(socket, asio::buffer("POST /test/stream HTTP/1.1\r\nContent-Length: " + std::to_string(size) + "\r\n\r\n"));
+    asio::write(socket, asio::buffer(std::string(size, 'u')));
+    std::string resp = read_response(socket, buffer);
+    EXPECT_EQ(resp.rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+    std::string body = response_body(resp);
+    size_t largest = std::stoul(body.substr(body.find(' ') + 1));
+    EXPECT_EQ(std::stoul(body), size);
+    EXPECT_LE(largest, READ_CHUNK_SIZE);
+}
+
+TEST_F(SessionTest, PausedSinkResumesChunkedBody) {
+    add_streaming_route("PUT", "/test/paused", [](const Request&, BodyResume resume) {
+        return std::make_unique<RecordingSink>(std::move(resume), true);
+    });
+
+    // The client waits for 100 Continue, then streams 64 chunks
+    tcp::socket socket = connect();
+    std::string buffer;
+    asio::write(socket, asio::buffer(std::string(
+        "PUT /test/paused HTTP/1.1\r\nTransfer-Encoding: chunked\r\nExpect: 100-continue\r\n\r\n")));
+    size_t interim_end = asio::read_until(socket, asio::dynamic_buffer(buffer), "\r\n\r\n");
+    EXPECT_EQ(buffer.substr(0, interim_end), "HTTP/1.1 100 Continue\r\n\r\n");
+    buffer.erase(0, interim_end);
+
+    std::string chunks;
+    for (int i = 0; i < 64; ++i) chunks += "400\r\n" + std::string(1024, 'p') + "\r\n";
+    asio::write(socket, asio::buffer(chunks + "0\r\n\r\nGET /health HTTP/1.1\r\n\r\n"));
+    std::string resp = read_response(socket, buffer);
+    std::string health = read_response(socket, buffer);
+    EXPECT_EQ(resp.rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+    EXPECT_EQ(std::stoul(response_body(resp)), 64u * 1024u);
+    EXPECT_NE(health.find("{\"status\":\"ok\"}"), std::string::npos);
+}
+
+TEST_F(SessionTest, BuiltInUploadRouteCountsBytes) {
+    init_router_config();
+    tcp::socket socket = connect();
+    std::string buffer;
+    asio::write(socket, asio::buffer(std::string(
+        "POST /upload HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n4\r\nabcd\r\n2\r\nef\r\n0\r\n\r\n")));
+    std::string resp = read_response(socket, buffer);
+    EXPECT_NE(resp.find("{\"bytes_received\":6}"), std::string::npos);
+}
+
+namespace {
+
+// Read the head of a chunked response, then its chunks up to the last one;
+// returns the head and puts the decoded body in body
+std::string read_chunked_response(tcp::socket& socket, std::string& buffer, std::string& body) {
+    size_t header_end = asio::read_until(socket, asio::dynamic_buffer(buffer), "\r\n\r\n");
+    std::string head = buffer.substr(0, header_end);
+    buffer.erase(0, header_end);
+    body.clear();
+    while (true) {
+        size_t line_end = asio::read_until(socket, asio::dynamic_buffer(buffer), "\r\n");
+        size_t size = std::stoul(buffer.substr(0, line_end - 2), nullptr, 16);
+        buffer.erase(0, line_end);
+        if (buffer.size() < size + 2) {
+            asio::read(socket, asio::dynamic_buffer(buffer), asio::transfer_exactly(size + 2 - buffer.size()));
+        }
+        if (size == 0) {
+            EXPECT_EQ(buffer.substr(0, 2), "\r\n");
+            buffer.erase(0, 2);
+            return head;
+        }
+        body.append(buffer, 0, size);
+        EXPECT_EQ(buffer.substr(size, 2), "\r\n");
+        buffer.erase(0, size + 2);
+    }
+}
+
+// Produces "tick N" pieces from a background thread: every pull before the
+// next tick is ready returns Pending
+struct TickerStream : BodyStream {
+    void start(BodyResume resume) override {
+        worker = std::thread([this, resume]() {
+            for (int i = 0; i < 3; ++i) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                ready.fetch_add(1);
+                resume();
+            }
+        });
+    }
+
+    Status pull(std::string& out) override {
+        if (sent == ready.load()) return Status::Pending;
+        out = "tick " + std::to_string(++sent) + "\n";
+        return sent == 3 ? Status::Done : Status::Data;
+    }
+
+    ~TickerStream() override {
+        if (worker.joinable()) worker.join();
+    }
+
+    std::thread worker;
+    std::atomic<int> ready{0};
+    int sent = 0;
+};
+
+struct TickerSink : BodySink {
+    Flow on_data(std::string_view) override { return Flow::Continue; }
+
+    ResponsePtr on_end() override {
+        Response resp;
+        resp.status = "200 OK";
+        resp.content_type = "text/plain";
+        resp.stream = std::make_shared<TickerStream>();
+        return make_response(std::move(resp));
+    }
+};
+
+}  // namespace
+
+TEST_F(SessionTest, StreamsChunkedResponses) {
+    tcp::socket socket = connect();
+    std::string buffer;
+    asio::write(socket, asio::buffer(std::string(
+        "GET /api/stream HTTP/1.1\r\n\r\n"
+        "GET /health HTTP/1.1\r\n\r\n")));
+    std::string body;
+    std::string head = read_chunked_response(socket, buffer, body);
+    std::string health = read_response(socket, buffer);
+
+    EXPECT_EQ(head.rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+    EXPECT_NE(head.find("Transfer-Encoding: chunked\r\n"), std::string::npos);
+    EXPECT_EQ(head.find("Content-Length"), std::string::npos);
+    EXPECT_EQ(body, "{\"data\":\"item1\"}\n{\"data\":\"item2\"}\n{\"data\":\"item3\"}\n");
+    EXPECT_NE(health.find("{\"status\":\"ok\"}"), std::string::npos);
+}
+
+TEST_F(SessionTest, StreamsUnframedToHttp10AndCloses) {
+    tcp::socket socket = connect();
+    std::string buffer;
+    asio::write(socket, asio::buffer(std::string("GET /api/stream HTTP/1.0\r\n\r\n")));
+    boost::system::error_code ec;
+    asio::read(socket, asio::dynamic_buffer(buffer), ec);
+    EXPECT_EQ(ec, asio::error::eof);
+    EXPECT_EQ(buffer.find("Transfer-Encoding"), std::string::npos);
+    EXPECT_NE(buffer.find("Connection: close\r\n"), std::string::npos);
+    EXPECT_EQ(buffer.substr(buffer.find("\r\n\r\n") + 4),
+              "{\"data\":\"item1\"}\n{\"data\":\"item2\"}\n{\"data\":\"item3\"}\n");
+}
+
+TEST_F(SessionTest, PendingStreamWaitsForResume) {
+    add_streaming_route("POST", "/test/ticker", [](const Request&, BodyResume) {
+        return std::make_unique<TickerSink>();
+    });
+    tcp::socket socket = connect();
+    std::string buffer;
+    asio::write(socket, asio::buffer(std::string("POST /test/ticker HTTP/1.1\r\nContent-Length: 0\r\n\r\n")));
+    std::string body;
+    std::string head = read_chunked_response(socket, buffer, body);
+    EXPECT_NE(head.find("Transfer-Encoding: chunked\r\n"), std::string::npos);
+    EXPECT_EQ(body, "tick 1\ntick 2\ntick 3\n");
+}
@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+#include "../include/sharded_cache.hpp"
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(ShardedCacheTest, StoresAndRetrieves) {
+    ShardedCache<std::string> cache(16, 60);
+    cache.put("/a", "alpha");
+    cache.put("/b", "beta");
+
+    EXPECT_EQ(cache.get("/a"), "alpha");
+    EXPECT_EQ(cache.get("/b"), "beta");
+    EXPECT_EQ(cache.get("/missing"), "");
+    EXPECT_EQ(cache.size(), 2u);
+}
+
+TEST(ShardedCacheTest, PutReplacesExistingValue) {
+    ShardedCache<std::string> cache(4, 60);
+    cache.put("/a", "old");
+    cache.put("/a", "new");
+
+    EXPECT_EQ(cache.get("/a"), "new");
+    EXPECT_EQ(cache.size(), 1u);
+}
+
+TEST(ShardedCacheTest, ShardCountIsPowerOfTwoAndBoundedByCapacity) {
+    EXPECT_EQ(ShardedCache<int>(100, 60, 16).shard_count(), 16u);
+    EXPECT_EQ(ShardedCache<int>(100, 60, 12).shard_count(), 16u);
+    EXPECT_EQ(ShardedCache<int>(3, 60, 16).shard_count(), 2u);
+    EXPECT_EQ(ShardedCache<int>(1, 60, 16).shard_count(), 1u);
+}
+
+TEST(ShardedCacheTest, LruEvictsLeastRecentlyUsed) {
+    ShardedCache<int> cache(3, 60, 1, EvictionPolicy::Lru);
+    cache.put("a", 1);
+    cache.put("b", 2);
+    cache.put("c", 3);
+    EXPECT_EQ(cache.get("a"), 1);  // "b" is now the oldest
+
+    cache.put("d", 4);
+    EXPECT_EQ(cache.get("b"), 0);
+    EXPECT_EQ(cache.get("a"), 1);
+    EXPECT_EQ(cache.get("c"), 3);
+    EXPECT_EQ(cache.get("d"), 4);
+}
+
+TEST(ShardedCacheTest, ClockGivesReferencedEntriesASecondChance) {
+    ShardedCache<int> cache(3, 60, 1, EvictionPolicy::Clock);
+    cache.put("a", 1);
+    cache.put("b", 2);
+    cache.put("c", 3);
+    EXPECT_EQ(cache.get("a"), 1);  // Oldest, but referenced
+
+    cache.put("d", 4);
+    EXPECT_EQ(cache.get("b"), 0);
+    EXPECT_EQ(cache.get("a"), 1);
+    EXPECT_EQ(cache.size(), 3u);
+}
+
+TEST(ShardedCacheTest, ClockEvictsWhenEverythingIsReferenced) {
+    ShardedCache<int> cache(2, 60, 1, EvictionPolicy::Clock);
+    cache.put("a", 1);
+    cache.put("b", 2);
+    cache.get("a");
+    cache.get("b");
+
+    cache.put("c", 3);
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_EQ(cache.get("c"), 3);
+}
+
+TEST(ShardedCacheTest, ExpiredEntriesMiss) {
+    ShardedCache<int> lru(4, 1, 1, EvictionPolicy::Lru);
+    ShardedCache<int> clock(4, 1, 1, EvictionPolicy::Clock);
+    lru.put("a", 1);
+    clock.put("a", 1);
+    EXPECT_EQ(lru.get("a"), 1);
+    EXPECT_EQ(clock.get("a"), 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1050));
+    EXPECT_EQ(lru.get("a"), 0);
+    EXPECT_EQ(clock.get("a"), 0);
+}
+
+TEST(ShardedCacheTest, ZeroTtlNeverExpires) {
+    for (EvictionPolicy policy : {EvictionPolicy::Lru, EvictionPolicy::Clock}) {
+        ShardedCache<int> cache(4, 0, 1, policy);
+        cache.put("a", 1);
+        EXPECT_EQ(cache.get("a"), 1);
+    }
+}
+
+TEST(ShardedCacheTest, EraseDropsOneEntry) {
+    ShardedCache<int> cache(16, 60, 4);
+    cache.put("/a", 1);
+    cache.put("/b", 2);
+    EXPECT_TRUE(cache.erase("/a"));
+    EXPECT_FALSE(cache.erase("/a"));
+    EXPECT_EQ(cache.get("/a"), 0);
+    EXPECT_EQ(cache.get("/b"), 2);
+    EXPECT_EQ(cache.stats().entries, 1u);
+}
+
+TEST(ShardedCacheTest, ClearEmptiesAllShards) {
+    ShardedCache<int> cache(64, 60, 8);
+    for (int i = 0; i < 32; ++i) cache.put("/k" + std::to_string(i), i);
+    cache.clear();
+
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_EQ(cache.get("/k1"), 0);
+    cache.put("/k1", 1);
+    EXPECT_EQ(cache.get("/k1"), 1);
+}
+
+TEST(ShardedCacheTest, ConcurrentReadersAndWritersStayWithinCapacity) {
+    for (EvictionPolicy policy : {EvictionPolicy::Lru, EvictionPolicy::Clock}) {
+        ShardedCache<int> cache(64, 60, 8, policy);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; ++t) {
+            threads.emplace_back([&cache, t]() {
+                for (int i = 0; i < 5000; ++i) {
+                    std::string key = "/k" + std::to_string((i * 7 + t) % 200);
+                    int value = cache.get(key);
+                    if (value != 0) {
+                        EXPECT_EQ("/k" + std::to_string(value - 1), key);
+                    } else {
+                        cache.put(key, (i * 7 + t) % 200 + 1);
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+
+        EXPECT_LE(cache.size(), 64u);
+    }
+}
+
+TEST(ShardedCacheTest, ByteBudgetEvictsByWeight) {
+    CacheOptions options;
+    options.max_entries = 0;
+    options.max_bytes = 100;
+    options.shards = 1;
+    options.policy = EvictionPolicy::Lru;
+    ShardedCache<std::string> cache(options, [](const std::string& value) { return value.size(); });
+
+    cache.put("a", std::string(40, 'a'));  // 41 bytes with the key
+    cache.put("b", std::string(40, 'b'));
+    EXPECT_EQ(cache.size(), 2u);
+
+    cache.put("c", std::string(40, 'c'));  // 123 > 100: "a" goes
+    EXPECT_EQ(cache.get("a"), "");
+    EXPECT_EQ(cache.get("b").size(), 40u);
+    EXPECT_EQ(cache.get("c").size(), 40u);
+    EXPECT_LE(cache.stats().bytes, 100u);
+    EXPECT_EQ(cache.stats().evictions, 1u);
+}
+
+TEST(ShardedCacheTest, RejectsEntriesLargerThanTheBudget) {
+    CacheOptions options;
+    options.max_bytes = 64;
+    options.shards = 1;
+    ShardedCache<std::string> cache(options, [](const std::string& value) { return value.size(); });
+
+    cache.put("small", "x");
+    cache.put("huge", std::string(1000, 'x'));
+    EXPECT_EQ(cache.get("huge"), "");
+    EXPECT_EQ(cache.get("small"), "x");
+    EXPECT_EQ(cache.stats().rejections, 1u);
+}
+
+TEST(ShardedCacheTest, StatsCountHitsAndMisses) {
+    ShardedCache<int> cache(8, 60);
+    cache.put("a", 1);
+    cache.get("a");
+    cache.get("a");
+    cache.get("b");
+
+    CacheStats stats = cache.stats();
+    EXPECT_EQ(stats.hits, 2u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.entries, 1u);
+    EXPECT_NEAR(stats.hit_ratio(), 2.0 / 3.0, 1e-9);
+}
+
+TEST(ShardedCacheTest, AdmissionKeepsHotSetThroughAScan) {
+    auto run = [](bool admission) {
+        CacheOptions options;
+        options.max_entries = 100;
+        options.shards = 1;
+        options.admission = admission;
+        ShardedCache<int> cache(options);
+
+        auto access = [&cache](const std::string& key) {
+            if (cache.get(key) == 0) cache.put(key, 1);
+        };
+        for (int round = 0; round < 20; ++round) {
+            for (int i = 0; i < 50; ++i) access("/hot/" + std::to_string(i));
+        }
+        for (int i = 0; i < 1000; ++i) access("/scan/" + std::to_string(i));
+
+        int hot_hits = 0;
+        for (int i = 0; i < 50; ++i) {
+            if (cache.get("/hot/" + std::to_string(i)) != 0) ++hot_hits;
+        }
+        return hot_hits;
+    };
+
+    EXPECT_EQ(run(false), 0);   // The scan flushed the hot set
+    EXPECT_GE(run(true), 45);   // One-hit wonders were not admitted
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include "../include/simd_scan.hpp"
+#include <cctype>
+#include <cstring>
+#include <string>
+
+namespace {
+
+bool is_tchar(unsigned char c) {
+    return std::isalnum(c) || (c != 0 && std::strchr("!#$%&'*+-.^_`|~", c) != nullptr);
+}
+
+// Place `byte` at every offset of a buffer long enough to exercise the
+// 32-byte, 16-byte and scalar tail paths, and check the reported position
+template<typename Scan>
+void expect_stops_at(Scan scan, const std::string& filler, unsigned char byte, bool should_stop) {
+    for (size_t len = 1; len <= 80; ++len) {
+        for (size_t pos = 0; pos < len; ++pos) {
+            std::string buf(len, filler[0]);
+            buf[pos] = static_cast<char>(byte);
+            const char* end = buf.data() + buf.size();
+            const char* expected = should_stop ? buf.data() + pos : end;
+            ASSERT_EQ(scan(buf.data(), end), expected)
+                << "byte " << static_cast<int>(byte) << " at " << pos << " of " << len << " (" << scan_isa_name() << ")";
+        }
+    }
+}
+
+}  // namespace
+
+TEST(SimdScanTest, ReportsSelectedIsa) {
+    std::string isa = scan_isa_name();
+    EXPECT_TRUE(isa == "avx2" || isa == "sse2" || isa == "scalar");
+}
+
+TEST(SimdScanTest, FindsByteAtEveryOffset) {
+    auto find_newline = [](const char* b, const char* e) { return scan_for_byte(b, e, '\n'); };
+    expect_stops_at(find_newline, "a", '\n', true);
+    expect_stops_at(find_newline, "a", '\r', false);
+}
+
+TEST(SimdScanTest, EmptyRangeReturnsEnd) {
+    const char* p = "x";
+    EXPECT_EQ(scan_for_byte(p, p, 'x'), p);
+    EXPECT_EQ(scan_non_token(p, p), p);
+    EXPECT_EQ(scan_non_target(p, p), p);
+    EXPECT_EQ(scan_non_field_value(p, p), p);
+}
+
+TEST(SimdScanTest, TokenClassMatchesRfc) {
+    for (int c = 0; c < 256; ++c) {
+        expect_stops_at(scan_non_token, "a", static_cast<unsigned char>(c), !is_tchar(static_cast<unsigned char>(c)));
+    }
+}
+
+TEST(SimdScanTest, TargetClassRejectsControlsAndSpace) {
+    for (int c = 0; c < 256; ++c) {
+        bool bad = c <= 0x20 || c == 0x7f;
+        expect_stops_at(scan_non_target, "/", static_cast<unsigned char>(c), bad);
+    }
+}
+
+TEST(SimdScanTest, FieldValueClassAllowsTabAndObsText) {
+    for (int c = 0; c < 256; ++c) {
+        bool bad = (c < 0x20 && c != '\t') || c == 0x7f;
+        expect_stops_at(scan_non_field_value, "v", static_cast<unsigned char>(c), bad);
+    }
+}
+
+TEST(SimdScanTest, HeaderNameStopsAtColon) {
+    std::string line = "Accept-Encoding: gzip, deflate, br";
+    const char* stop = scan_non_token(line.data(), line.data() + line.size());
+    EXPECT_EQ(std::string(line.c_str(), stop), "Accept-Encoding");
+    EXPECT_EQ(*stop, ':');
+}
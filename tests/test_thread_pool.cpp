@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include "../include/thread_pool.hpp"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace {
+
+void wait_for(const std::atomic<int>& counter, int expected) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (counter.load() < expected && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+// Each call posts two children until depth runs out: 2^(depth+1) - 1 tasks
+void spawn_tree(ThreadPool& pool, std::atomic<int>& counter, int depth) {
+    counter.fetch_add(1);
+    if (depth == 0) return;
+    pool.post([&pool, &counter, depth]() { spawn_tree(pool, counter, depth - 1); });
+    pool.post([&pool, &counter, depth]() { spawn_tree(pool, counter, depth - 1); });
+}
+
+}  // namespace
+
+TEST(ThreadPoolTest, SmallTasksAreStoredInline) {
+    int value = 0;
+    int* target = &value;
+    Task task = Task::make([target]() { *target = 42; });
+    ASSERT_TRUE(task);
+    task.run();
+    EXPECT_EQ(value, 42);
+}
+
+TEST(ThreadPoolTest, LargeCapturesRunAndAreReleased) {
+    auto payload = std::make_shared<std::string>(1000, 'x');
+    std::weak_ptr<std::string> watcher = payload;
+    size_t seen = 0;
+    Task task = Task::make([payload = std::move(payload), &seen]() { seen = payload->size(); });
+    task.run();
+    EXPECT_EQ(seen, 1000u);
+    EXPECT_TRUE(watcher.expired());
+
+    auto discarded = std::make_shared<int>(7);
+    std::weak_ptr<int> discarded_watcher = discarded;
+    Task unused = Task::make([discarded = std::move(discarded)]() {});
+    unused.discard();
+    EXPECT_TRUE(discarded_watcher.expired());
+}
+
+TEST(ThreadPoolTest, RunsTasksPostedFromOutside) {
+    ThreadPool pool(4);
+    std::atomic<int> counter{0};
+    for (int i = 0; i < 10000; ++i) {
+        pool.post([&counter]() { counter.fetch_add(1); });
+    }
+    wait_for(counter, 10000);
+    EXPECT_EQ(counter.load(), 10000);
+}
+
+TEST(ThreadPoolTest, RunsTasksPostedFromWorkers) {
+    // 16383 tasks, mostly pushed onto worker deques and stolen
+    ThreadPool pool(4);
+    std::atomic<int> counter{0};
+    pool.post([&pool, &counter]() { spawn_tree(pool, counter, 13); });
+    wait_for(counter, 16383);
+    EXPECT_EQ(counter.load(), 16383);
+}
+
+TEST(ThreadPoolTest, WorkerDequeGrowsPastInitialCapacity) {
+    ThreadPool pool(2);
+    std::atomic<int> counter{0};
+    pool.post([&pool, &counter]() {
+        for (int i = 0; i < 5000; ++i) {
+            pool.post([&counter]() { counter.fetch_add(1); });
+        }
+    });
+    wait_for(counter, 5000);
+    EXPECT_EQ(counter.load(), 5000);
+}
+
+TEST(ThreadPoolTest, EnqueueReturnsFuture) {
+    ThreadPool pool(2);
+    auto sum = pool.enqueue([](int a, int b) { return a + b; }, 2, 3);
+    auto text = pool.enqueue([]() { return std::string("done"); });
+    EXPECT_EQ(sum.get(), 5);
+    EXPECT_EQ(text.get(), "done");
+}
+
+TEST(ThreadPoolTest, EnqueuePropagatesExceptions) {
+    ThreadPool pool(1);
+    auto failed = pool.enqueue([]() -> int { throw std::runtime_error("boom"); });
+    EXPECT_THROW(failed.get(), std::runtime_error);
+
+    // The worker survives a throwing post() task
+    pool.post([]() { throw std::runtime_error("ignored"); });
+    EXPECT_EQ(pool.enqueue([]() { return 1; }).get(), 1);
+}
+
+TEST(ThreadPoolTest, ShutdownRunsPendingTasks) {
+    std::atomic<int> counter{0};
+    {
+        ThreadPool pool(2);
+        for (int i = 0; i < 1000; ++i) {
+            pool.post([&counter]() {
+                std::this_thread::sleep_for(std::chrono::microseconds(10));
+                counter.fetch_add(1);
+            });
+        }
+        pool.shutdown();
+        EXPECT_EQ(counter.load(), 1000);
+    }
+    EXPECT_EQ(counter.load(), 1000);
+}
+
+TEST(ThreadPoolTest, PostAfterShutdownThrows) {
+    ThreadPool pool(1);
+    pool.shutdown();
+    EXPECT_THROW(pool.post([]() {}), std::runtime_error);
+    EXPECT_THROW(pool.enqueue([]() { return 0; }), std::runtime_error);
+}
+
+TEST(ThreadPoolTest, WakesParkedWorkers) {
+    ThreadPool pool(2);
+    std::atomic<int> counter{0};
+    for (int round = 1; round <= 20; ++round) {
+        // Let the workers go idle and park between posts
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        pool.post([&counter]() { counter.fetch_add(1); });
+        wait_for(counter, round);
+        ASSERT_EQ(counter.load(), round);
+    }
+}
+
+TEST(ThreadPoolTest, ReportsQueuedTasks) {
+    ThreadPool pool(1);
+    std::atomic<int> started{0};
+    std::atomic<int> counter{0};
+    std::atomic<bool> release{false};
+    pool.post([&]() {
+        started.fetch_add(1);
+        while (!release.load()) std::this_thread::yield();
+    });
+    wait_for(started, 1);
+    for (int i = 0; i < 3; ++i) {
+        pool.post([&counter]() { counter.fetch_add(1); });
+    }
+    EXPECT_EQ(pool.queued(), 3u);
+    release.store(true);
+    wait_for(counter, 3);
+    EXPECT_EQ(pool.queued(), 0u);
+}